@@ -0,0 +1,89 @@
+/*
+ * Measures folding the values of a range of keys into their sum, minimum
+ * and maximum, and the cost the aggregates augmentation adds to inserting
+ * keys.
+ *
+ * Without the augmentation, Aggregate() visits every element inside the
+ * range. With it, the subtrees inside the range contribute the summaries
+ * stored next to their child pointers, and only the nodes on the paths to
+ * the two bounds are visited.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = 1 << 22;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    std::unique_ptr<Index> BuildIndex(Augmentation augmentation) {
+        std::vector<std::pair<int64_t, int64_t>> elements;
+        elements.reserve(kKeyCount);
+        for (int64_t key = 0; key < kKeyCount; ++key) {
+            elements.emplace_back(key, (key * 7919) % 10007);
+        }
+
+        auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize, augmentation);
+        index->BulkLoad(elements.begin(), elements.end());
+        return index;
+    }
+
+    // Folds a window of state.range(0) keys, sliding it across the keys
+    void RunAggregate(benchmark::State &state, Augmentation augmentation) {
+        auto index = BuildIndex(augmentation);
+        auto width = state.range(0);
+        int64_t lo = 0;
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index->Aggregate(lo, lo + width - 1));
+            lo = (lo + 7919) % (kKeyCount - width);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_AggregateByScan(benchmark::State &state) {
+        RunAggregate(state, Augmentation::None);
+    }
+
+    void BM_AggregateWithSummaries(benchmark::State &state) {
+        RunAggregate(state, Augmentation::Aggregates);
+    }
+
+    // Inserts keys into an empty B+Tree in a scattered order
+    void RunInsert(benchmark::State &state, Augmentation augmentation) {
+        auto key_count = state.range(0);
+
+        for (auto _: state) {
+            Index index{kInnerNodeMaxSize, kLeafNodeMaxSize, augmentation};
+            for (int64_t i = 0; i < key_count; ++i) {
+                auto key = (i * 2654435761) % key_count;
+                benchmark::DoNotOptimize(index.Insert(std::make_pair(key, key)));
+            }
+
+            state.PauseTiming();
+            index.FreeTree();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * key_count);
+    }
+
+    void BM_Insert(benchmark::State &state) {
+        RunInsert(state, Augmentation::None);
+    }
+
+    void BM_InsertWithAggregates(benchmark::State &state) {
+        RunInsert(state, Augmentation::Aggregates);
+    }
+
+    BENCHMARK(BM_AggregateByScan)->RangeMultiplier(16)->Range(16, 1 << 20)->ArgName("width");
+    BENCHMARK(BM_AggregateWithSummaries)->RangeMultiplier(16)->Range(16, 1 << 20)->ArgName("width");
+    BENCHMARK(BM_Insert)->Arg(1 << 20)->ArgName("keys")->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_InsertWithAggregates)->Arg(1 << 20)->ArgName("keys")->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,86 @@
+/*
+ * Compares the node allocators under an insert heavy workload.
+ *
+ * Every split allocates a node. The heap allocator goes to the global
+ * allocator for every node, while the slab allocator takes nodes from a
+ * per-thread cache of freed blocks, which it refills from shared slabs.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next() {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<int64_t>(z ^ (z >> 31));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Shared by all the threads of a benchmark run. Thread 0 creates the
+    // index before the timed loop and destroys it after all threads exit
+    // the timed loop.
+    std::unique_ptr<Index> shared_index;
+
+    template<typename Allocator>
+    void BM_Insert(benchmark::State &state) {
+        if (state.thread_index() == 0) {
+            shared_index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize,
+                                                   std::make_unique<Allocator>());
+        }
+
+        KeyGenerator keys{static_cast<uint64_t>(state.thread_index()) + 1};
+        for (auto _: state) {
+            auto key = keys.Next();
+            benchmark::DoNotOptimize(shared_index->Insert(std::make_pair(key, key)));
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0) {
+            auto stats = shared_index->GetAllocatorStats();
+            state.counters["bytes_reserved"] = static_cast<double>(stats.bytes_reserved_);
+            state.counters["bytes_in_use"] = static_cast<double>(stats.bytes_in_use_);
+            shared_index.reset();
+        }
+    }
+
+    // Measures destroying the B+Tree, which releases whole slabs
+    template<typename Allocator>
+    void BM_FreeTree(benchmark::State &state) {
+        for (auto _: state) {
+            state.PauseTiming();
+            auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize,
+                                                 std::make_unique<Allocator>());
+            KeyGenerator keys{1};
+            for (int64_t i = 0; i < state.range(0); ++i) {
+                auto key = keys.Next();
+                index->Insert(std::make_pair(key, key));
+            }
+            state.ResumeTiming();
+
+            index.reset();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK_TEMPLATE(BM_Insert, HeapNodeAllocator)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_Insert, SlabNodeAllocator)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_FreeTree, HeapNodeAllocator)->Range(1 << 14, 1 << 18);
+    BENCHMARK_TEMPLATE(BM_FreeTree, SlabNodeAllocator)->Range(1 << 14, 1 << 18);
+}
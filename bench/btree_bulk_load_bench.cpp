@@ -0,0 +1,85 @@
+/*
+ * Measures how long it takes to build a B+Tree from sorted key-value
+ * elements, and how the parallel bulk load scales with threads.
+ *
+ * Inserting the elements one at a time is the baseline. The bulk load
+ * fills the nodes bottom-up without searching or splitting them, and the
+ * parallel bulk load divides every level between the threads.
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    const std::vector<std::pair<int64_t, int64_t>> &SortedElements(int64_t count) {
+        static std::vector<std::pair<int64_t, int64_t>> elements;
+        if (static_cast<int64_t>(elements.size()) != count) {
+            elements.clear();
+            elements.reserve(count);
+            for (int64_t key = 0; key < count; ++key) {
+                elements.emplace_back(key, key);
+            }
+        }
+        return elements;
+    }
+
+    // The B+Tree is destroyed outside the timed region
+    template<typename Build>
+    void RunBuild(benchmark::State &state, Build build) {
+        auto &elements = SortedElements(state.range(0));
+
+        for (auto _: state) {
+            auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+            build(*index, elements);
+
+            state.PauseTiming();
+            index.reset();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_Insert(benchmark::State &state) {
+        RunBuild(state, [](Index &index, auto &elements) {
+            for (auto &element: elements) {
+                index.Insert(element);
+            }
+        });
+    }
+
+    void BM_BulkLoad(benchmark::State &state) {
+        RunBuild(state, [](Index &index, auto &elements) {
+            benchmark::DoNotOptimize(index.BulkLoad(elements.begin(), elements.end()));
+        });
+    }
+
+    void BM_ParallelBulkLoad(benchmark::State &state) {
+        auto num_threads = static_cast<int>(state.range(1));
+        RunBuild(state, [num_threads](Index &index, auto &elements) {
+            benchmark::DoNotOptimize(index.ParallelBulkLoad(elements.begin(), elements.end(), num_threads));
+        });
+    }
+
+    void ParallelBulkLoadArgs(benchmark::internal::Benchmark *benchmark) {
+        int max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+            benchmark->Args({1 << 24, num_threads});
+        }
+        benchmark->Args({1 << 24, max_threads});
+        benchmark->ArgNames({"keys", "threads"});
+    }
+
+    BENCHMARK(BM_Insert)->Arg(1 << 24)->ArgName("keys")->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_BulkLoad)->Arg(1 << 24)->ArgName("keys")->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_ParallelBulkLoad)->Apply(ParallelBulkLoadArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,106 @@
+/*
+ * Measures the cost of point lookups when the B+Tree does not fit in the
+ * CPU caches.
+ *
+ * Lookups of uniformly random keys miss the cache at almost every level of
+ * a large B+Tree, so the latency of a lookup is dominated by the no. of
+ * cache lines touched while searching the nodes. Keys are stored in a
+ * separate array from the payloads, and the search over a node only reads
+ * the key array.
+ *
+ * Run under `perf stat -e cache-misses,cache-references` to count the
+ * misses directly. The `key_lines_per_node` counter reports how many cache
+ * lines the keys of a full leaf node span.
+ */
+#include <benchmark/benchmark.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int64_t kCacheLineSize = 64;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Building a tree with tens of millions of keys takes a while. Only the
+    // most recently used tree is kept, so that the memory of the previous
+    // one is released before building the next.
+    Index &GetIndex(int64_t num_keys, int fanout) {
+        static std::pair<int64_t, int> cached_args{0, 0};
+        static std::unique_ptr<Index> cached_index;
+
+        if (cached_index == nullptr || cached_args != std::make_pair(num_keys, fanout)) {
+            cached_index.reset();
+            cached_index = std::make_unique<Index>(fanout - 1, fanout);
+            for (int64_t key = 0; key < num_keys; ++key) {
+                cached_index->Insert(std::make_pair(key * 2, key));
+            }
+            cached_args = std::make_pair(num_keys, fanout);
+        }
+
+        return *cached_index;
+    }
+
+    void BM_RandomLookup(benchmark::State &state) {
+        auto num_keys = state.range(0);
+        auto fanout = static_cast<int>(state.range(1));
+        auto &index = GetIndex(num_keys, fanout);
+
+        KeyGenerator keys{42};
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index.MaybeGet(keys.Next(num_keys) * 2));
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["key_lines_per_node"] = static_cast<double>(
+                (fanout * sizeof(int64_t) + kCacheLineSize - 1) / kCacheLineSize);
+        state.counters["tree_bytes"] = static_cast<double>(index.GetAllocatorStats().bytes_in_use_);
+    }
+
+    // Consecutive lookups visit the same nodes, which stay in the cache
+    void BM_SequentialLookup(benchmark::State &state) {
+        auto num_keys = state.range(0);
+        auto fanout = static_cast<int>(state.range(1));
+        auto &index = GetIndex(num_keys, fanout);
+
+        int64_t key = 0;
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index.MaybeGet(key * 2));
+            key = (key + 1 == num_keys) ? 0 : key + 1;
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void CacheMissArgs(benchmark::internal::Benchmark *benchmark) {
+        for (int64_t num_keys: {int64_t{1} << 16, int64_t{1} << 20, int64_t{1} << 24}) {
+            for (int64_t fanout: {32, 128, 512}) {
+                benchmark->Args({num_keys, fanout});
+            }
+        }
+        benchmark->ArgNames({"keys", "fanout"});
+    }
+
+    BENCHMARK(BM_RandomLookup)->Apply(CacheMissArgs);
+    BENCHMARK(BM_SequentialLookup)->Apply(CacheMissArgs);
+}
@@ -0,0 +1,74 @@
+/*
+ * Measures how long it takes to expire a window of consecutive keys from
+ * the middle of a B+Tree.
+ *
+ * Deleting the keys one at a time is the baseline, which descends from the
+ * root for every key, and rebalances the B+Tree whenever a leaf node
+ * underflows. The range delete unlinks the leaf nodes inside the window
+ * together, and rebalances only the edges of the window.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    // Builds a B+Tree holding four times as many keys as the window, which
+    // starts at a quarter of the keys
+    std::unique_ptr<Index> BuildIndex(int64_t window) {
+        std::vector<std::pair<int64_t, int64_t>> elements;
+        elements.reserve(window * 4);
+        for (int64_t key = 0; key < window * 4; ++key) {
+            elements.emplace_back(key, key);
+        }
+
+        auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+        index->BulkLoad(elements.begin(), elements.end());
+        return index;
+    }
+
+    // The B+Tree is built and destroyed outside the timed region
+    template<typename Expire>
+    void RunExpire(benchmark::State &state, Expire expire) {
+        auto window = state.range(0);
+
+        for (auto _: state) {
+            state.PauseTiming();
+            auto index = BuildIndex(window);
+            state.ResumeTiming();
+
+            expire(*index, window, window * 2 - 1);
+
+            state.PauseTiming();
+            index.reset();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * window);
+    }
+
+    void BM_DeleteEachKey(benchmark::State &state) {
+        RunExpire(state, [](Index &index, int64_t lo, int64_t hi) {
+            for (auto key = lo; key <= hi; ++key) {
+                benchmark::DoNotOptimize(index.Delete(key));
+            }
+        });
+    }
+
+    void BM_DeleteRange(benchmark::State &state) {
+        RunExpire(state, [](Index &index, int64_t lo, int64_t hi) {
+            benchmark::DoNotOptimize(index.DeleteRange(lo, hi));
+        });
+    }
+
+    BENCHMARK(BM_DeleteEachKey)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->ArgName("keys")
+            ->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_DeleteRange)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->ArgName("keys")
+            ->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,119 @@
+/*
+ * Measures how the throughput of coroutine-interleaved lookups changes
+ * with the no. of lookups in flight.
+ *
+ * With a group size of one, `InterleavedGet` is a `MaybeGet` loop which
+ * also pays for suspending and resuming the coroutines. Larger groups
+ * overlap the cache misses of more lookups, until the core runs out of
+ * outstanding misses it can track, or the nodes prefetched for one lookup
+ * are evicted before it is resumed.
+ *
+ * Requires a C++20 build, `-DENABLE_CXX20=ON`.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = int64_t{1} << 24;
+    constexpr int64_t kBatchSize = 1024;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Built once, and shared by all the benchmarks
+    Index &GetIndex() {
+        static std::unique_ptr<Index> index = [] {
+            std::vector<std::pair<int64_t, int64_t>> elements;
+            elements.reserve(kKeyCount);
+            for (int64_t key = 0; key < kKeyCount; ++key) {
+                elements.emplace_back(key * 2, key);
+            }
+
+            auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+            index->BulkLoad(elements.begin(), elements.end(), 0.7);
+            return index;
+        }();
+        return *index;
+    }
+
+    // Half of the keys are found in the B+Tree
+    std::vector<int64_t> RandomKeys(size_t count, KeyGenerator &keys) {
+        std::vector<int64_t> batch(count);
+        for (auto &key: batch) {
+            key = keys.Next(kKeyCount * 2);
+        }
+        return batch;
+    }
+
+    template<typename Lookup>
+    void RunLookups(benchmark::State &state, Lookup lookup) {
+        auto &index = GetIndex();
+        KeyGenerator keys{42};
+
+        std::vector<std::optional<int64_t>> values(kBatchSize);
+        for (auto _: state) {
+            state.PauseTiming();
+            auto batch = RandomKeys(values.size(), keys);
+            state.ResumeTiming();
+
+            lookup(index, batch, values);
+            benchmark::DoNotOptimize(values.data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * kBatchSize);
+    }
+
+    void BM_MaybeGetLoop(benchmark::State &state) {
+        RunLookups(state, [](Index &index, auto &batch, auto &values) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                values[i] = index.MaybeGet(batch[i]);
+            }
+        });
+    }
+
+    void BM_MultiGet(benchmark::State &state) {
+        RunLookups(state, [](Index &index, auto &batch, auto &values) {
+            index.MultiGet(batch.data(), batch.size(), values.data());
+        });
+    }
+
+#ifdef BPLUSTREE_COROUTINES
+
+    void BM_InterleavedGet(benchmark::State &state) {
+        auto group_size = static_cast<size_t>(state.range(0));
+        RunLookups(state, [group_size](Index &index, auto &batch, auto &values) {
+            index.InterleavedGet(batch.data(), batch.size(), values.data(), group_size);
+        });
+    }
+
+    BENCHMARK(BM_InterleavedGet)->RangeMultiplier(2)->Range(1, 64)->ArgName("group_size");
+
+#endif /* BPLUSTREE_COROUTINES */
+
+    BENCHMARK(BM_MaybeGetLoop);
+    BENCHMARK(BM_MultiGet);
+}
@@ -0,0 +1,107 @@
+/*
+ * Compares key search kernels within a single node, for fanouts from 32
+ * to 256 keys.
+ *
+ * The keys are searched both in a contiguous key array, and embedded in an
+ * array of key-value pairs like in the leaf nodes. The baseline is the
+ * binary search done by `std::lower_bound`.
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/key_search.h"
+
+namespace bplustree {
+    using key_search::SearchKernel;
+
+    template<typename KeyType>
+    std::vector<KeyType> SortedKeys(size_t count) {
+        std::vector<KeyType> keys(count);
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = static_cast<KeyType>(i * 2);
+        }
+        return keys;
+    }
+
+    // Search keys are generated up front, so that the branch predictor
+    // cannot learn the outcome of the binary search
+    template<typename KeyType>
+    std::vector<KeyType> SearchKeys(size_t count) {
+        std::vector<KeyType> search_keys(4096);
+        std::mt19937_64 gen{42};
+        std::uniform_int_distribution<uint64_t> distribution{0, count * 2};
+        for (auto &key: search_keys) {
+            key = static_cast<KeyType>(distribution(gen));
+        }
+        return search_keys;
+    }
+
+    template<typename KeyType>
+    void BM_BinarySearch(benchmark::State &state) {
+        auto keys = SortedKeys<KeyType>(state.range(0));
+        std::vector<std::pair<KeyType, KeyType>> pairs;
+        for (auto key: keys) { pairs.emplace_back(key, key); }
+        auto search_keys = SearchKeys<KeyType>(keys.size());
+
+        size_t i = 0;
+        for (auto _: state) {
+            auto key = search_keys[i++ & 4095];
+            auto iter = std::lower_bound(pairs.begin(), pairs.end(), key,
+                                         [](const auto &a, const KeyType &b) { return a.first < b; });
+            benchmark::DoNotOptimize(iter);
+        }
+    }
+
+    template<typename KeyType, SearchKernel kernel, bool contiguous>
+    void BM_CountLess(benchmark::State &state) {
+        if (!key_search::IsSupported(kernel)) {
+            state.SkipWithError("Search kernel not supported by this CPU");
+            return;
+        }
+
+        auto keys = SortedKeys<KeyType>(state.range(0));
+        std::vector<std::pair<KeyType, KeyType>> pairs;
+        for (auto key: keys) { pairs.emplace_back(key, key); }
+        auto search_keys = SearchKeys<KeyType>(keys.size());
+
+        const void *base = contiguous ? static_cast<const void *>(keys.data()) : &pairs.data()->first;
+        size_t stride = contiguous ? sizeof(KeyType) : sizeof(std::pair<KeyType, KeyType>);
+
+        size_t i = 0;
+        for (auto _: state) {
+            auto key = search_keys[i++ & 4095];
+            benchmark::DoNotOptimize(key_search::CountLess(kernel, base, keys.size(), stride, key));
+        }
+    }
+
+    template<typename KeyType, bool contiguous>
+    void BM_LowerBound(benchmark::State &state) {
+        auto keys = SortedKeys<KeyType>(state.range(0));
+        std::vector<std::pair<KeyType, KeyType>> pairs;
+        for (auto key: keys) { pairs.emplace_back(key, key); }
+        auto search_keys = SearchKeys<KeyType>(keys.size());
+
+        const void *base = contiguous ? static_cast<const void *>(keys.data()) : &pairs.data()->first;
+        size_t stride = contiguous ? sizeof(KeyType) : sizeof(std::pair<KeyType, KeyType>);
+
+        size_t i = 0;
+        for (auto _: state) {
+            auto key = search_keys[i++ & 4095];
+            benchmark::DoNotOptimize(key_search::LowerBound(base, keys.size(), stride, key));
+        }
+    }
+
+#define BPLUSTREE_KEY_SEARCH_BENCHMARK(KeyType)                                                          \
+    BENCHMARK_TEMPLATE(BM_BinarySearch, KeyType)->RangeMultiplier(2)->Range(32, 256);                    \
+    BENCHMARK_TEMPLATE(BM_CountLess, KeyType, SearchKernel::Scalar, true)->RangeMultiplier(2)->Range(32, 256); \
+    BENCHMARK_TEMPLATE(BM_CountLess, KeyType, SearchKernel::SSE42, true)->RangeMultiplier(2)->Range(32, 256);  \
+    BENCHMARK_TEMPLATE(BM_CountLess, KeyType, SearchKernel::AVX2, true)->RangeMultiplier(2)->Range(32, 256);   \
+    BENCHMARK_TEMPLATE(BM_CountLess, KeyType, SearchKernel::AVX2, false)->RangeMultiplier(2)->Range(32, 256);  \
+    BENCHMARK_TEMPLATE(BM_LowerBound, KeyType, true)->RangeMultiplier(2)->Range(32, 256);               \
+    BENCHMARK_TEMPLATE(BM_LowerBound, KeyType, false)->RangeMultiplier(2)->Range(32, 256)
+
+    BPLUSTREE_KEY_SEARCH_BENCHMARK(int32_t);
+    BPLUSTREE_KEY_SEARCH_BENCHMARK(int64_t);
+}
@@ -0,0 +1,106 @@
+/*
+ * Compares looking up a batch of keys with `MultiGet` against calling
+ * `MaybeGet` in a loop.
+ *
+ * The B+Tree holds enough keys to be larger than the last level cache, and
+ * the keys are uniformly random, so nearly every node visited is a cache
+ * miss. `MultiGet` overlaps the misses of a group of lookups by prefetching
+ * the next node of every lookup before reading any of them.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = int64_t{1} << 24;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Built once, and shared by all the benchmarks
+    Index &GetIndex() {
+        static std::unique_ptr<Index> index = [] {
+            std::vector<std::pair<int64_t, int64_t>> elements;
+            elements.reserve(kKeyCount);
+            for (int64_t key = 0; key < kKeyCount; ++key) {
+                elements.emplace_back(key * 2, key);
+            }
+
+            auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+            index->BulkLoad(elements.begin(), elements.end(), 0.7);
+            return index;
+        }();
+        return *index;
+    }
+
+    // Half of the keys are found in the B+Tree
+    std::vector<int64_t> RandomKeys(size_t count, KeyGenerator &keys) {
+        std::vector<int64_t> batch(count);
+        for (auto &key: batch) {
+            key = keys.Next(kKeyCount * 2);
+        }
+        return batch;
+    }
+
+    void BM_MaybeGetLoop(benchmark::State &state) {
+        auto &index = GetIndex();
+        KeyGenerator keys{42};
+
+        std::vector<std::optional<int64_t>> values(state.range(0));
+        for (auto _: state) {
+            state.PauseTiming();
+            auto batch = RandomKeys(values.size(), keys);
+            state.ResumeTiming();
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                values[i] = index.MaybeGet(batch[i]);
+            }
+            benchmark::DoNotOptimize(values.data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_MultiGet(benchmark::State &state) {
+        auto &index = GetIndex();
+        KeyGenerator keys{42};
+
+        std::vector<std::optional<int64_t>> values(state.range(0));
+        for (auto _: state) {
+            state.PauseTiming();
+            auto batch = RandomKeys(values.size(), keys);
+            state.ResumeTiming();
+
+            index.MultiGet(batch.data(), batch.size(), values.data());
+            benchmark::DoNotOptimize(values.data());
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_MaybeGetLoop)->RangeMultiplier(2)->Range(64, 512)->ArgName("keys");
+    BENCHMARK(BM_MultiGet)->RangeMultiplier(2)->Range(64, 512)->ArgName("keys");
+}
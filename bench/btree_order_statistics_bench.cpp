@@ -0,0 +1,89 @@
+/*
+ * Measures counting the keys inside a range, and the cost the order
+ * statistics augmentation adds to inserting keys.
+ *
+ * Without the augmentation, Count() visits every element inside the range.
+ * With it, Count() descends twice from the root and adds up the counts
+ * stored next to the child pointers, so its cost does not grow with the
+ * width of the range.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = 1 << 22;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    std::unique_ptr<Index> BuildIndex(Augmentation augmentation) {
+        std::vector<std::pair<int64_t, int64_t>> elements;
+        elements.reserve(kKeyCount);
+        for (int64_t key = 0; key < kKeyCount; ++key) {
+            elements.emplace_back(key, key);
+        }
+
+        auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize, augmentation);
+        index->BulkLoad(elements.begin(), elements.end());
+        return index;
+    }
+
+    // Counts a window of state.range(0) keys, sliding it across the keys
+    void RunCount(benchmark::State &state, Augmentation augmentation) {
+        auto index = BuildIndex(augmentation);
+        auto width = state.range(0);
+        int64_t lo = 0;
+
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index->Count(lo, lo + width));
+            lo = (lo + 7919) % (kKeyCount - width);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_CountByScan(benchmark::State &state) {
+        RunCount(state, Augmentation::None);
+    }
+
+    void BM_CountWithOrderStatistics(benchmark::State &state) {
+        RunCount(state, Augmentation::OrderStatistics);
+    }
+
+    // Inserts keys into an empty B+Tree in a scattered order
+    void RunInsert(benchmark::State &state, Augmentation augmentation) {
+        auto key_count = state.range(0);
+
+        for (auto _: state) {
+            Index index{kInnerNodeMaxSize, kLeafNodeMaxSize, augmentation};
+            for (int64_t i = 0; i < key_count; ++i) {
+                auto key = (i * 2654435761) % key_count;
+                benchmark::DoNotOptimize(index.Insert(std::make_pair(key, key)));
+            }
+
+            state.PauseTiming();
+            index.FreeTree();
+            state.ResumeTiming();
+        }
+
+        state.SetItemsProcessed(state.iterations() * key_count);
+    }
+
+    void BM_Insert(benchmark::State &state) {
+        RunInsert(state, Augmentation::None);
+    }
+
+    void BM_InsertWithOrderStatistics(benchmark::State &state) {
+        RunInsert(state, Augmentation::OrderStatistics);
+    }
+
+    BENCHMARK(BM_CountByScan)->RangeMultiplier(16)->Range(16, 1 << 20)->ArgName("width");
+    BENCHMARK(BM_CountWithOrderStatistics)->RangeMultiplier(16)->Range(16, 1 << 20)->ArgName("width");
+    BENCHMARK(BM_Insert)->Arg(1 << 20)->ArgName("keys")->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_InsertWithOrderStatistics)->Arg(1 << 20)->ArgName("keys")
+            ->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,87 @@
+/*
+ * Measures how a full range aggregation scales when the range is split
+ * at inner node separators and scanned by several threads.
+ *
+ * Every benchmark sums the values of all the elements in the B+Tree. The
+ * single threaded `Scan` is the baseline. `ParallelScan` gives each thread
+ * its own part of the range, and every thread keeps its own sum.
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = int64_t{1} << 24;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    // Built once, and shared by all the benchmarks
+    Index &GetIndex() {
+        static std::unique_ptr<Index> index = [] {
+            std::vector<std::pair<int64_t, int64_t>> elements;
+            elements.reserve(kKeyCount);
+            for (int64_t key = 0; key < kKeyCount; ++key) {
+                elements.emplace_back(key, key);
+            }
+
+            auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+            index->BulkLoad(elements.begin(), elements.end(), 0.7);
+            return index;
+        }();
+        return *index;
+    }
+
+    void BM_Scan(benchmark::State &state) {
+        auto &index = GetIndex();
+
+        for (auto _: state) {
+            int64_t sum = 0;
+            index.Scan(0, kKeyCount, [&sum](const int64_t &, const int64_t &value) { sum += value; });
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetItemsProcessed(state.iterations() * kKeyCount);
+    }
+
+    void BM_ParallelScan(benchmark::State &state) {
+        auto &index = GetIndex();
+        auto num_threads = static_cast<int>(state.range(0));
+
+        for (auto _: state) {
+            // Padded, so that the threads do not share a cache line
+            std::vector<std::array<int64_t, 8>> sums(num_threads);
+            index.ParallelScan(0, kKeyCount, num_threads,
+                               [&sums](size_t part, const int64_t &, const int64_t &value) {
+                                   sums[part][0] += value;
+                               });
+
+            int64_t sum = 0;
+            for (auto &part_sum: sums) {
+                sum += part_sum[0];
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.SetItemsProcessed(state.iterations() * kKeyCount);
+    }
+
+    void ParallelScanArgs(benchmark::internal::Benchmark *benchmark) {
+        int max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (int num_threads = 1; num_threads < max_threads; num_threads *= 2) {
+            benchmark->Arg(num_threads);
+        }
+        benchmark->Arg(max_threads);
+        benchmark->ArgName("threads");
+    }
+
+    BENCHMARK(BM_Scan)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_ParallelScan)->Apply(ParallelScanArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
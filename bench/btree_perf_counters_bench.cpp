@@ -0,0 +1,137 @@
+/*
+ * Counts the instructions, L1 data cache misses, last level cache misses
+ * and branch mispredicts of single operations on a large B+Tree, through
+ * the hardware performance counters.
+ *
+ * The counters are reported per operation next to the time, so that a
+ * change to the layout of `ElasticNode` or to the search within a node can
+ * be traced to the misses or instructions it saves. Where the counters are
+ * unavailable the benchmarks only report the time, and are labelled so.
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+#include "perf_counters.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeyCount = 1 << 22;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Even keys in [0, 2 * kKeyCount), so that odd keys can be inserted
+    std::unique_ptr<Index> BuildIndex() {
+        std::vector<std::pair<int64_t, int64_t>> elements;
+        elements.reserve(kKeyCount);
+        for (int64_t key = 0; key < kKeyCount; ++key) {
+            elements.emplace_back(key * 2, key);
+        }
+
+        auto index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+        index->BulkLoad(elements.begin(), elements.end());
+        return index;
+    }
+
+    // Keys an insert or delete benchmark visits once each, in a scattered
+    // order
+    std::vector<int64_t> ShuffledKeys(int64_t first, int64_t count) {
+        std::vector<int64_t> keys(count);
+        for (int64_t i = 0; i < count; ++i) {
+            keys[i] = first + i * 2;
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64{42});
+        return keys;
+    }
+
+    void BM_MaybeGet(benchmark::State &state) {
+        auto index = BuildIndex();
+        KeyGenerator keys{1};
+        PerfCounters counters;
+
+        counters.Start();
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index->MaybeGet(keys.Next(kKeyCount) * 2));
+        }
+        counters.Stop();
+        counters.Report(state);
+    }
+
+    void BM_Insert(benchmark::State &state) {
+        auto index = BuildIndex();
+        auto keys = ShuffledKeys(1, state.max_iterations);
+        auto next = keys.begin();
+        PerfCounters counters;
+
+        counters.Start();
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index->Insert(std::make_pair(*next, *next)));
+            ++next;
+        }
+        counters.Stop();
+        counters.Report(state);
+    }
+
+    void BM_Delete(benchmark::State &state) {
+        auto index = BuildIndex();
+        auto keys = ShuffledKeys(0, state.max_iterations);
+        auto next = keys.begin();
+        PerfCounters counters;
+
+        counters.Start();
+        for (auto _: state) {
+            benchmark::DoNotOptimize(index->Delete(*next));
+            ++next;
+        }
+        counters.Stop();
+        counters.Report(state);
+    }
+
+    // Every operation moves the iterator to the next element
+    void BM_Iterate(benchmark::State &state) {
+        auto index = BuildIndex();
+        PerfCounters counters;
+
+        auto iter = index->Begin();
+        counters.Start();
+        for (auto _: state) {
+            if (iter == index->End()) {
+                iter = index->Begin();
+            }
+            benchmark::DoNotOptimize((*iter).second);
+            ++iter;
+        }
+        counters.Stop();
+        counters.Report(state);
+    }
+
+    BENCHMARK(BM_MaybeGet);
+    // Fixed iterations, so that every insert and delete finds its key
+    // absent and present, respectively
+    BENCHMARK(BM_Insert)->Iterations(1 << 20);
+    BENCHMARK(BM_Delete)->Iterations(1 << 20);
+    BENCHMARK(BM_Iterate);
+}
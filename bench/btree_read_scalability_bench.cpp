@@ -0,0 +1,96 @@
+/*
+ * Measures how read throughput scales with the number of reader threads.
+ *
+ * Point lookups descend the B+Tree using optimistic lock coupling and do
+ * not write to any shared latch. The throughput should scale linearly with
+ * threads, both for a read-only workload and while writer threads keep
+ * modifying the B+Tree.
+ */
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeySpace = 1 << 22;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Shared by all the threads of a benchmark run. Thread 0 creates the
+    // index before the timed loop and destroys it after all threads exit
+    // the timed loop.
+    std::unique_ptr<Index> shared_index;
+
+    void PopulateSharedIndex() {
+        shared_index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+        for (int64_t key = 0; key < kKeySpace; key += 2) {
+            shared_index->Insert(std::make_pair(key, key));
+        }
+    }
+
+    void BM_MaybeGet(benchmark::State &state) {
+        if (state.thread_index() == 0) {
+            PopulateSharedIndex();
+        }
+
+        KeyGenerator keys{static_cast<uint64_t>(state.thread_index()) + 1};
+        for (auto _: state) {
+            benchmark::DoNotOptimize(shared_index->MaybeGet(keys.Next(kKeySpace)));
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0) {
+            shared_index.reset();
+        }
+    }
+
+    // One in eight threads writes, the remaining threads only read.
+    void BM_MaybeGetWithWriters(benchmark::State &state) {
+        if (state.thread_index() == 0) {
+            PopulateSharedIndex();
+        }
+
+        KeyGenerator keys{static_cast<uint64_t>(state.thread_index()) + 1};
+        bool writer = state.thread_index() % 8 == 7;
+        bool insert = true;
+        for (auto _: state) {
+            auto key = keys.Next(kKeySpace);
+            if (!writer) {
+                benchmark::DoNotOptimize(shared_index->MaybeGet(key));
+            } else if (insert) {
+                benchmark::DoNotOptimize(shared_index->Insert(std::make_pair(key, key)));
+            } else {
+                benchmark::DoNotOptimize(shared_index->Delete(key));
+            }
+            insert = !insert;
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0) {
+            shared_index.reset();
+        }
+    }
+
+    BENCHMARK(BM_MaybeGet)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK(BM_MaybeGetWithWriters)->ThreadRange(8, 64)->UseRealTime();
+}
@@ -0,0 +1,92 @@
+/*
+ * Measures how write throughput scales with the number of writer threads.
+ *
+ * Every thread writes to the same B+Tree instance. The optimistic path of
+ * `Insert` and `Delete` holds the root latch only in shared mode, so the
+ * throughput should keep increasing with threads until the cores are
+ * saturated, instead of flattening out on the root latch.
+ */
+#include <benchmark/benchmark.h>
+#include <limits>
+#include <memory>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    constexpr int kInnerNodeMaxSize = 127;
+    constexpr int kLeafNodeMaxSize = 128;
+    constexpr int64_t kKeySpace = 1 << 22;
+
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class KeyGenerator {
+    public:
+        explicit KeyGenerator(uint64_t seed) : state_{seed} {}
+
+        int64_t Next(int64_t bound) {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            return static_cast<int64_t>(z % static_cast<uint64_t>(bound));
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    // Shared by all the threads of a benchmark run. Thread 0 creates the
+    // index before the timed loop and destroys it after all threads exit
+    // the timed loop.
+    std::unique_ptr<Index> shared_index;
+
+    void BM_Insert(benchmark::State &state) {
+        if (state.thread_index() == 0) {
+            shared_index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+        }
+
+        KeyGenerator keys{static_cast<uint64_t>(state.thread_index()) + 1};
+        for (auto _: state) {
+            auto key = keys.Next(std::numeric_limits<int64_t>::max());
+            benchmark::DoNotOptimize(shared_index->Insert(std::make_pair(key, key)));
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0) {
+            shared_index.reset();
+        }
+    }
+
+    void BM_InsertDelete(benchmark::State &state) {
+        if (state.thread_index() == 0) {
+            shared_index = std::make_unique<Index>(kInnerNodeMaxSize, kLeafNodeMaxSize);
+            for (int64_t key = 0; key < kKeySpace; key += 2) {
+                shared_index->Insert(std::make_pair(key, key));
+            }
+        }
+
+        // Keeps the size of the index stable, as about half the inserts
+        // and deletes succeed
+        KeyGenerator keys{static_cast<uint64_t>(state.thread_index()) + 1};
+        bool insert = state.thread_index() % 2 == 0;
+        for (auto _: state) {
+            auto key = keys.Next(kKeySpace);
+            if (insert) {
+                benchmark::DoNotOptimize(shared_index->Insert(std::make_pair(key, key)));
+            } else {
+                benchmark::DoNotOptimize(shared_index->Delete(key));
+            }
+            insert = !insert;
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        if (state.thread_index() == 0) {
+            shared_index.reset();
+        }
+    }
+
+    BENCHMARK(BM_Insert)->ThreadRange(1, 64)->UseRealTime();
+    BENCHMARK(BM_InsertDelete)->ThreadRange(1, 64)->UseRealTime();
+}
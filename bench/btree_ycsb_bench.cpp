@@ -0,0 +1,423 @@
+/*
+ * YCSB-style workloads over a B+Tree shared by all the threads.
+ *
+ *   A  50% read, 50% update
+ *   B  95% read, 5% update
+ *   C  100% read
+ *   D  95% read of recently inserted keys, 5% insert
+ *   E  95% short scan of up to 100 keys, 5% insert
+ *   F  50% read, 50% read-modify-write
+ *
+ * The keys which are read, updated and scanned are chosen uniformly, from
+ * a Zipfian distribution, or sequentially, from the keys loaded before the
+ * run. Inserts append new keys past the loaded ones. The B+Tree does not
+ * overwrite values, so an update deletes the key and inserts it again.
+ *
+ * Besides the throughput, every run reports the 50th, 99th and 99.9th
+ * percentile latency of a single operation in nanoseconds. The latencies
+ * are recorded in a histogram whose buckets are within 1/16 of each other.
+ *
+ * Flags, which follow the Google Benchmark flags:
+ *
+ *   --fanouts=127:128,255:256  inner:leaf node max sizes, one run each
+ *   --records=1048576          no. of keys loaded before each run
+ *
+ * Build it with the `release` preset, as ThreadSanitizer distorts every
+ * measurement.
+ */
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using Index = BPlusTree<int64_t, int64_t>;
+
+    enum class Workload { A, B, C, D, E, F };
+
+    enum class KeyDistribution { Uniform, Zipfian, Sequential };
+
+    constexpr int kMaxScanLength = 100;
+
+    /**
+     * splitmix64, a fast generator for well distributed keys
+     */
+    class RandomGenerator {
+    public:
+        explicit RandomGenerator(uint64_t seed) : state_{seed} {}
+
+        uint64_t Next() {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, 1)
+        double NextDouble() { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+
+    private:
+        uint64_t state_;
+    };
+
+    /**
+     * Ranks in `[0, n)` where rank 0 is the most popular, following Gray
+     * et al., "Quickly Generating Billion-Record Synthetic Databases", like
+     * the YCSB Zipfian generator. The constants are computed once and
+     * shared by all the threads.
+     */
+    class ZipfianGenerator {
+    public:
+        explicit ZipfianGenerator(int64_t n, double theta = 0.99) : n_{n} {
+            double zeta_n = 0;
+            for (int64_t i = 1; i <= n; ++i) {
+                zeta_n += 1.0 / std::pow(static_cast<double>(i), theta);
+            }
+            zeta_two_ = 1.0 + 1.0 / std::pow(2.0, theta);
+            alpha_ = 1.0 / (1.0 - theta);
+            eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta_two_ / zeta_n);
+            zeta_n_ = zeta_n;
+        }
+
+        int64_t Next(double u) const {
+            double uz = u * zeta_n_;
+            if (uz < 1.0) { return 0; }
+            if (uz < zeta_two_) { return 1; }
+
+            auto rank = static_cast<int64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+            return std::min(rank, n_ - 1);
+        }
+
+    private:
+        int64_t n_;
+        double zeta_n_{0};
+        double zeta_two_{0};
+        double alpha_{0};
+        double eta_{0};
+    };
+
+    /**
+     * Chooses the loaded keys which a thread reads, updates and scans.
+     */
+    class KeyChooser {
+    public:
+        KeyChooser(KeyDistribution distribution, int64_t records, const ZipfianGenerator *zipfian,
+                   int thread_index, int threads) :
+                distribution_{distribution},
+                records_{records},
+                zipfian_{zipfian},
+                random_{static_cast<uint64_t>(thread_index) + 1},
+                // Each thread starts walking at its own share of the keys
+                cursor_{records * thread_index / threads} {}
+
+        /**
+         * @return a position in `[0, records)`, where the most popular
+         * Zipfian rank is 0
+         */
+        int64_t NextRank() {
+            switch (distribution_) {
+                case KeyDistribution::Uniform:
+                    return static_cast<int64_t>(random_.Next() % static_cast<uint64_t>(records_));
+                case KeyDistribution::Zipfian:
+                    return zipfian_->Next(random_.NextDouble());
+                case KeyDistribution::Sequential:
+                    cursor_ = cursor_ + 1 == records_ ? 0 : cursor_ + 1;
+                    return cursor_;
+            }
+            return 0;
+        }
+
+        /**
+         * @return a loaded key. The popular Zipfian ranks are scattered
+         * over the keys, instead of being neighbours in the same leaf node.
+         */
+        int64_t NextKey() {
+            auto rank = NextRank();
+            if (distribution_ != KeyDistribution::Zipfian) { return rank; }
+
+            // FNV-1a of the rank, like the YCSB scrambled Zipfian generator
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (int byte = 0; byte < 8; ++byte) {
+                hash ^= (static_cast<uint64_t>(rank) >> (byte * 8)) & 0xff;
+                hash *= 0x100000001b3ULL;
+            }
+            return static_cast<int64_t>(hash % static_cast<uint64_t>(records_));
+        }
+
+        RandomGenerator &Random() { return random_; }
+
+    private:
+        KeyDistribution distribution_;
+        int64_t records_;
+        const ZipfianGenerator *zipfian_;
+        RandomGenerator random_;
+        int64_t cursor_;
+    };
+
+    /**
+     * Latencies in nanoseconds. Below 16ns every value has its own bucket.
+     * Above, each power of two is split into 16 buckets, so a percentile
+     * is reported as the low end of a bucket at most 1/16 narrower than
+     * its value.
+     */
+    class LatencyHistogram {
+    public:
+        void Record(uint64_t latency) { counts_[BucketOf(latency)] += 1; }
+
+        void Merge(const LatencyHistogram &other) {
+            for (size_t bucket = 0; bucket < counts_.size(); ++bucket) {
+                counts_[bucket] += other.counts_[bucket];
+            }
+        }
+
+        /**
+         * @param fraction of the recorded latencies which are at or below
+         * the returned latency
+         */
+        uint64_t Percentile(double fraction) const {
+            uint64_t total = 0;
+            for (auto count: counts_) { total += count; }
+            if (total == 0) { return 0; }
+
+            auto target = static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+            uint64_t seen = 0;
+            for (size_t bucket = 0; bucket < counts_.size(); ++bucket) {
+                seen += counts_[bucket];
+                if (seen >= std::max<uint64_t>(target, 1)) { return LowEndOf(static_cast<int>(bucket)); }
+            }
+            return LowEndOf(static_cast<int>(counts_.size()) - 1);
+        }
+
+        void Clear() { counts_.fill(0); }
+
+    private:
+        static constexpr int kSubBuckets = 16;
+        static constexpr int kSubBucketBits = 4;
+
+        static int BucketOf(uint64_t latency) {
+            if (latency < kSubBuckets) { return static_cast<int>(latency); }
+
+            int shift = 63 - __builtin_clzll(latency) - kSubBucketBits;
+            return (shift + 1) * kSubBuckets + static_cast<int>((latency >> shift) & (kSubBuckets - 1));
+        }
+
+        static uint64_t LowEndOf(int bucket) {
+            int group = bucket / kSubBuckets;
+            uint64_t sub_bucket = bucket % kSubBuckets;
+            if (group == 0) { return sub_bucket; }
+            return (kSubBuckets + sub_bucket) << (group - 1);
+        }
+
+        std::array<uint64_t, (64 - kSubBucketBits + 1) * kSubBuckets> counts_{};
+    };
+
+    // Built once for the no. of records, as it visits every rank
+    std::unique_ptr<ZipfianGenerator> shared_zipfian;
+
+    // Shared by all the threads of a benchmark run. Thread 0 sets them up
+    // before the timed loop. After the timed loop every thread merges its
+    // latencies, and thread 0 reports the percentiles once all of them
+    // are merged, and then destroys the index.
+    std::unique_ptr<Index> shared_index;
+    std::atomic<int64_t> next_insert_key;
+    std::mutex latencies_mutex;
+    LatencyHistogram shared_latencies;
+    std::atomic<int> merged_threads;
+
+    void LoadSharedIndex(int inner_node_max_size, int leaf_node_max_size, int64_t records) {
+        std::vector<std::pair<int64_t, int64_t>> elements;
+        elements.reserve(records);
+        for (int64_t key = 0; key < records; ++key) {
+            elements.emplace_back(key, key);
+        }
+
+        shared_index = std::make_unique<Index>(inner_node_max_size, leaf_node_max_size);
+        shared_index->BulkLoad(elements.begin(), elements.end());
+        next_insert_key.store(records);
+    }
+
+    // The B+Tree has no update in place
+    void Update(int64_t key, int64_t value) {
+        shared_index->Delete(key);
+        shared_index->Insert(std::make_pair(key, value));
+    }
+
+    void Insert() {
+        auto key = next_insert_key.fetch_add(1, std::memory_order_relaxed);
+        shared_index->Insert(std::make_pair(key, key));
+    }
+
+    void RunOperation(Workload workload, KeyChooser &keys) {
+        auto &random = keys.Random();
+        auto draw = random.NextDouble();
+
+        switch (workload) {
+            case Workload::A:
+            case Workload::B: {
+                auto key = keys.NextKey();
+                if (draw < (workload == Workload::A ? 0.5 : 0.95)) {
+                    benchmark::DoNotOptimize(shared_index->MaybeGet(key));
+                } else {
+                    Update(key, static_cast<int64_t>(random.Next()));
+                }
+                break;
+            }
+            case Workload::C:
+                benchmark::DoNotOptimize(shared_index->MaybeGet(keys.NextKey()));
+                break;
+            case Workload::D:
+                if (draw < 0.95) {
+                    // The most popular rank is the latest key
+                    auto latest = next_insert_key.load(std::memory_order_relaxed) - 1;
+                    auto offset = std::min(keys.NextRank(), latest);
+                    benchmark::DoNotOptimize(shared_index->MaybeGet(latest - offset));
+                } else {
+                    Insert();
+                }
+                break;
+            case Workload::E:
+                if (draw < 0.95) {
+                    auto lo = keys.NextKey();
+                    auto length = static_cast<int64_t>(random.Next() % kMaxScanLength) + 1;
+                    benchmark::DoNotOptimize(shared_index->Scan(lo, lo + length - 1,
+                                                                [](const int64_t &, const int64_t &) {}));
+                } else {
+                    Insert();
+                }
+                break;
+            case Workload::F: {
+                auto key = keys.NextKey();
+                auto value = shared_index->MaybeGet(key);
+                benchmark::DoNotOptimize(value);
+                if (draw >= 0.5) {
+                    Update(key, value.value_or(0) + 1);
+                }
+                break;
+            }
+        }
+    }
+
+    void RunWorkload(benchmark::State &state, Workload workload, KeyDistribution distribution,
+                     int inner_node_max_size, int leaf_node_max_size, int64_t records) {
+        if (state.thread_index() == 0) {
+            LoadSharedIndex(inner_node_max_size, leaf_node_max_size, records);
+            shared_latencies.Clear();
+            merged_threads.store(0);
+        }
+
+        KeyChooser keys{distribution, records, shared_zipfian.get(), state.thread_index(), state.threads()};
+        LatencyHistogram latencies;
+        for (auto _: state) {
+            auto start = std::chrono::steady_clock::now();
+            RunOperation(workload, keys);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            latencies.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        {
+            std::lock_guard<std::mutex> guard{latencies_mutex};
+            shared_latencies.Merge(latencies);
+        }
+        merged_threads.fetch_add(1);
+
+        if (state.thread_index() == 0) {
+            while (merged_threads.load() < state.threads()) {
+                std::this_thread::yield();
+            }
+
+            // Counters are added up over the threads, so only thread 0
+            // reports the percentiles
+            state.counters["p50_ns"] = static_cast<double>(shared_latencies.Percentile(0.5));
+            state.counters["p99_ns"] = static_cast<double>(shared_latencies.Percentile(0.99));
+            state.counters["p999_ns"] = static_cast<double>(shared_latencies.Percentile(0.999));
+            shared_index.reset();
+        }
+    }
+
+    struct Options {
+        std::vector<std::pair<int, int>> fanouts_{{127, 128}};
+        int64_t records_{1 << 20};
+    };
+
+    /**
+     * Reads the flags which Google Benchmark did not consume.
+     *
+     * @return false when a flag is not recognized or malformed
+     */
+    bool ParseOptions(int argc, char **argv, Options &options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string flag{argv[i]};
+            if (flag.rfind("--fanouts=", 0) == 0) {
+                options.fanouts_.clear();
+                std::stringstream list{flag.substr(std::string{"--fanouts="}.size())};
+                std::string fanout;
+                while (std::getline(list, fanout, ',')) {
+                    int inner = 0;
+                    int leaf = 0;
+                    if (std::sscanf(fanout.c_str(), "%d:%d", &inner, &leaf) != 2 || inner < 3 || leaf < 3) {
+                        return false;
+                    }
+                    options.fanouts_.emplace_back(inner, leaf);
+                }
+                if (options.fanouts_.empty()) { return false; }
+            } else if (flag.rfind("--records=", 0) == 0) {
+                options.records_ = std::atoll(flag.c_str() + std::string{"--records="}.size());
+                if (options.records_ < kMaxScanLength) { return false; }
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    using namespace bplustree;
+
+    benchmark::Initialize(&argc, argv);
+
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: %s [benchmark flags] [--fanouts=inner:leaf,...] [--records=N]\n", argv[0]);
+        return 1;
+    }
+
+    const std::vector<std::pair<Workload, const char *>> workloads{
+            {Workload::A, "A"}, {Workload::B, "B"}, {Workload::C, "C"},
+            {Workload::D, "D"}, {Workload::E, "E"}, {Workload::F, "F"}};
+    const std::vector<std::pair<KeyDistribution, const char *>> distributions{
+            {KeyDistribution::Uniform, "uniform"}, {KeyDistribution::Zipfian, "zipfian"},
+            {KeyDistribution::Sequential, "sequential"}};
+    shared_zipfian = std::make_unique<ZipfianGenerator>(options.records_);
+    auto max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (auto [inner, leaf]: options.fanouts_) {
+        for (auto [workload, workload_name]: workloads) {
+            for (auto [distribution, distribution_name]: distributions) {
+                auto name = std::string{"YCSB_"} + workload_name + "/" + distribution_name +
+                            "/inner:" + std::to_string(inner) + "/leaf:" + std::to_string(leaf);
+                auto records = options.records_;
+                benchmark::RegisterBenchmark(name.c_str(), [=](benchmark::State &state) {
+                    RunWorkload(state, workload, distribution, inner, leaf, records);
+                })->ThreadRange(1, max_threads)->UseRealTime();
+            }
+        }
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Hardware performance counters of the calling thread, read through the
+ * Linux `perf_event_open` system call.
+ *
+ * A counter is missing when the kernel refuses to open it, which happens
+ * on other platforms, in containers and virtual machines without a PMU,
+ * and when `kernel.perf_event_paranoid` forbids it. The benchmarks then
+ * run as usual and report only the counters which could be opened.
+ */
+#ifndef BTREE_PERF_COUNTERS_H
+#define BTREE_PERF_COUNTERS_H
+
+#include <benchmark/benchmark.h>
+#include <array>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bplustree {
+    class PerfCounters {
+    public:
+        enum Event { kInstructions, kL1DataMisses, kLlcMisses, kBranchMisses, kEventCount };
+
+        /**
+         * Opens every counter in a disabled state. Only user space of the
+         * calling thread is counted.
+         */
+        PerfCounters() {
+            fds_.fill(-1);
+#if defined(__linux__)
+            fds_[kInstructions] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fds_[kL1DataMisses] = Open(PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_L1D));
+            fds_[kLlcMisses] = Open(PERF_TYPE_HW_CACHE, CacheMissConfig(PERF_COUNT_HW_CACHE_LL));
+            fds_[kBranchMisses] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        ~PerfCounters() {
+#if defined(__linux__)
+            for (auto fd: fds_) {
+                if (fd != -1) { close(fd); }
+            }
+#endif
+        }
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        // Resets the counters to zero and starts counting
+        void Start() {
+            for (auto fd: fds_) {
+                if (fd == -1) { continue; }
+#if defined(__linux__)
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+            }
+        }
+
+        // Stops counting, keeping the values counted so far
+        void Stop() {
+            for (auto fd: fds_) {
+                if (fd == -1) { continue; }
+#if defined(__linux__)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+            }
+        }
+
+        /**
+         * The kernel multiplexes counters when the PMU has fewer of them
+         * than were opened, so the value is scaled up to the whole time the
+         * counter was enabled.
+         *
+         * @return false when the counter could not be opened or read
+         */
+        bool Read(Event event, double &value) const {
+            if (fds_[event] == -1) { return false; }
+#if defined(__linux__)
+            // Laid out by PERF_FORMAT_TOTAL_TIME_ENABLED and _RUNNING
+            struct {
+                uint64_t value_;
+                uint64_t time_enabled_;
+                uint64_t time_running_;
+            } reading{};
+            if (read(fds_[event], &reading, sizeof(reading)) != sizeof(reading)) { return false; }
+
+            value = static_cast<double>(reading.value_);
+            if (reading.time_running_ > 0 && reading.time_running_ < reading.time_enabled_) {
+                value *= static_cast<double>(reading.time_enabled_) / static_cast<double>(reading.time_running_);
+            }
+            return true;
+#else
+            (void) value;
+            return false;
+#endif
+        }
+
+        /**
+         * Adds every counter which could be read to the benchmark, divided
+         * by its no. of iterations. The label notes when none could be.
+         */
+        void Report(benchmark::State &state) const {
+            static constexpr std::array<const char *, kEventCount> kNames{
+                    "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+            bool reported = false;
+            for (int event = 0; event < kEventCount; ++event) {
+                double value = 0;
+                if (Read(static_cast<Event>(event), value)) {
+                    state.counters[kNames[event]] = benchmark::Counter(value, benchmark::Counter::kAvgIterations);
+                    reported = true;
+                }
+            }
+            if (!reported) {
+                state.SetLabel("perf counters unavailable");
+            }
+        }
+
+    private:
+#if defined(__linux__)
+        static uint64_t CacheMissConfig(uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        // @return the file descriptor of the counter, or -1
+        static int Open(uint32_t type, uint64_t config) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            auto fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            return fd < 0 ? -1 : static_cast<int>(fd);
+        }
+#endif
+
+        std::array<int, kEventCount> fds_{};
+    };
+}
+
+#endif //BTREE_PERF_COUNTERS_H
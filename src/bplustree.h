@@ -1,15 +1,30 @@
 #ifndef BPLUSTREE_H
 #define BPLUSTREE_H
 
+#include <cstddef>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <limits>
+#include <numeric>
 #include <utility>
 #include <vector>
 #include <sstream>
 #include <queue>
 #include <optional>
+#include <functional>
+#include <type_traits>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "macros.h"
 #include "shared_latch.h"
+#include "epoch.h"
+#include "node_allocator.h"
+#include "operation_counters.h"
+#include "key_search.h"
+#include "coroutine_task.h"
 
 namespace bplustree {
     enum class NodeType : int {
@@ -24,7 +39,7 @@ namespace bplustree {
      * @param y
      * @return ceiling of x when divided by y
      */
-    int FastCeilIntDivision(int x, int y) {
+    inline int FastCeilIntDivision(int x, int y) {
         BPLUSTREE_ASSERT(x != 0, "x should be greater than zero");
 
         return 1 + ((x - 1) / y);
@@ -53,24 +68,146 @@ namespace bplustree {
 
         bool TrySharedLock() { return node_latch_.TryLockShared(); }
 
+        bool TryOptimisticRead(uint64_t &version) const { return node_latch_.TryOptimisticRead(version); }
+
+        bool ValidateOptimisticRead(uint64_t version) const { return node_latch_.ValidateOptimisticRead(version); }
+
+        LatchCounts GetLatchCounts() const { return node_latch_.GetCounts(); }
+
     private:
         NodeType type_;
         int max_size_;
-        SharedLatch node_latch_;
+        VersionedLatch node_latch_;
     };
 
-    using KeyNodePointerPair = std::pair<int, BaseNode *>;
-    using KeyValuePair = std::pair<int, int>;
+    /**
+     * Random access iterator over the elements of a node.
+     *
+     * A node stores its keys and its payloads in two separate arrays. The
+     * iterator advances through both arrays in lockstep, and dereferences to
+     * a pair of references to the key and the payload of the element.
+     */
+    template<typename KeyType, typename PayloadType>
+    class ElementIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::pair<KeyType, PayloadType>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<KeyType &, PayloadType &>;
+
+        // Allows `iter->first` and `iter->second` on a proxy reference
+        struct pointer {
+            reference ref_;
+
+            reference *operator->() { return &ref_; }
+        };
+
+        ElementIterator() = default;
+
+        ElementIterator(KeyType *p_key, PayloadType *p_payload) : key_{p_key}, payload_{p_payload} {}
+
+        KeyType *Key() const { return key_; }
+
+        PayloadType *Payload() const { return payload_; }
+
+        reference operator*() const { return reference{*key_, *payload_}; }
+
+        pointer operator->() const { return pointer{**this}; }
+
+        reference operator[](difference_type n) const { return reference{key_[n], payload_[n]}; }
+
+        ElementIterator &operator++() {
+            ++key_;
+            ++payload_;
+            return *this;
+        }
+
+        ElementIterator operator++(int) {
+            auto previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        ElementIterator &operator--() {
+            --key_;
+            --payload_;
+            return *this;
+        }
+
+        ElementIterator operator--(int) {
+            auto previous = *this;
+            --(*this);
+            return previous;
+        }
+
+        ElementIterator &operator+=(difference_type n) {
+            key_ += n;
+            payload_ += n;
+            return *this;
+        }
+
+        ElementIterator &operator-=(difference_type n) { return *this += -n; }
+
+        ElementIterator operator+(difference_type n) const { return ElementIterator{key_ + n, payload_ + n}; }
 
-    template<typename ElementType>
+        ElementIterator operator-(difference_type n) const { return ElementIterator{key_ - n, payload_ - n}; }
+
+        friend ElementIterator operator+(difference_type n, const ElementIterator &iter) { return iter + n; }
+
+        difference_type operator-(const ElementIterator &other) const { return key_ - other.key_; }
+
+        bool operator==(const ElementIterator &other) const { return key_ == other.key_; }
+
+        bool operator!=(const ElementIterator &other) const { return key_ != other.key_; }
+
+        bool operator<(const ElementIterator &other) const { return key_ < other.key_; }
+
+        bool operator>(const ElementIterator &other) const { return key_ > other.key_; }
+
+        bool operator<=(const ElementIterator &other) const { return key_ <= other.key_; }
+
+        bool operator>=(const ElementIterator &other) const { return key_ >= other.key_; }
+
+    private:
+        KeyType *key_{nullptr};
+        PayloadType *payload_{nullptr};
+    };
+
+    /**
+     * Node Layout
+     * -----------
+     *
+     * The elements of a node live in the same allocation as the node. The
+     * keys are stored in one array, and the payloads (node pointers in an
+     * inner node, values in a leaf node) in a second array which follows it.
+     *
+     *  +--------+--------------------------+------------------------------+
+     *  | header | key[0] ... key[max-1]    | payload[0] ... payload[max-1]|
+     *  +--------+--------------------------+------------------------------+
+     *
+     * A lookup only compares keys, so keeping them contiguous means the
+     * search touches fewer cache lines than it would if every key was
+     * interleaved with its payload. Only the payload of the element which
+     * was found is read. The vectorized key search also loads the keys
+     * directly instead of gathering them.
+     */
+    template<typename KeyType, typename ElementType>
     class ElasticNode : public BaseNode {
     public:
-        ElasticNode(NodeType p_type, KeyNodePointerPair p_low_key, int p_max_size) :
+        using KeyNodePointerPair = std::pair<KeyType, BaseNode *>;
+        using PayloadType = typename ElementType::second_type;
+        using ElementIterator = bplustree::ElementIterator<KeyType, PayloadType>;
+        using ElementReference = typename ElementIterator::reference;
+
+        ElasticNode(NodeType p_type, KeyNodePointerPair p_low_key, int p_max_size, NodeAllocator *p_allocator,
+                    int p_summary_size) :
                 BaseNode(p_type, p_max_size),
                 low_key_{p_low_key},
                 sibling_left_{nullptr},
                 sibling_right_{nullptr},
-                end_{start_} {}
+                allocator_{p_allocator},
+                size_{0},
+                summary_size_{p_summary_size} {}
 
         /**
          *
@@ -80,32 +217,39 @@ namespace bplustree {
         ElasticNode *SplitNode() {
             if (this->GetCurrentSize() < this->GetMaxSize()) return nullptr;
 
-            ElasticNode *new_node = this->Get(this->GetType(), this->GetLowKeyPair(), this->GetMaxSize());
-            ElementType *copy_from_location = std::next(this->Begin(), FastCeilIntDivision(this->GetCurrentSize(), 2));
+            ElasticNode *new_node = this->Get(this->GetType(), this->GetLowKeyPair(), this->GetMaxSize(), allocator_,
+                                              summary_size_);
+            int split_offset = FastCeilIntDivision(this->GetCurrentSize(), 2);
+            int move_count = this->GetCurrentSize() - split_offset;
 
-            std::memcpy(
-                    reinterpret_cast<void *>(new_node->Begin()),
-                    reinterpret_cast<void *>(copy_from_location),
-                    std::distance(copy_from_location, this->End()) * sizeof(ElementType)
-            );
-            new_node->SetEnd(std::distance(copy_from_location, this->End()));
-            end_ = copy_from_location;
+            RelocateElements(new_node->Begin(), std::next(this->Begin(), split_offset), move_count);
+            CopySummaries(new_node, 1, this, split_offset + 1, move_count);
+            new_node->SetEnd(move_count);
+            SetEnd(split_offset);
 
             return new_node;
         }
 
         /**
          * Static helper to allocate storage for an elastic node.
+         *
+         * @param p_summary_size no. of bytes of the summary stored for each
+         * child pointer. Zero for nodes without summaries.
          */
-        static ElasticNode *Get(NodeType p_type, KeyNodePointerPair p_low_key, int p_max_size) {
-            auto *alloc = new char[sizeof(ElasticNode) + p_max_size * sizeof(ElementType)];
+        static ElasticNode *Get(NodeType p_type, KeyNodePointerPair p_low_key, int p_max_size,
+                                NodeAllocator *p_allocator, int p_summary_size = 0) {
+            auto *alloc = p_allocator->Allocate(AllocationSize(p_max_size, p_summary_size));
 
             /**
              * Construct elastic node in allocated storage
              * https://en.cppreference.com/w/cpp/language/new#Placement_new
              */
             auto elastic_node = reinterpret_cast<ElasticNode *>(alloc);
-            new(elastic_node) ElasticNode(p_type, p_low_key, p_max_size);
+            new(elastic_node) ElasticNode(p_type, p_low_key, p_max_size, p_allocator, p_summary_size);
+
+            if (p_summary_size > 0) {
+                std::memset(elastic_node->Summary(0), 0, (p_max_size + 1) * p_summary_size);
+            }
 
             return elastic_node;
         }
@@ -124,74 +268,137 @@ namespace bplustree {
          * before the raw memory is freed, preventing resource leaks.
          */
         void FreeElasticNode() {
-            for (ElementType *element = this->Begin(); element < this->End(); ++element) {
-                element->~ElementType();
+            for (auto element = this->Begin(); element < this->End(); ++element) {
+                DestroyElement(element);
             }
+
+            auto allocator = allocator_;
+            auto allocation_size = AllocationSize(this->GetMaxSize(), summary_size_);
             this->~BaseNode();
-            delete[] reinterpret_cast<char *>(this);
+            allocator->Deallocate(this, allocation_size);
         }
 
-        void SetEnd(int offset) { end_ = start_ + offset; }
+        void SetEnd(int offset) { size_ = offset; }
 
-        ElementType *Begin() { return start_; }
+        ElementIterator Begin() { return ElementIterator{Keys(), Payloads()}; }
 
-        ElementType *RBegin() {
-            if (this->GetCurrentSize() == 0) { return nullptr; }
+        ElementIterator RBegin() {
+            if (this->GetCurrentSize() == 0) { return ElementIterator{}; }
 
             return std::prev(this->End());
         }
 
-        const ElementType *Begin() const { return start_; }
+        ElementIterator End() { return std::next(Begin(), size_); }
+
+        /**
+         * @return the sorted array of keys in this node
+         */
+        KeyType *Keys() { return reinterpret_cast<KeyType *>(storage_); }
+
+        PayloadType *Payloads() { return reinterpret_cast<PayloadType *>(storage_ + PayloadOffset(GetMaxSize())); }
+
+        int GetCurrentSize() const { return size_; }
+
+        /**
+         * The summary of the subtree below a child pointer. The child of the
+         * low key pair is at index 0, and the child of the element at index
+         * `i` is at index `i + 1`. Summaries move along with their elements
+         * when elements are inserted, removed, split or merged. A new element
+         * starts with a zeroed summary.
+         *
+         * @return the `GetSummarySize()` bytes of the summary
+         */
+        unsigned char *Summary(int child) {
+            return storage_ + SummaryOffset(GetMaxSize()) + static_cast<size_t>(child) * summary_size_;
+        }
 
-        ElementType *End() { return end_; }
+        int GetSummarySize() const { return summary_size_; }
 
-        const ElementType *End() const { return end_; }
+        /**
+         * Copies the summary of child `src_child` in `src`, for when a child
+         * pointer is moved into or out of the low key pair.
+         */
+        void CopySummary(int child, ElasticNode *src, int src_child) {
+            CopySummaries(this, child, src, src_child, 1);
+        }
 
-        int GetCurrentSize() const {
-            return std::distance(Begin(), End());
+        /**
+         * Prefetches the cache lines which are read first when this node is
+         * searched: the latch, the no. of elements and the middle key. Does
+         * not read the node itself, so the caller passes in the maximum size.
+         */
+        void PrefetchForSearch(int p_max_size) {
+            BPLUSTREE_PREFETCH(this);
+            BPLUSTREE_PREFETCH(&size_);
+            BPLUSTREE_PREFETCH(Keys() + p_max_size / 2);
         }
 
-        bool InsertElementIfPossible(const ElementType &element, ElementType *location) {
+        bool InsertElementIfPossible(const ElementType &element, ElementIterator location) {
             if (GetCurrentSize() >= GetMaxSize()) { return false; }
 
+            auto index = static_cast<int>(std::distance(Begin(), location));
             if (std::distance(location, End()) > 0) {
-                std::memmove(
-                        reinterpret_cast<void *>(std::next(location)),
-                        reinterpret_cast<void *>(location),
-                        std::distance(location, End()) * sizeof(ElementType)
-                );
+                RelocateElements(std::next(location), location, std::distance(location, End()));
+                CopySummaries(this, index + 2, this, index + 1, GetCurrentSize() - index);
             }
-            new(location) ElementType{element};
-            std::advance(end_, 1);
+            if (summary_size_ > 0) {
+                std::memset(Summary(index + 1), 0, summary_size_);
+            }
+            new(location.Key()) KeyType{element.first};
+            new(location.Payload()) PayloadType{element.second};
+            size_ += 1;
 
             return true;
         }
 
-        bool DeleteElement(ElementType *location) {
+        bool DeleteElement(ElementIterator location) {
             if (std::distance(Begin(), location) < 0) { return false; }
 
             if (GetCurrentSize() == 1) {
+                DestroyElement(Begin());
                 SetEnd(0);
                 return true;
             }
 
-            std::memmove(reinterpret_cast<void *>(location),
-                         reinterpret_cast<void *>(std::next(location)),
-                         (std::distance(location, End()) - 1) * sizeof(ElementType));
+            auto index = static_cast<int>(std::distance(Begin(), location));
+            DestroyElement(location);
+            RelocateElements(location, std::next(location), std::distance(location, End()) - 1);
+            CopySummaries(this, index + 1, this, index + 2, GetCurrentSize() - index - 1);
             SetEnd(GetCurrentSize() - 1);
             return true;
         }
 
+        /**
+         * Removes the elements in `[first, last)`, and moves the elements
+         * after them into place at once.
+         *
+         * @return no. of elements removed
+         */
+        int DeleteElements(ElementIterator first, ElementIterator last) {
+            auto count = static_cast<int>(std::distance(first, last));
+            if (count <= 0) { return 0; }
+
+            for (auto element = first; element != last; ++element) {
+                DestroyElement(element);
+            }
+            auto index = static_cast<int>(std::distance(Begin(), first));
+            RelocateElements(first, last, std::distance(last, End()));
+            CopySummaries(this, index + 1, this, index + count + 1, GetCurrentSize() - index - count);
+            SetEnd(GetCurrentSize() - count);
+            return count;
+        }
+
         bool PopBegin() {
             if (GetCurrentSize() == 0) { return false; }
             if (GetCurrentSize() == 1) {
+                DestroyElement(Begin());
                 SetEnd(0);
                 return true;
             }
 
-            std::memmove(reinterpret_cast<void *>(start_),
-                         reinterpret_cast<void *>(start_ + 1),
-                         (this->GetCurrentSize() - 1) * sizeof(ElementType));
+            DestroyElement(Begin());
+            RelocateElements(Begin(), std::next(Begin()), this->GetCurrentSize() - 1);
+            CopySummaries(this, 1, this, 2, this->GetCurrentSize() - 1);
             SetEnd(this->GetCurrentSize() - 1);
             return true;
         }
@@ -199,10 +406,12 @@ namespace bplustree {
         bool PopEnd() {
             if (GetCurrentSize() == 0) { return false; }
             if (GetCurrentSize() == 1) {
+                DestroyElement(Begin());
                 SetEnd(0);
                 return true;
             }
 
+            DestroyElement(RBegin());
             SetEnd(this->GetCurrentSize() - 1);
             return true;
         }
@@ -216,10 +425,13 @@ namespace bplustree {
                 return false;
             }
 
-            std::memmove(reinterpret_cast<void *>(this->End()),
-                         reinterpret_cast<void *>(next_node->Begin()),
-                         next_node->GetCurrentSize() * sizeof(ElementType));
+            RelocateElements(this->End(), next_node->Begin(), next_node->GetCurrentSize());
+            CopySummaries(this, this->GetCurrentSize() + 1, next_node, 1, next_node->GetCurrentSize());
             SetEnd(this->GetCurrentSize() + next_node->GetCurrentSize());
+
+            // The elements now live in this node. Leave the merged node
+            // empty so that freeing it does not destroy them a second time.
+            next_node->SetEnd(0);
             return true;
         }
 
@@ -235,18 +447,96 @@ namespace bplustree {
 
         void SetLowKeyPair(const KeyNodePointerPair p_low_key) { low_key_ = p_low_key; }
 
-        const ElementType &At(const int index) {
+        ElementReference At(const int index) {
             return *(std::next(Begin(), index));
         }
 
     private:
+        /**
+         * @return offset of the payload array from the start of the key
+         * array, rounded up to the alignment of the payload type
+         */
+        static size_t PayloadOffset(int p_max_size) {
+            auto keys_size = p_max_size * sizeof(KeyType);
+            return (keys_size + alignof(PayloadType) - 1) / alignof(PayloadType) * alignof(PayloadType);
+        }
+
+        /**
+         * @return offset of the summary array from the start of the key
+         * array, after the payload array
+         */
+        static size_t SummaryOffset(int p_max_size) {
+            auto payloads_end = PayloadOffset(p_max_size) + p_max_size * sizeof(PayloadType);
+            return (payloads_end + alignof(uint64_t) - 1) / alignof(uint64_t) * alignof(uint64_t);
+        }
+
+        static size_t AllocationSize(int p_max_size, int p_summary_size) {
+            if (p_summary_size == 0) {
+                return sizeof(ElasticNode) + PayloadOffset(p_max_size) + p_max_size * sizeof(PayloadType);
+            }
+            return sizeof(ElasticNode) + SummaryOffset(p_max_size) + (p_max_size + 1) * p_summary_size;
+        }
+
+        /**
+         * Copies the summaries of `count` children. The two ranges may
+         * overlap when they are in the same node.
+         */
+        static void CopySummaries(ElasticNode *dst, int dst_child, ElasticNode *src, int src_child, int count) {
+            if (dst->summary_size_ == 0 || count <= 0) { return; }
+
+            std::memmove(dst->Summary(dst_child), src->Summary(src_child),
+                         static_cast<size_t>(count) * dst->summary_size_);
+        }
+
+        static void DestroyElement(ElementIterator location) {
+            std::destroy_at(location.Key());
+            std::destroy_at(location.Payload());
+        }
+
+        /**
+         * Moves `count` elements from `src` to `dst`. The two ranges may
+         * overlap. The keys and the payloads are moved separately, and the
+         * elements are left constructed at `dst` only.
+         */
+        static void RelocateElements(ElementIterator dst, ElementIterator src, std::ptrdiff_t count) {
+            RelocateArray(dst.Key(), src.Key(), count);
+            RelocateArray(dst.Payload(), src.Payload(), count);
+        }
+
+        /**
+         * Trivially copyable types like integer keys, values and node
+         * pointers are moved with a single `memmove`. Other types are
+         * move-constructed one at a time in the direction which does not
+         * overwrite objects which have not been moved yet.
+         */
+        template<typename T>
+        static void RelocateArray(T *dst, T *src, std::ptrdiff_t count) {
+            if (count <= 0 || dst == src) { return; }
+
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                std::memmove(reinterpret_cast<void *>(dst),
+                             reinterpret_cast<void *>(src),
+                             count * sizeof(T));
+            } else if (dst < src) {
+                for (std::ptrdiff_t i = 0; i < count; ++i) {
+                    new(dst + i) T{std::move(src[i])};
+                    src[i].~T();
+                }
+            } else {
+                for (std::ptrdiff_t i = count - 1; i >= 0; --i) {
+                    new(dst + i) T{std::move(src[i])};
+                    src[i].~T();
+                }
+            }
+        }
+
         // 1. An inner node stores N keys, and (N+1) node pointers. This is
         // the extra node pointer in the inner node. It points to the node
         // with keys less than the smallest key in the inner node. This is
         // always set to `nullptr` in leaf nodes, and has no meaning.
         //
-        // 2. The addition of this node pointer separate from the `start_`
-        // internal array simplifies code which deals with searching, splitting
+        // 2. The addition of this node pointer separate from the element
+        // arrays simplifies code which deals with searching, splitting
         // and merging of inner nodes. This is because the to store the extra
         // node pointer, we leave the first key as invalid. The actual first
         // key therefore begins at index 1 and any code which dealt with inner
@@ -254,7 +544,7 @@ namespace bplustree {
         // necessary anymore with the addition of this field.
         //
         // 3. This is added here instead of in the derived `InnerNode` class
-        // because it will clash with the `start_` array which is invisible
+        // because it will clash with the `storage_` array which is invisible
         // to the compiler.
         KeyNodePointerPair low_key_;
 
@@ -262,20 +552,33 @@ namespace bplustree {
         BaseNode *sibling_left_{nullptr};
         BaseNode *sibling_right_{nullptr};
 
-        // Points to location one past the last element in `start_`
-        ElementType *end_;
+        // Allocator which provided the storage for this node
+        NodeAllocator *allocator_;
+
+        // No. of elements in this node
+        int size_;
+
+        // No. of bytes of the summary of each child pointer, or zero
+        int summary_size_;
 
         /*
          * Struct hack (flexible array member)
          * https://developers.redhat.com/articles/2022/09/29/benefits-limitations-flexible-array-members
          *
-         * The array for holding the key-value elements
+         * Holds the key array followed by the payload array. See
+         * `PayloadOffset` for where the payload array begins. When the node
+         * has summaries, the summary array of `max size + 1` children
+         * follows at `SummaryOffset`.
          */
-        ElementType start_[0];
+        alignas(KeyType) alignas(PayloadType) unsigned char storage_[0];
     };
 
-    class InnerNode : public ElasticNode<KeyNodePointerPair> {
+    template<typename KeyType, typename KeyComparator = std::less<KeyType>>
+    class InnerNode : public ElasticNode<KeyType, std::pair<KeyType, BaseNode *>> {
     public:
+        using KeyNodePointerPair = std::pair<KeyType, BaseNode *>;
+        using ElementIterator = typename ElasticNode<KeyType, KeyNodePointerPair>::ElementIterator;
+
         /**
          * Use the `ElasticNode` interface for constructing an `InnerNode`
          */
@@ -291,16 +594,17 @@ namespace bplustree {
 
         ~InnerNode() = default;
 
-        KeyNodePointerPair *FindLocation(const int key) {
-            BaseNode *dummy_ptr = nullptr;
-            KeyNodePointerPair dummy_element = std::make_pair(key, dummy_ptr);
+        ElementIterator FindLocation(const KeyType &key) {
+            KeyType *keys = this->Keys();
+            int size = this->GetCurrentSize();
 
-            KeyNodePointerPair *iter = std::lower_bound(
-                    this->Begin(), this->End(), dummy_element,
-                    [](const auto &a, const auto &b) { return a < b; }
-            );
+            if constexpr (key_search::IsVectorizable<KeyType, KeyComparator>()) {
+                auto index = key_search::LowerBound(keys, size, sizeof(KeyType), key);
+                return std::next(this->Begin(), index);
+            }
 
-            return iter;
+            KeyType *iter = std::lower_bound(keys, keys + size, key, KeyComparator{});
+            return std::next(this->Begin(), std::distance(keys, iter));
         }
 
         /**
@@ -337,15 +641,17 @@ namespace bplustree {
          * @return The location of the pivot element in the inner node
          * which points to the child node
          */
-        KeyNodePointerPair *FindPivot(int search_key) {
+        ElementIterator FindPivot(const KeyType &search_key) {
             auto iter = FindLocation(search_key);
 
-            if (iter != End() && search_key == iter->first) {
+            // `iter` is a lower bound, so the keys are equal when the search
+            // key does not compare less than the key found.
+            if (iter != this->End() && !KeyComparator{}(search_key, iter->first)) {
                 return iter;
             }
 
-            if (iter == Begin() && search_key < iter->first) {
-                return &GetLowKeyPair();
+            if (iter == this->Begin() && KeyComparator{}(search_key, iter->first)) {
+                return ElementIterator{&this->GetLowKeyPair().first, &this->GetLowKeyPair().second};
             }
 
             return std::prev(iter);
@@ -359,31 +665,31 @@ namespace bplustree {
          * key. When the search key already points to the left most node
          * pointer, there is no previous and it returns a null optional.
          */
-        std::optional<std::pair<BaseNode *, KeyNodePointerPair *>> MaybePreviousWithSeparator(int search_key) {
+        std::optional<std::pair<BaseNode *, ElementIterator>> MaybePreviousWithSeparator(const KeyType &search_key) {
             auto pivot = FindPivot(search_key);
 
             // Left most child pointer, has no previous sibling
-            if (pivot->second == GetLowKeyPair().second) {
+            if (pivot->second == this->GetLowKeyPair().second) {
                 return {};
             }
 
-            if (pivot == Begin()) {
-                return std::make_pair(GetLowKeyPair().second, pivot);
+            if (pivot == this->Begin()) {
+                return std::make_pair(this->GetLowKeyPair().second, pivot);
             }
 
             return std::make_pair(std::prev(pivot)->second, pivot);
         }
 
-        std::optional<std::pair<BaseNode *, KeyNodePointerPair *>> MaybeNextWithSeparator(int search_key) {
+        std::optional<std::pair<BaseNode *, ElementIterator>> MaybeNextWithSeparator(const KeyType &search_key) {
             auto pivot = FindPivot(search_key);
 
             // Right most element, has no next element
-            if (std::next(pivot) == End()) {
+            if (std::next(pivot) == this->End()) {
                 return {};
             }
 
-            if (pivot->second == GetLowKeyPair().second) {
-                return std::make_pair(Begin()->second, Begin());
+            if (pivot->second == this->GetLowKeyPair().second) {
+                return std::make_pair(this->Begin()->second, this->Begin());
             }
 
             return std::make_pair(std::next(pivot)->second, std::next(pivot));
@@ -391,10 +697,12 @@ namespace bplustree {
         }
     };
 
-    class BPlusTree;
-
-    class LeafNode : public ElasticNode<KeyValuePair> {
+    template<typename KeyType, typename ValueType, typename KeyComparator = std::less<KeyType>>
+    class LeafNode : public ElasticNode<KeyType, std::pair<KeyType, ValueType>> {
     public:
+        using KeyValuePair = std::pair<KeyType, ValueType>;
+        using ElementIterator = typename ElasticNode<KeyType, KeyValuePair>::ElementIterator;
+
         /**
          * Use the `ElasticNode` interface for constructing an `LeafNode`
          */
@@ -410,13 +718,17 @@ namespace bplustree {
 
         ~LeafNode() = default;
 
-        KeyValuePair *FindLocation(const int key) {
-            KeyValuePair dummy = std::make_pair(key, 0);
-            KeyValuePair *iter = std::lower_bound(this->Begin(), this->End(), dummy,
-                                                  [](const auto &a, const auto &b) {
-                                                      return a < b;
-                                                  });
-            return iter;
+        ElementIterator FindLocation(const KeyType &key) {
+            KeyType *keys = this->Keys();
+            int size = this->GetCurrentSize();
+
+            if constexpr (key_search::IsVectorizable<KeyType, KeyComparator>()) {
+                auto index = key_search::LowerBound(keys, size, sizeof(KeyType), key);
+                return std::next(this->Begin(), index);
+            }
+
+            KeyType *iter = std::lower_bound(keys, keys + size, key, KeyComparator{});
+            return std::next(this->Begin(), std::distance(keys, iter));
         }
 
         /**
@@ -454,16 +766,167 @@ namespace bplustree {
         }
     };
 
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    class BPlusTree;
+
+    struct IteratorStats {
+        // No. of times an iterator moving right or left let go of its leaf
+        // node and descended from the root again, because the sibling leaf
+        // node was latched by a writer
+        uint64_t forward_reseeks_{0};
+        uint64_t backward_reseeks_{0};
+    };
+
+    /**
+     * The acquisitions of the latches of a B+Tree, added up by where the
+     * latches are. Only counted when built with ENABLE_LATCH_STATS.
+     */
+    struct LatchStats {
+        // The latch which guards the pointer to the root node
+        LatchCounts root_;
+        // The latches of the nodes by their depth when the snapshot was
+        // taken, where the root node is at depth 0 and the leaf nodes last
+        std::vector<LatchCounts> levels_;
+        // The latches of the nodes which were merged away or deleted
+        LatchCounts removed_nodes_;
+    };
+
+    /**
+     * What the inner nodes of a B+Tree keep about the subtree below each of
+     * their child pointers, chosen when the B+Tree is constructed.
+     */
+    enum class Augmentation {
+        None,
+        // No. of elements in the subtree, for `Count`, `Rank` and `Select`
+        OrderStatistics,
+        // No. of elements in the subtree, and the sum, minimum and maximum
+        // of their values, for `Aggregate` as well. Needs arithmetic values
+        Aggregates
+    };
+
+    /**
+     * The values of the elements inside a range of keys, folded together by
+     * `BPlusTree::Aggregate`. `min_` and `max_` are only meaningful when
+     * `count_` is not zero.
+     */
+    template<typename ValueType>
+    struct RangeAggregate {
+        // Wide enough that adding up the values of a large range does not
+        // overflow as quickly as the values themselves
+        using SumType = std::conditional_t<std::is_floating_point_v<ValueType>, double,
+                std::conditional_t<std::is_signed_v<ValueType>, int64_t, uint64_t>>;
+
+        // Kept first, as the inner nodes read it as the no. of elements of
+        // the subtree with `Augmentation::Aggregates`
+        uint64_t count_{0};
+        SumType sum_{0};
+        ValueType min_{};
+        ValueType max_{};
+
+        void Add(const ValueType &value) {
+            min_ = count_ == 0 || value < min_ ? value : min_;
+            max_ = count_ == 0 || max_ < value ? value : max_;
+            sum_ += static_cast<SumType>(value);
+            count_ += 1;
+        }
+
+        void Add(const RangeAggregate &other) {
+            if (other.count_ == 0) { return; }
+
+            min_ = count_ == 0 || other.min_ < min_ ? other.min_ : min_;
+            max_ = count_ == 0 || max_ < other.max_ ? other.max_ : max_;
+            sum_ += other.sum_;
+            count_ += other.count_;
+        }
+    };
+
+    /**
+     * The summary stored for a child pointer with `Augmentation::Aggregates`.
+     * Writers which share the latch on an inner node update the summaries
+     * of its child pointers concurrently, so every field is updated
+     * atomically on its own. A child pointer always has elements below it,
+     * so `min_` and `max_` are always meaningful.
+     */
+    template<typename ValueType>
+    struct AtomicRangeAggregate {
+        using SumType = typename RangeAggregate<ValueType>::SumType;
+
+        // Kept first, as the inner nodes read it as the no. of elements of
+        // the subtree
+        std::atomic<uint64_t> count_{0};
+        std::atomic<SumType> sum_{0};
+        std::atomic<ValueType> min_{};
+        std::atomic<ValueType> max_{};
+
+        RangeAggregate<ValueType> Load() const {
+            RangeAggregate<ValueType> aggregate;
+            aggregate.count_ = count_.load(std::memory_order_relaxed);
+            aggregate.sum_ = sum_.load(std::memory_order_relaxed);
+            aggregate.min_ = min_.load(std::memory_order_relaxed);
+            aggregate.max_ = max_.load(std::memory_order_relaxed);
+            return aggregate;
+        }
+
+        void Store(const RangeAggregate<ValueType> &aggregate) {
+            count_.store(aggregate.count_, std::memory_order_relaxed);
+            sum_.store(aggregate.sum_, std::memory_order_relaxed);
+            min_.store(aggregate.min_, std::memory_order_relaxed);
+            max_.store(aggregate.max_, std::memory_order_relaxed);
+        }
+
+        void Add(const ValueType &value) {
+            count_.fetch_add(1, std::memory_order_relaxed);
+            AddToSum(static_cast<SumType>(value));
+
+            auto min = min_.load(std::memory_order_relaxed);
+            while (value < min && !min_.compare_exchange_weak(min, value, std::memory_order_relaxed)) {}
+            auto max = max_.load(std::memory_order_relaxed);
+            while (max < value && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+        }
+
+        /**
+         * @return true if removing `value` changes neither the minimum nor
+         * the maximum. Concurrent writers can only lower the minimum or
+         * raise the maximum in place, so the answer stays true.
+         */
+        bool IsInside(const ValueType &value) const {
+            return min_.load(std::memory_order_relaxed) < value && value < max_.load(std::memory_order_relaxed);
+        }
+
+        // Only for a value which `IsInside`
+        void Remove(const ValueType &value) {
+            count_.fetch_sub(1, std::memory_order_relaxed);
+            AddToSum(SumType{0} - static_cast<SumType>(value));
+        }
+
+    private:
+        void AddToSum(SumType delta) {
+            if constexpr (std::is_integral_v<SumType>) {
+                sum_.fetch_add(delta, std::memory_order_relaxed);
+            } else {
+                auto sum = sum_.load(std::memory_order_relaxed);
+                while (!sum_.compare_exchange_weak(sum, sum + delta, std::memory_order_relaxed)) {}
+            }
+        }
+    };
+
+    template<typename KeyType, typename ValueType, typename KeyComparator = std::less<KeyType>>
     class BPlusTreeIterator {
     public:
-        BPlusTreeIterator(ElasticNode<KeyValuePair> *node, KeyValuePair *element) :
+        using KeyValuePair = std::pair<KeyType, ValueType>;
+        using ElementIterator = typename ElasticNode<KeyType, KeyValuePair>::ElementIterator;
+        using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+
+        BPlusTreeIterator(Tree *tree, ElasticNode<KeyType, KeyValuePair> *node, ElementIterator element) :
+                tree_{tree},
                 current_node_{node},
                 current_element_{element},
                 state_{IteratorState::VALID} {}
 
         BPlusTreeIterator() :
+                tree_{nullptr},
                 current_node_{nullptr},
-                current_element_{nullptr},
+                current_element_{},
                 state_{IteratorState::INVALID} {}
 
         ~BPlusTreeIterator() {
@@ -471,7 +934,7 @@ namespace bplustree {
                 current_node_->ReleaseNodeSharedLatch();
             }
             current_node_ = nullptr;
-            current_element_ = nullptr;
+            current_element_ = ElementIterator{};
             state_ = INVALID;
         }
 
@@ -480,30 +943,38 @@ namespace bplustree {
         BPlusTreeIterator &operator=(const BPlusTreeIterator &) = delete;
 
         BPlusTreeIterator(BPlusTreeIterator &&other) noexcept {
+            tree_ = other.tree_;
             current_node_ = other.current_node_;
             current_element_ = other.current_element_;
             state_ = other.state_;
+            reseeks_ = other.reseeks_;
 
             other.current_node_ = nullptr;
-            other.current_element_ = nullptr;
-            state_ = IteratorState::INVALID;
+            other.current_element_ = ElementIterator{};
+            other.state_ = IteratorState::INVALID;
         }
 
         BPlusTreeIterator &operator=(BPlusTreeIterator &&other) noexcept {
             if (this != &other) {
+                if (state_ == VALID && current_node_ != nullptr) {
+                    current_node_->ReleaseNodeSharedLatch();
+                }
+
+                tree_ = other.tree_;
                 current_node_ = other.current_node_;
                 current_element_ = other.current_element_;
                 state_ = other.state_;
+                reseeks_ = other.reseeks_;
 
                 other.current_node_ = nullptr;
-                other.current_element_ = nullptr;
-                state_ = IteratorState::INVALID;
+                other.current_element_ = ElementIterator{};
+                other.state_ = IteratorState::INVALID;
             }
 
             return *this;
         }
 
-        auto operator*() -> KeyValuePair & {
+        auto operator*() -> typename ElementIterator::reference {
             return *current_element_;
         }
 
@@ -522,11 +993,11 @@ namespace bplustree {
             }
 
             auto previous_node = current_node_;
-            current_node_ = static_cast<ElasticNode<KeyValuePair> *>(current_node_->GetSiblingRight());
+            current_node_ = static_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node_->GetSiblingRight());
 
             if (!(current_node_->TrySharedLock())) {
-                previous_node->ReleaseNodeSharedLatch();
-                SetRetryIterator();
+                current_node_ = previous_node;
+                Reseek(true);
                 return;
             }
             previous_node->ReleaseNodeSharedLatch();
@@ -549,11 +1020,11 @@ namespace bplustree {
             }
 
             auto previous_node = current_node_;
-            current_node_ = static_cast<ElasticNode<KeyValuePair> *>(current_node_->GetSiblingLeft());
+            current_node_ = static_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node_->GetSiblingLeft());
 
             if (!(current_node_->TrySharedLock())) {
-                previous_node->ReleaseNodeSharedLatch();
-                SetRetryIterator();
+                current_node_ = previous_node;
+                Reseek(false);
                 return;
             }
             previous_node->ReleaseNodeSharedLatch();
@@ -561,6 +1032,49 @@ namespace bplustree {
             current_element_ = std::prev(current_node_->End());
         }
 
+        /**
+         * Copies the elements starting at the current one into `out`, and
+         * moves past them. The elements of a leaf node are copied together
+         * under a single hold of its latch, and the right sibling is
+         * prefetched while copying the last run of a leaf node.
+         *
+         * Moving to the next leaf node works like `operator++`, including
+         * descending from the root again when a writer holds the sibling.
+         *
+         * @param out array of at least `n` elements
+         * @return no. of elements copied. Less than `n` only when the
+         * iterator reached `End()`.
+         */
+        size_t NextBatch(KeyValuePair *out, size_t n) {
+            size_t copied = 0;
+            while (copied < n && state_ == VALID) {
+                auto remaining = static_cast<size_t>(current_node_->End() - current_element_);
+                auto count = std::min(n - copied, remaining);
+
+                if (count == remaining) {
+                    PrefetchSiblingRight();
+                }
+
+                auto keys = current_element_.Key();
+                auto payloads = current_element_.Payload();
+                for (size_t i = 0; i < count; ++i) {
+                    out[copied + i].first = keys[i];
+                    out[copied + i].second = payloads[i];
+                }
+                copied += count;
+
+                if (count < remaining) {
+                    current_element_ += count;
+                    break;
+                }
+
+                // Moves to the first element of the right sibling
+                current_element_ += count - 1;
+                ++(*this);
+            }
+            return copied;
+        }
+
         bool operator==(const BPlusTreeIterator &other) const {
             return (current_element_ == other.current_element_
                     && current_node_ == other.current_node_
@@ -573,6 +1087,12 @@ namespace bplustree {
                      && state_ == other.state_);
         }
 
+        /**
+         * @return no. of times this iterator descended from the root again
+         * to move to a sibling leaf node
+         */
+        uint64_t GetReseekCount() const { return reseeks_; }
+
         static BPlusTreeIterator GetEndIterator() {
             auto iter = BPlusTreeIterator();
             iter.SetEndIterator();
@@ -596,17 +1116,61 @@ namespace bplustree {
             VALID, INVALID, END, REND, RETRY
         };
 
+        // The B+Tree to descend again when moving to a sibling fails
+        Tree *tree_;
+
         // Iterator is currently at this leaf node
-        ElasticNode<KeyValuePair> *current_node_;
+        ElasticNode<KeyType, KeyValuePair> *current_node_;
 
-        // Pointer to element in current leaf node
-        KeyValuePair *current_element_;
+        // Element in current leaf node
+        ElementIterator current_element_;
 
         IteratorState state_;
 
+        uint64_t reseeks_{0};
+
+        /**
+         * Moves to the element after (or before) the current one, when the
+         * sibling leaf node is latched by a writer.
+         *
+         * Waiting for the sibling latch while holding the current latch
+         * could deadlock, because the writer may be waiting for the current
+         * leaf node. Instead, the last key is remembered, the latch is
+         * released, and the next element is found by a top-down descent
+         * which holds no other latch, like every other operation.
+         */
+        void Reseek(bool forward) {
+            KeyType last_key = (*current_element_).first;
+            current_node_->ReleaseNodeSharedLatch();
+            ResetIterator();
+            state_ = INVALID;
+
+            // The seek returns the end iterator, which has no tree, when no
+            // key is left past the last one
+            auto tree = tree_;
+            auto reseeks = reseeks_ + 1;
+            *this = forward ? tree->SeekForward(last_key, false) : tree->SeekBackward(last_key, false);
+            reseeks_ = reseeks;
+            tree->CountReseek(forward);
+        }
+
+        void PrefetchSiblingRight() {
+            auto sibling = static_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node_->GetSiblingRight());
+            if (sibling == nullptr) { return; }
+
+            // Every leaf node has the same layout, so the offset of the
+            // payloads is taken from the current node without reading the
+            // sibling
+            auto payload_offset = reinterpret_cast<char *>(current_node_->Payloads()) -
+                                  reinterpret_cast<char *>(current_node_);
+            BPLUSTREE_PREFETCH(sibling);
+            BPLUSTREE_PREFETCH(sibling->Keys());
+            BPLUSTREE_PREFETCH(reinterpret_cast<char *>(sibling) + payload_offset);
+        }
+
         void ResetIterator() {
             current_node_ = nullptr;
-            current_element_ = nullptr;
+            current_element_ = ElementIterator{};
         }
 
         void SetEndIterator() {
@@ -625,18 +1189,133 @@ namespace bplustree {
         }
     };
 
+    /**
+     * A concurrent B+Tree index mapping unique keys to values.
+     *
+     * @tparam KeyType type of the keys stored in the index
+     * @tparam ValueType type of the values stored in the index
+     * @tparam KeyComparator a stateless, default constructible comparator
+     * which defines a strict weak ordering of the keys
+     */
+    template<typename KeyType, typename ValueType, typename KeyComparator = std::less<KeyType>>
     class BPlusTree {
     public:
-        explicit BPlusTree(int p_inner_node_max_size, int p_leaf_node_max_size) :
+        using KeyNodePointerPair = std::pair<KeyType, BaseNode *>;
+        using KeyValuePair = std::pair<KeyType, ValueType>;
+        using InnerNodeType = InnerNode<KeyType, KeyComparator>;
+        using LeafNodeType = LeafNode<KeyType, ValueType, KeyComparator>;
+        using BPlusTreeIterator = bplustree::BPlusTreeIterator<KeyType, ValueType, KeyComparator>;
+        using RangeAggregateType = RangeAggregate<ValueType>;
+
+        friend BPlusTreeIterator;
+
+        /**
+         * @param p_allocator provides the storage for the nodes. Defaults to
+         * a slab allocator owned by this B+Tree.
+         */
+        explicit BPlusTree(int p_inner_node_max_size, int p_leaf_node_max_size,
+                           std::unique_ptr<NodeAllocator> p_allocator = std::make_unique<SlabNodeAllocator>()) :
                 root_{nullptr},
                 inner_node_max_size_{p_inner_node_max_size},
-                leaf_node_max_size_{p_leaf_node_max_size} {}
+                leaf_node_max_size_{p_leaf_node_max_size},
+                allocator_{std::move(p_allocator)} {}
+
+        /**
+         * @param p_augmentation the summary kept for every child pointer in
+         * the inner nodes
+         */
+        BPlusTree(int p_inner_node_max_size, int p_leaf_node_max_size, Augmentation p_augmentation,
+                  std::unique_ptr<NodeAllocator> p_allocator = std::make_unique<SlabNodeAllocator>()) :
+                BPlusTree(p_inner_node_max_size, p_leaf_node_max_size, std::move(p_allocator)) {
+            BPLUSTREE_ASSERT(p_augmentation != Augmentation::Aggregates || std::is_arithmetic_v<ValueType>,
+                             "aggregates need arithmetic values");
+
+            augmentation_ = p_augmentation;
+            if (p_augmentation == Augmentation::OrderStatistics) {
+                summary_size_ = sizeof(std::atomic<uint64_t>);
+            } else if (p_augmentation == Augmentation::Aggregates) {
+                if constexpr (std::is_arithmetic_v<ValueType>) {
+                    summary_size_ = sizeof(AtomicRangeAggregate<ValueType>);
+                }
+            }
+        }
 
         ~BPlusTree() { FreeTree(); }
 
         // Used only for testing
         BaseNode *GetRoot() { return root_; }
 
+        /**
+         * Registers the calling thread for memory reclamation. Threads are
+         * registered implicitly on their first operation, so calling this is
+         * optional.
+         */
+        void RegisterThread() { epoch_manager_.RegisterThread(); }
+
+        /**
+         * Unregisters the calling thread. Threads are unregistered implicitly
+         * when they exit.
+         */
+        void UnregisterThread() { epoch_manager_.UnregisterThread(); }
+
+        NodeAllocatorStats GetAllocatorStats() const { return allocator_->GetStats(); }
+
+        IteratorStats GetIteratorStats() const {
+            auto stats = operation_counters_.GetStats();
+            return IteratorStats{stats.forward_reseeks_, stats.backward_reseeks_};
+        }
+
+        /**
+         * Adds up the paths taken by the operations of every thread so far.
+         * Reading them does not latch the B+Tree.
+         */
+        OperationStats GetOperationStats() const { return operation_counters_.GetStats(); }
+
+        /**
+         * Adds up the acquisitions of every latch in the B+Tree, level by
+         * level. Each node is latched in shared mode while its child
+         * pointers are read, after its own counts are read. Nodes which are
+         * removed meanwhile stay readable until the snapshot is done, but
+         * under concurrent writes a node may be counted twice, or missed.
+         *
+         * @return all zeros, unless built with ENABLE_LATCH_STATS
+         */
+        LatchStats GetLatchStats() {
+            LatchStats stats;
+            if constexpr (!kLatchStats) { return stats; }
+
+            stats.root_ = root_latch_.GetCounts();
+            {
+                std::lock_guard<std::mutex> guard{removed_latch_counts_mutex_};
+                stats.removed_nodes_ = removed_latch_counts_;
+            }
+
+            EpochManager::Guard epoch_guard{epoch_manager_};
+            root_latch_.LockShared();
+            std::vector<BaseNode *> level;
+            if (root_ != nullptr) { level.push_back(root_); }
+            root_latch_.UnlockShared();
+
+            while (!level.empty()) {
+                LatchCounts counts;
+                std::vector<BaseNode *> next_level;
+                for (auto node: level) {
+                    counts.Add(node->GetLatchCounts());
+                    if (node->GetType() == NodeType::LeafType) { continue; }
+
+                    auto inner = static_cast<InnerNodeType *>(node);
+                    inner->GetNodeSharedLatch();
+                    for (int child = 0; child <= inner->GetCurrentSize(); ++child) {
+                        next_level.push_back(ChildAt(inner, child));
+                    }
+                    inner->ReleaseNodeSharedLatch();
+                }
+                stats.levels_.push_back(counts);
+                level = std::move(next_level);
+            }
+            return stats;
+        }
+
         BPlusTreeIterator End() {
             return BPlusTreeIterator::GetEndIterator();
         }
@@ -645,6 +1324,11 @@ namespace bplustree {
             return BPlusTreeIterator::GetREndIterator();
         }
 
+        /**
+         * Iterators no longer end up in the retry state, as they descend
+         * from the root again instead. Kept for existing callers which
+         * compare against it.
+         */
         BPlusTreeIterator Retry() {
             return BPlusTreeIterator::GetRetryIterator();
         }
@@ -663,8 +1347,8 @@ namespace bplustree {
                 return End();
             }
 
-            auto node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
-            return BPlusTreeIterator(node, node->Begin());
+            auto node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
+            return BPlusTreeIterator(this, node, node->Begin());
         }
 
         /**
@@ -681,93 +1365,405 @@ namespace bplustree {
                 return REnd();
             }
 
-            auto node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
-            return BPlusTreeIterator(node, node->RBegin());
+            auto node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
+            return BPlusTreeIterator(this, node, node->RBegin());
         }
 
-        BaseNode *FindLeafNode() {
-            root_latch_.LockShared();
-            if (root_ == nullptr) {
-                root_latch_.UnlockShared();
-                return nullptr;
-            }
+        /**
+         * Returns an iterator to the first element with a key not less than
+         * `key`, or `End()` if there is no such element.
+         *
+         * The leaf node is found by descending from the root with the key,
+         * like a lookup. The returned iterator holds a shared latch on the
+         * leaf node it points to, and has the same lifetime rules as the
+         * iterator returned by `Begin`.
+         */
+        BPlusTreeIterator LowerBound(const KeyType &key) { return SeekForward(key, true); }
 
-            BaseNode *current = root_;
-            BaseNode *parent = nullptr;
+        /**
+         * Returns an iterator to the first element with a key greater than
+         * `key`, or `End()` if there is no such element.
+         */
+        BPlusTreeIterator UpperBound(const KeyType &key) { return SeekForward(key, false); }
 
-            current->GetNodeSharedLatch();
-            root_latch_.UnlockShared();
+        /**
+         * Returns an iterator to the element with the smallest key not less
+         * than `key`, or `End()` if there is no such element. Same as
+         * `LowerBound`.
+         */
+        BPlusTreeIterator Ceiling(const KeyType &key) { return SeekForward(key, true); }
 
-            while (current->GetType() != NodeType::LeafType) {
-                parent = current;
-                current = static_cast<InnerNode *>(current)->GetLowKeyPair().second;
+        /**
+         * Returns an iterator to the element with the largest key not
+         * greater than `key`, or `REnd()` if there is no such element.
+         */
+        BPlusTreeIterator Floor(const KeyType &key) { return SeekBackward(key, true); }
 
-                current->GetNodeSharedLatch();
-                parent->ReleaseNodeSharedLatch();
+        BaseNode *FindLeafNode() {
+            return FindLeafNodeShared([](InnerNodeType *node) { return node->GetLowKeyPair().second; });
+        }
+
+        BaseNode *FindLastLeafNode() {
+            return FindLeafNodeShared([](InnerNodeType *node) {
+                if (node->GetCurrentSize() == 0) {
+                    return node->GetLowKeyPair().second;
+                }
+                return std::prev(node->End())->second;
+            });
+        }
+
+        /**
+         * Visits the elements with keys in `[lo, hi]` in increasing order of
+         * the keys.
+         *
+         * Unlike an iterator, a scan does not hold any latch while the
+         * visitor runs. The matching elements of one or more consecutive
+         * leaf nodes are copied into a buffer under their shared latches.
+         * The latches are released, and only then is the visitor called for
+         * the copied elements. The visitor is free to start other operations
+         * on the B+Tree, including another scan.
+         *
+         * Once a batch is visited, or when the shared latch on the right
+         * sibling is not immediately available, the scan descends again from
+         * the root and resumes after the last key it copied. A concurrent
+         * write delays the scan instead of ending it. Every key is visited at
+         * most once. Elements inserted or deleted while the scan is running
+         * may or may not be visited.
+         *
+         * @param visitor called as `visitor(key, value)`. When it returns a
+         * `bool`, returning false stops the scan.
+         * @return no. of elements visited
+         */
+        template<typename Visitor>
+        size_t Scan(const KeyType &lo, const KeyType &hi, Visitor &&visitor) {
+            return ScanPart(lo, hi, true, visitor);
+        }
+
+        /**
+         * Visits the elements with keys in `[lo, hi]` using several threads.
+         *
+         * The range is split into parts at separator keys of the top inner
+         * levels, so that the parts span a similar no. of leaf nodes. Each
+         * part is scanned by its own thread, like `Scan`. The parts are
+         * numbered in increasing order of their keys, which lets a visitor
+         * keep a separate result for every part and combine them in order.
+         *
+         * @param num_threads maximum no. of parts, and threads
+         * @param visitor called as `visitor(part, key, value)` from the
+         * thread scanning the part, with `part < num_threads`. Calls for
+         * different parts run concurrently. When it returns a `bool`,
+         * returning false stops the scan of that part.
+         * @return no. of elements visited
+         */
+        template<typename Visitor>
+        size_t ParallelScan(const KeyType &lo, const KeyType &hi, int num_threads, Visitor &&visitor) {
+            BPLUSTREE_ASSERT(num_threads >= 1, "At least one thread scans the range");
+            if (KeyCmpLess(hi, lo)) { return 0; }
+
+            auto separators = PartitionRange(lo, hi, num_threads);
+            auto part_count = separators.size() + 1;
+
+            std::vector<size_t> visited(part_count);
+            RunSlices(part_count, [&](size_t part) {
+                const KeyType &part_lo = (part == 0) ? lo : separators[part - 1];
+                const KeyType &part_hi = (part == part_count - 1) ? hi : separators[part];
+                visited[part] = ScanPart(part_lo, part_hi, part == part_count - 1,
+                                         [&visitor, part](const KeyType &key, const ValueType &value) {
+                                             return visitor(part, key, value);
+                                         });
+            });
+            return std::accumulate(visited.begin(), visited.end(), size_t{0});
+        }
+
+        /**
+         * Appends the keys and the values of the elements with keys in
+         * `[lo, hi]` to `keys` and `values`, in increasing order of the
+         * keys.
+         *
+         * A leaf node stores its keys and its values in separate arrays, so
+         * the run of elements in the range is appended to both vectors with
+         * a bulk copy per leaf node. With more than one thread, the range is
+         * split at separator keys of the inner nodes, and each thread
+         * exports one part. Like `Scan`, an export is not a snapshot, and
+         * resumes after the last key it copied when a writer holds the next
+         * leaf node.
+         *
+         * @param num_threads no. of threads exporting parts of the range
+         * @return no. of elements appended
+         */
+        size_t ExportRange(const KeyType &lo, const KeyType &hi, std::vector<KeyType> &keys,
+                           std::vector<ValueType> &values, int num_threads = 1) {
+            BPLUSTREE_ASSERT(num_threads >= 1, "At least one thread exports the range");
+            if (KeyCmpLess(hi, lo)) { return 0; }
+
+            auto initial_size = keys.size();
+            auto separators = PartitionRange(lo, hi, num_threads);
+            if (separators.empty()) {
+                ExportPart(lo, hi, true, keys, values);
+                return keys.size() - initial_size;
             }
 
-            return current;
+            // The first part is exported directly into the output
+            auto part_count = separators.size() + 1;
+            std::vector<std::vector<KeyType>> part_keys(part_count);
+            std::vector<std::vector<ValueType>> part_values(part_count);
+            RunSlices(part_count, [&](size_t part) {
+                const KeyType &part_lo = (part == 0) ? lo : separators[part - 1];
+                const KeyType &part_hi = (part == part_count - 1) ? hi : separators[part];
+                auto &out_keys = (part == 0) ? keys : part_keys[part];
+                auto &out_values = (part == 0) ? values : part_values[part];
+                ExportPart(part_lo, part_hi, part == part_count - 1, out_keys, out_values);
+            });
+
+            for (size_t part = 1; part < part_count; ++part) {
+                keys.insert(keys.end(), std::make_move_iterator(part_keys[part].begin()),
+                            std::make_move_iterator(part_keys[part].end()));
+                values.insert(values.end(), std::make_move_iterator(part_values[part].begin()),
+                              std::make_move_iterator(part_values[part].end()));
+            }
+            return keys.size() - initial_size;
         }
 
-        BaseNode *FindLastLeafNode() {
-            root_latch_.LockShared();
-            if (root_ == nullptr) {
-                root_latch_.UnlockShared();
-                return nullptr;
+        /**
+         * @return no. of elements with keys in `[lo, hi)`
+         *
+         * With either augmentation the count is the difference
+         * of two ranks, and the elements are not visited. Otherwise the
+         * range is scanned. Under concurrent writes each rank includes the
+         * writes which finished before it was taken.
+         */
+        size_t Count(const KeyType &lo, const KeyType &hi) {
+            if (!KeyCmpLess(lo, hi)) { return 0; }
+
+            if (summary_size_ == 0) {
+                return ScanPart(lo, hi, false, [](const KeyType &, const ValueType &) {});
             }
 
-            BaseNode *current = root_;
-            BaseNode *parent = nullptr;
+            auto below_lo = CountLess(lo, false);
+            auto below_hi = CountLess(hi, false);
+            return below_hi > below_lo ? below_hi - below_lo : 0;
+        }
 
-            current->GetNodeSharedLatch();
-            root_latch_.UnlockShared();
+        /**
+         * @return no. of elements with keys less than `key`
+         */
+        size_t Rank(const KeyType &key) {
+            if (summary_size_ == 0) {
+                size_t rank = 0;
+                for (auto iter = Begin(); iter != End() && KeyCmpLess((*iter).first, key); ++iter) {
+                    ++rank;
+                }
+                return rank;
+            }
 
-            while (current->GetType() != NodeType::LeafType) {
-                parent = current;
-                current = std::prev(static_cast<InnerNode *>(current)->End())->second;
+            return CountLess(key, false);
+        }
 
-                current->GetNodeSharedLatch();
-                parent->ReleaseNodeSharedLatch();
+        /**
+         * Finds the element with the `k`-th smallest key, counting from 0.
+         *
+         * With either augmentation the descent skips the child
+         * pointers whose subtrees hold fewer elements than are left to
+         * count, and the leaf node is found without visiting the elements
+         * before it. Otherwise the elements are visited from the smallest.
+         *
+         * @return the element, or a null optional when the B+Tree has `k`
+         * or fewer elements
+         */
+        std::optional<KeyValuePair> Select(size_t k) {
+            if (summary_size_ == 0) {
+                auto iter = Begin();
+                for (size_t i = 0; i < k && iter != End(); ++i) {
+                    ++iter;
+                }
+                if (iter == End()) { return std::nullopt; }
+                return KeyValuePair{(*iter).first, (*iter).second};
             }
 
-            return current;
+            std::optional<KeyValuePair> result;
+            while (!TrySelect(k, result)) {}
+            return result;
         }
 
-        std::optional<int> MaybeGet(int key) {
-            root_latch_.LockShared();
+        /**
+         * Folds the values of the elements with keys in `[lo, hi]`, which
+         * are the elements `Scan(lo, hi, ...)` visits.
+         *
+         * With `Augmentation::Aggregates` the child pointers whose subtrees
+         * lie inside the range contribute their summaries, so only the
+         * nodes on the paths to `lo` and `hi` are visited. Otherwise the
+         * range is scanned.
+         */
+        RangeAggregateType Aggregate(const KeyType &lo, const KeyType &hi) {
+            static_assert(std::is_arithmetic_v<ValueType>, "Aggregate needs arithmetic values");
 
-            if (root_ == nullptr) {
-                root_latch_.UnlockShared();
-                return std::nullopt;
-            }
+            RangeAggregateType result;
+            if (KeyCmpLess(hi, lo)) { return result; }
 
-            BaseNode *current_node = root_;
-            BaseNode *parent_node = nullptr;
+            if (augmentation_ != Augmentation::Aggregates) {
+                Scan(lo, hi, [&result](const KeyType &, const ValueType &value) { result.Add(value); });
+                return result;
+            }
 
-            current_node->GetNodeSharedLatch();
-            root_latch_.UnlockShared();
+            BaseNode *node = LatchRootNodeShared();
+            if (node != nullptr) {
+                AggregateBelow(node, lo, hi, true, true, result);
+                node->ReleaseNodeSharedLatch();
+            }
+            return result;
+        }
 
-            while (current_node->GetType() != NodeType::LeafType) {
-                parent_node = current_node;
-                current_node = static_cast<InnerNode *>(current_node)->FindPivot(key)->second;
+        std::optional<ValueType> MaybeGet(const KeyType &key) {
+            if constexpr (kOptimisticReads) {
+                for (int attempt = 0; attempt < kMaxOptimisticAttempts; ++attempt) {
+                    std::optional<ValueType> result;
+                    if (TryOptimisticMaybeGet(key, result)) {
+                        return result;
+                    }
+                }
+            }
 
-                current_node->GetNodeSharedLatch();
-                parent_node->ReleaseNodeSharedLatch();
+            BaseNode *current_node = FindLeafNodeShared([&key](InnerNodeType *node) {
+                return node->FindPivot(key)->second;
+            });
+            if (current_node == nullptr) {
+                return std::nullopt;
             }
 
             // Beyond this point shared latch is only held on the leaf node
-            auto node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
-            auto iter = static_cast<LeafNode *>(node)->FindLocation(key);
+            auto node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
+            auto iter = static_cast<LeafNodeType *>(node)->FindLocation(key);
 
-            auto result = (iter == node->End() || key != iter->first) ? std::nullopt : std::optional<int>{iter->second};
+            auto result = (iter == node->End() || !KeyCmpEqual(key, iter->first))
+                          ? std::nullopt
+                          : std::optional<ValueType>{iter->second};
             current_node->ReleaseNodeSharedLatch();
 
             return result;
         }
 
+        /**
+         * Looks up a batch of keys, like calling `MaybeGet` for every key.
+         *
+         * The keys are looked up in groups. The lookups of a group descend
+         * the B+Tree together one level at a time. At every level, the child
+         * node of each lookup is found and prefetched first, and only then
+         * are the child nodes read. The cache misses of the lookups in a
+         * group therefore overlap instead of stalling one after another.
+         *
+         * The lookups use optimistic lock coupling like `MaybeGet`. A lookup
+         * which fails to validate is retried with `MaybeGet`. When keys or
+         * values cannot be read optimistically, every key is looked up with
+         * `MaybeGet`.
+         *
+         * @param keys array of `count` keys to look up
+         * @param values array of `count` results, set to the value of the
+         * key at the same index, or `std::nullopt` if the key is not found
+         */
+        void MultiGet(const KeyType *keys, size_t count, std::optional<ValueType> *values) {
+            if constexpr (kOptimisticReads) {
+                for (size_t offset = 0; offset < count; offset += kMultiGetGroupSize) {
+                    MultiGetGroup(keys + offset, std::min(kMultiGetGroupSize, count - offset), values + offset);
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = MaybeGet(keys[i]);
+                }
+            }
+        }
+
+#ifdef BPLUSTREE_COROUTINES
+
+        /**
+         * Looks up a batch of keys, like `MultiGet`, by interleaving
+         * lookups written as coroutines.
+         *
+         * Every lookup is the optimistic descent of `MaybeGet`, except that
+         * it prefetches the next node and suspends before reading it. Up to
+         * `group_size` lookups are in flight at once, and they are resumed
+         * round-robin. A lookup which finishes is replaced by the lookup of
+         * the next key, so a fast lookup does not wait for the slow ones in
+         * its group like in `MultiGet`.
+         *
+         * Only available when compiled as C++20 or later.
+         *
+         * @param keys array of `count` keys to look up
+         * @param values array of `count` results, set to the value of the
+         * key at the same index, or `std::nullopt` if the key is not found
+         * @param group_size no. of lookups interleaved at once
+         */
+        void InterleavedGet(const KeyType *keys, size_t count, std::optional<ValueType> *values,
+                            size_t group_size = kMultiGetGroupSize) {
+            if constexpr (kOptimisticReads) {
+                std::vector<size_t> failed;
+                {
+                    EpochManager::Guard epoch_guard{epoch_manager_};
+                    BPLUSTREE_TSAN_IGNORE_READS_BEGIN();
+
+                    // The lookup running in each slot, and the index of its key
+                    std::vector<CoroutineTask> tasks(std::max<size_t>(group_size, 1));
+                    std::vector<size_t> indexes(tasks.size());
+                    std::vector<char> succeeded(tasks.size());
+
+                    size_t next = 0;
+                    size_t running = 0;
+                    for (size_t slot = 0; slot < tasks.size() && next < count; ++slot, ++next) {
+                        tasks[slot] = OptimisticLookup(keys[next], values[next], succeeded[slot]);
+                        indexes[slot] = next;
+                        ++running;
+                    }
+
+                    while (running > 0) {
+                        for (size_t slot = 0; slot < tasks.size(); ++slot) {
+                            if (!tasks[slot].Pending()) { continue; }
+
+                            tasks[slot].Resume();
+                            if (tasks[slot].Pending()) { continue; }
+
+                            if (!succeeded[slot]) {
+                                failed.push_back(indexes[slot]);
+                            }
+
+                            if (next < count) {
+                                tasks[slot] = OptimisticLookup(keys[next], values[next], succeeded[slot]);
+                                indexes[slot] = next++;
+                            } else {
+                                --running;
+                            }
+                        }
+                    }
+
+                    BPLUSTREE_TSAN_IGNORE_READS_END();
+                }
+
+                for (auto i: failed) {
+                    values[i] = MaybeGet(keys[i]);
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    values[i] = MaybeGet(keys[i]);
+                }
+            }
+        }
+
+#endif /* BPLUSTREE_COROUTINES */
+
         void FreeTree() {
+            // Retired nodes are returned to the allocator first, as they are
+            // not reachable from the root anymore
+            epoch_manager_.ReclaimAll();
+
             if (root_ == nullptr) { return; }
 
+            // Nothing has to be destructed, so the allocator can release
+            // whole slabs without visiting the nodes
+            if constexpr (kTriviallyDestructibleElements) {
+                if (allocator_->ReleaseAll()) {
+                    root_ = nullptr;
+                    return;
+                }
+            }
+
             std::queue<BaseNode *> collect_queue;
             std::queue<BaseNode *> free_queue;
             collect_queue.push(root_);
@@ -778,7 +1774,7 @@ namespace bplustree {
                 free_queue.push(current_node);
 
                 if (current_node->GetType() != NodeType::LeafType) {
-                    auto node = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(current_node);
+                    auto node = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(current_node);
 
                     collect_queue.push(node->GetLowKeyPair().second);
                     auto current_element = node->Begin();
@@ -794,13 +1790,15 @@ namespace bplustree {
                 free_queue.pop();
 
                 if (current_node->GetType() != NodeType::LeafType) {
-                    auto node = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(current_node);
+                    auto node = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(current_node);
                     node->FreeElasticNode();
                 } else {
-                    auto node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
+                    auto node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
                     node->FreeElasticNode();
                 }
             }
+
+            root_ = nullptr;
         }
 
         bool ReleaseAllWriteLatches(std::vector<BaseNode *> &latches, bool holds_root_latch) {
@@ -817,6 +1815,145 @@ namespace bplustree {
             return holds_root_latch;
         }
 
+        /**
+         * Acquires an exclusive latch on the root node for a pessimistic
+         * traversal.
+         *
+         * The root latch only has to be held in exclusive mode when the
+         * operation could replace the root of the B+Tree, which happens
+         * when the root node splits or collapses. So the root node is first
+         * latched while holding the root latch in shared mode. If the root
+         * node is safe the root latch is released right away. Otherwise we
+         * start over, this time holding the root latch in exclusive mode.
+         *
+         * @param is_root_safe returns true if the operation cannot split or
+         * collapse the given root node
+         * @param holds_root_latch set to true when the root latch is held in
+         * exclusive mode on return
+         * @return The exclusively latched root node. Returns `nullptr` when
+         * the B+Tree is empty, in which case the root latch is held in
+         * exclusive mode.
+         */
+        template<typename IsRootSafe>
+        BaseNode *LatchRootNodeExclusive(const IsRootSafe &is_root_safe, bool &holds_root_latch) {
+            root_latch_.LockShared();
+            if (root_ != nullptr) {
+                BaseNode *root = root_;
+                root->GetNodeExclusiveLatch();
+
+                if (is_root_safe(root)) {
+                    root_latch_.UnlockShared();
+                    holds_root_latch = false;
+                    return root;
+                }
+                root->ReleaseNodeExclusiveLatch();
+            }
+            root_latch_.UnlockShared();
+
+            root_latch_.LockExclusive();
+            holds_root_latch = true;
+            if (root_ != nullptr) {
+                root_->GetNodeExclusiveLatch();
+            }
+
+            return root_;
+        }
+
+        /**
+         * @return the root node latched in shared mode, or nullptr when the
+         * B+Tree is empty
+         */
+        BaseNode *LatchRootNodeShared() {
+            root_latch_.LockShared();
+            BaseNode *root = root_;
+            if (root != nullptr) {
+                root->GetNodeSharedLatch();
+            }
+            root_latch_.UnlockShared();
+
+            return root;
+        }
+
+        /**
+         * Creates a root leaf node containing the key-value element, if the
+         * B+Tree is empty.
+         *
+         * @return true if the key-value element was inserted. Returns false
+         * if the B+Tree was not empty anymore.
+         */
+        bool MaybeInsertIntoEmptyTree(const KeyValuePair &element) {
+            root_latch_.LockExclusive();
+            if (root_ != nullptr) {
+                root_latch_.UnlockExclusive();
+                return false;
+            }
+
+            root_ = NewRootLeafNode(element);
+            root_latch_.UnlockExclusive();
+            return true;
+        }
+
+        BaseNode *NewRootLeafNode(const KeyValuePair &element) {
+            KeyNodePointerPair dummy_low_key = std::make_pair(element.first, nullptr);
+            auto root = ElasticNode<KeyType, KeyValuePair>::Get(NodeType::LeafType, dummy_low_key, leaf_node_max_size_,
+                                                                allocator_.get());
+            root->InsertElementIfPossible(element, root->Begin());
+
+            return root;
+        }
+
+        /**
+         * Builds the B+Tree bottom-up from key-value elements which are
+         * sorted by key.
+         *
+         * The leaf nodes are filled in key order, and linked to their
+         * siblings as they are created. Every level of inner nodes is then
+         * built from the lowest key and the node pointer of each node in the
+         * level below, until a level has a single node which becomes the
+         * root. Unlike inserting the elements one at a time, nodes are never
+         * searched or split.
+         *
+         * The fill factor is the fraction of a node which is filled. Leaving
+         * room in the nodes lets inserts which follow the bulk load proceed
+         * without splitting nodes right away. A node is never filled below
+         * its minimum occupancy, and the elements are spread evenly across
+         * a level so that the last node does not underflow.
+         *
+         * Concurrency: The root latch is held in exclusive mode until the
+         * root of the new B+Tree is published.
+         *
+         * @param first, last range of key-value elements in strictly
+         * increasing order of keys
+         * @param fill_factor in the range (0, 1]
+         * @return true when the elements are loaded. Returns false if the
+         * B+Tree is not empty, or if the keys are not strictly increasing,
+         * and the B+Tree is left unchanged.
+         */
+        template<typename ForwardIterator>
+        bool BulkLoad(ForwardIterator first, ForwardIterator last, double fill_factor = 1.0) {
+            return BulkLoadWithThreads(first, last, fill_factor, 1);
+        }
+
+        /**
+         * Builds the B+Tree bottom-up like `BulkLoad`, using multiple threads.
+         *
+         * The nodes of a level are divided into contiguous slices, and each
+         * thread builds one slice. Every thread starts reading its elements
+         * at a known offset, so the input has to support random access to
+         * be read in parallel. Once all the slices of the leaf level are
+         * built, the leaf nodes at the edges of neighbouring slices are
+         * linked together. The inner levels are built the same way, and the
+         * resulting B+Tree is identical to the one built by `BulkLoad`.
+         *
+         * @param num_threads no. of threads building each level, including
+         * the calling thread
+         */
+        template<typename RandomAccessIterator>
+        bool ParallelBulkLoad(RandomAccessIterator first, RandomAccessIterator last, int num_threads,
+                              double fill_factor = 1.0) {
+            return BulkLoadWithThreads(first, last, fill_factor, std::max(1, num_threads));
+        }
+
         /**
          * Concurrency:
          *
@@ -830,9 +1967,11 @@ namespace bplustree {
          *
          * The root node is protected by a second latch in the B+Tree. This
          * is necessary as the root of the B+Tree itself could change while
-         * the insert is in progress. We always acquire an exclusive latch
-         * for the root node to prevent concurrent modifications to the
-         * root of the B+Tree.
+         * the insert is in progress. The first attempt only reads the root,
+         * so it holds the root latch in shared mode like lookups do. Writers
+         * therefore do not serialize on the root latch. The exclusive mode
+         * is needed only when the root node is about to split, or when the
+         * first key-value element is inserted into an empty B+Tree.
          *
          * Deadlocks are avoided by always acquiring the latches only in
          * a single direction - from the root the leaf nodes of the B+Tree.
@@ -864,54 +2003,59 @@ namespace bplustree {
          * return false.
          */
         bool Insert(const KeyValuePair element) {
-            root_latch_.LockExclusive();
+            root_latch_.LockShared();
 
-            if (root_ == nullptr) {
-                // Create an empty leaf node, which is also the root
-                KeyNodePointerPair dummy_low_key = std::make_pair(element.first, nullptr);
-                root_ = ElasticNode<KeyValuePair>::Get(NodeType::LeafType, dummy_low_key, leaf_node_max_size_);
+            while (root_ == nullptr) {
+                root_latch_.UnlockShared();
+                // Create a leaf node with this element, which is also the root
+                if (MaybeInsertIntoEmptyTree(element)) {
+                    CountOperation(OperationCounter::OptimisticInserts);
+                    return true;
+                }
+                root_latch_.LockShared();
             }
 
             BaseNode *current_node = root_;
             BaseNode *parent_node = nullptr;
+            // Inner nodes kept latched until their summaries are updated
+            std::vector<BaseNode *> summary_path{};
 
             current_node->GetNodeSharedLatch();
 
             // Search for leaf node traversing down the B+Tree
             while (current_node->GetType() != NodeType::LeafType) {
-                if (parent_node != nullptr) {
-                    parent_node->ReleaseNodeSharedLatch();
-                } else {
-                    root_latch_.UnlockExclusive();
-                }
+                ReleaseParentSharedLatch(parent_node, summary_path);
 
                 parent_node = current_node;
-                current_node = static_cast<InnerNode *>(current_node)->FindPivot(element.first)->second;
+                current_node = static_cast<InnerNodeType *>(current_node)->FindPivot(element.first)->second;
                 current_node->GetNodeSharedLatch();
             }
 
             current_node->ReleaseNodeSharedLatch();
             current_node->GetNodeExclusiveLatch();
-            if (parent_node != nullptr) {
-                parent_node->ReleaseNodeSharedLatch();
-            } else {
-                root_latch_.UnlockExclusive();
-            }
+            ReleaseParentSharedLatch(parent_node, summary_path);
 
-            auto node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
-            auto iter = static_cast<LeafNode *>(node)->FindLocation(element.first);
+            auto node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
+            auto iter = static_cast<LeafNodeType *>(node)->FindLocation(element.first);
 
-            if (iter != node->End() && element.first == iter->first) { // Duplicate insertion
+            if (iter != node->End() && KeyCmpEqual(element.first, iter->first)) { // Duplicate insertion
+                ReleaseAllSharedLatches(summary_path);
                 node->ReleaseNodeExclusiveLatch();
+                CountOperation(OperationCounter::OptimisticInserts);
                 return false;
             }
 
             if (node->InsertElementIfPossible(element, iter)) {
+                AddToSummaries(summary_path, element.first, 1, &element.second);
+                ReleaseAllSharedLatches(summary_path);
                 node->ReleaseNodeExclusiveLatch();
+                CountOperation(OperationCounter::OptimisticInserts);
                 return true;
             }
 
+            ReleaseAllSharedLatches(summary_path);
             node->ReleaseNodeExclusiveLatch();
+            CountOperation(OperationCounter::PessimisticInserts);
             /*
              * Optimistic insertion failed, so now we acquire exclusive locks
              * by restarting the traversal from the root of the B+Tree. If a
@@ -921,28 +2065,35 @@ namespace bplustree {
              */
             bool insertion_finished = false;
 
-            root_latch_.LockExclusive();
-            bool holds_root_latch = true;
+            bool holds_root_latch = false;
+            current_node = LatchRootNodeExclusive([](BaseNode *root) {
+                // A root node which is not full will not split
+                return GetNodeCurrentSize(root) < root->GetMaxSize();
+            }, holds_root_latch);
 
-            current_node = root_;
-            current_node->GetNodeExclusiveLatch();
+            // All the key-value elements were removed by other threads
+            if (current_node == nullptr) {
+                root_ = NewRootLeafNode(element);
+                root_latch_.UnlockExclusive();
+                return true;
+            }
 
             std::vector<BaseNode *> stack_traversed_nodes{};
 
             while (current_node->GetType() != NodeType::LeafType) {
-                auto node = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(current_node);
+                auto node = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(current_node);
 
                 // Release all parent exclusive locks if this inner node is safe
                 if (node->GetCurrentSize() < node->GetMaxSize()) {
-                    holds_root_latch = ReleaseAllWriteLatches(stack_traversed_nodes, holds_root_latch);
+                    holds_root_latch = ReleaseSafeAncestors(stack_traversed_nodes, holds_root_latch, summary_path);
                 }
 
                 stack_traversed_nodes.push_back(current_node);
-                current_node = static_cast<InnerNode *>(node)->FindPivot(element.first)->second;
+                current_node = static_cast<InnerNodeType *>(node)->FindPivot(element.first)->second;
                 current_node->GetNodeExclusiveLatch();
             }
 
-            node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
+            node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
 
             /**
              * Duplicates work done in the optimistic approach:
@@ -952,15 +2103,25 @@ namespace bplustree {
              * anymore, and we can insert the key-value element immediately
              * without further splitting.
              */
-            iter = static_cast<LeafNode *>(node)->FindLocation(element.first);
+            iter = static_cast<LeafNodeType *>(node)->FindLocation(element.first);
 
-            if (iter != node->End() && element.first == iter->first) { // Duplicate insertion
+            if (iter != node->End() && KeyCmpEqual(element.first, iter->first)) { // Duplicate insertion
                 node->ReleaseNodeExclusiveLatch();
                 ReleaseAllWriteLatches(stack_traversed_nodes, holds_root_latch);
+                ReleaseAllWriteLatches(summary_path, false);
 
                 return false;
             }
 
+            /**
+             * The element is added to the summaries on the path before the
+             * leaf node splits. The splits below recompute the summaries of
+             * the child pointers they change, while their parent is latched.
+             */
+            AddToSummaries(summary_path, element.first, 1, &element.second);
+            AddToSummaries(stack_traversed_nodes, element.first, 1, &element.second);
+            ReleaseAllWriteLatches(summary_path, false);
+
             if (node->InsertElementIfPossible(element, iter)) {
                 node->ReleaseNodeExclusiveLatch();
                 ReleaseAllWriteLatches(stack_traversed_nodes, holds_root_latch);
@@ -969,15 +2130,16 @@ namespace bplustree {
             }
 
             auto split_node = node->SplitNode();
-            if (element.first >= split_node->Begin()->first) {
+            CountOperation(OperationCounter::LeafSplits);
+            if (!KeyCmpLess(element.first, split_node->Begin()->first)) {
                 split_node->InsertElementIfPossible(
                         element,
-                        static_cast<LeafNode *>(split_node)->FindLocation(element.first)
+                        static_cast<LeafNodeType *>(split_node)->FindLocation(element.first)
                 );
             } else {
                 node->InsertElementIfPossible(
                         element,
-                        static_cast<LeafNode *>(node)->FindLocation(element.first)
+                        static_cast<LeafNodeType *>(node)->FindLocation(element.first)
                 );
 
                 /**
@@ -1000,26 +2162,28 @@ namespace bplustree {
                  * insertion and the minimum size invariants will hold.
                  */
 
-                if (split_node->GetCurrentSize() < static_cast<LeafNode *>(split_node)->GetMinSize()) {
+                if (split_node->GetCurrentSize() < static_cast<LeafNodeType *>(split_node)->GetMinSize()) {
                     split_node->InsertElementIfPossible(
                             (*node->RBegin()),
-                            static_cast<LeafNode *>(split_node)->FindLocation(node->RBegin()->first)
+                            static_cast<LeafNodeType *>(split_node)->FindLocation(node->RBegin()->first)
                     );
                     node->PopEnd();
                 }
             }
 
+            // Fix sibling pointers to maintain a bidirectional chain
+            // of leaf nodes. The split node is not latched, so its own
+            // pointers are set before a reverse iterator moving left from
+            // the right sibling can reach it.
+            split_node->SetSiblingLeft(node);
+            split_node->SetSiblingRight(node->GetSiblingRight());
             if (node->GetSiblingRight() != nullptr) {
-                auto sibling_right = reinterpret_cast<ElasticNode<KeyValuePair> *>(node->GetSiblingRight());
+                auto sibling_right = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(node->GetSiblingRight());
 
                 sibling_right->GetNodeExclusiveLatch();
                 sibling_right->SetSiblingLeft(split_node);
                 sibling_right->ReleaseNodeExclusiveLatch();
             }
-            // Fix sibling pointers to maintain a bidirectional chain
-            // of leaf nodes
-            split_node->SetSiblingLeft(node);
-            split_node->SetSiblingRight(node->GetSiblingRight());
             node->SetSiblingRight(split_node);
 
             /**
@@ -1038,19 +2202,23 @@ namespace bplustree {
             node->ReleaseNodeExclusiveLatch();
 
             KeyNodePointerPair inner_node_element = std::make_pair(split_node->Begin()->first, split_node);
+            // The node which split on the level below
+            BaseNode *split_below = node;
             while (!insertion_finished && !stack_traversed_nodes.empty()) {
-                auto inner_node = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(*stack_traversed_nodes.rbegin());
+                auto inner_node = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(*stack_traversed_nodes.rbegin());
                 stack_traversed_nodes.pop_back();
+                auto split_node_below = inner_node_element.second;
 
                 if (inner_node->InsertElementIfPossible(
                         inner_node_element,
-                        static_cast<InnerNode *>(inner_node)->FindLocation(inner_node_element.first)
+                        static_cast<InnerNodeType *>(inner_node)->FindLocation(inner_node_element.first)
                 )) {
                     // we are done if insertion is possible without further splitting
                     insertion_finished = true;
                 } else {
                     // Recursively split the node
                     auto split_inner_node = inner_node->SplitNode();
+                    CountOperation(OperationCounter::InnerSplits);
 
                     /**
                      * A bug narrative:
@@ -1077,21 +2245,34 @@ namespace bplustree {
                      */
                     split_inner_node->GetLowKeyPair().first = inner_node->RBegin()->first;
                     split_inner_node->GetLowKeyPair().second = inner_node->RBegin()->second;
+                    split_inner_node->CopySummary(0, inner_node, inner_node->GetCurrentSize());
                     inner_node->PopEnd();
 
-                    if (inner_node_element.first >= split_inner_node->GetLowKeyPair().first) {
+                    if (!KeyCmpLess(inner_node_element.first, split_inner_node->GetLowKeyPair().first)) {
                         split_inner_node->InsertElementIfPossible(inner_node_element,
-                                                                  static_cast<InnerNode *>(split_inner_node)->FindLocation(
+                                                                  static_cast<InnerNodeType *>(split_inner_node)->FindLocation(
                                                                           inner_node_element.first));
                     } else {
                         inner_node->InsertElementIfPossible(inner_node_element,
-                                                            static_cast<InnerNode *>(inner_node)->FindLocation(
+                                                            static_cast<InnerNodeType *>(inner_node)->FindLocation(
                                                                     inner_node_element.first));
                     }
 
                     inner_node_element = std::make_pair(split_inner_node->GetLowKeyPair().first, split_inner_node);
                 }
 
+                // Both halves of the split below may have moved to the
+                // split node of this level
+                if (summary_size_ > 0) {
+                    auto split_inner_node = insertion_finished
+                                            ? nullptr
+                                            : static_cast<InnerNodeType *>(inner_node_element.second);
+                    RefreshSummaryOf(static_cast<InnerNodeType *>(inner_node), split_inner_node, split_below);
+                    RefreshSummaryOf(static_cast<InnerNodeType *>(inner_node), split_inner_node,
+                                         split_node_below);
+                }
+                split_below = inner_node;
+
                 inner_node->ReleaseNodeExclusiveLatch();
             }
 
@@ -1103,12 +2284,15 @@ namespace bplustree {
                 auto old_root = root_;
 
                 KeyNodePointerPair low_key = std::make_pair(inner_node_element.first, old_root);
-                root_ = ElasticNode<KeyNodePointerPair>::Get(NodeType::InnerType, low_key, inner_node_max_size_);
+                root_ = ElasticNode<KeyType, KeyNodePointerPair>::Get(NodeType::InnerType, low_key, inner_node_max_size_,
+                                                                      allocator_.get(), summary_size_);
 
-                auto new_root = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(root_);
+                auto new_root = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(root_);
                 new_root->InsertElementIfPossible(inner_node_element,
-                                                  static_cast<InnerNode *>(new_root)->FindLocation(
+                                                  static_cast<InnerNodeType *>(new_root)->FindLocation(
                                                           inner_node_element.first));
+                SummarizeChildren(static_cast<InnerNodeType *>(new_root));
+                CountOperation(OperationCounter::RootSplits);
             }
 
             if (holds_root_latch) {
@@ -1119,7 +2303,37 @@ namespace bplustree {
             return true;
         }
 
-        bool Delete(const int keyToRemove) {
+        /**
+         * Inserts a batch of key-value elements, descending the B+Tree once
+         * for every leaf node the batch writes to instead of once for every
+         * element.
+         *
+         * The descent records the range of keys which belong to the leaf
+         * node it reaches. The following elements of the batch which fall in
+         * that range are inserted while the exclusive latch on the leaf node
+         * is held. The next element outside the range starts a new descent.
+         * The batch does not have to be sorted, but runs of sorted keys are
+         * grouped the best. When a leaf node overflows the element is
+         * inserted using `Insert`, which splits the node.
+         *
+         * @param first, last range of key-value elements
+         * @return whether each element was inserted, in the order of the
+         * batch. Like `Insert`, an element whose key already exists in the
+         * B+Tree, or earlier in the batch, is not inserted.
+         */
+        template<typename ForwardIterator>
+        std::vector<bool> InsertBatch(ForwardIterator first, ForwardIterator last) {
+            std::vector<bool> inserted;
+            inserted.reserve(std::distance(first, last));
+
+            while (first != last) {
+                first = InsertIntoSameLeaf(first, last, inserted);
+            }
+
+            return inserted;
+        }
+
+        bool Delete(const KeyType &keyToRemove) {
             /**
              * Optimistic Approach:
              *
@@ -1127,31 +2341,32 @@ namespace bplustree {
              * element is removed. Therefore we do not need to acquire
              * exclusive write latches while traversing the B+Tree. We
              * only acquire an exclusive write latch on the leaf node from
-             * which the key-value element needs to be removed.
+             * which the key-value element needs to be removed. The root
+             * latch is held in shared mode, as the root of the B+Tree does
+             * not change in the optimistic approach.
              */
 
-            root_latch_.LockExclusive();
+            root_latch_.LockShared();
 
             // Empty B+Tree
             if (root_ == nullptr) {
-                root_latch_.UnlockExclusive();
+                root_latch_.UnlockShared();
+                CountOperation(OperationCounter::OptimisticDeletes);
                 return false;
             }
 
             BaseNode *current = root_;
             BaseNode *parent = nullptr;
+            // Inner nodes kept latched until their summaries are updated
+            std::vector<BaseNode *> summary_path{};
 
             current->GetNodeSharedLatch();
             while (current->GetType() != NodeType::LeafType) {
-                if (parent != nullptr) {
-                    parent->ReleaseNodeSharedLatch();
-                } else {
-                    root_latch_.UnlockExclusive();
-                }
+                ReleaseParentSharedLatch(parent, summary_path);
 
                 parent = current;
 
-                current = static_cast<InnerNode *>(current)->FindPivot(keyToRemove)->second;
+                current = static_cast<InnerNodeType *>(current)->FindPivot(keyToRemove)->second;
                 current->GetNodeSharedLatch();
             }
 
@@ -1159,54 +2374,70 @@ namespace bplustree {
             current->GetNodeExclusiveLatch();
 
             bool removable = false;
-            auto node = static_cast<LeafNode *>(current);
+            auto node = static_cast<LeafNodeType *>(current);
 
             if (parent != nullptr) {
-                parent->ReleaseNodeSharedLatch();
                 removable = node->GetCurrentSize() > node->GetMinSize(); // underflow?
             } else {
-                root_latch_.UnlockExclusive();
                 // root node is also the leaf node
                 removable = node->GetCurrentSize() > 1; // will root change?
             }
+            ReleaseParentSharedLatch(parent, summary_path);
 
             auto iter = node->FindLocation(keyToRemove);
-            if (removable) {
-                // Key does not exist in the node
-                if (iter == node->End()) {
-                    current->ReleaseNodeExclusiveLatch();
-                    return false;
-                }
 
-                // Does not match the key to be removed
-                if (keyToRemove != iter->first) {
-                    current->ReleaseNodeExclusiveLatch();
-                    return false;
-                }
+            // Key does not exist in the node. There is nothing to rebalance
+            // so the pessimistic approach is not necessary.
+            if (iter == node->End() || !KeyCmpEqual(keyToRemove, iter->first)) {
+                ReleaseAllSharedLatches(summary_path);
+                current->ReleaseNodeExclusiveLatch();
+                CountOperation(OperationCounter::OptimisticDeletes);
+                return false;
+            }
+
+            // A minimum or maximum of a summary is recomputed on the
+            // pessimistic path, which latches the summaries exclusively
+            if (removable && IsInsideSummaries(summary_path, keyToRemove, iter->second)) {
+                // Kept until the summaries are updated, after the element
+                // is destroyed
+                std::optional<ValueType> removed_value;
+                if (augmentation_ == Augmentation::Aggregates) { removed_value = iter->second; }
 
                 node->DeleteElement(iter);
+                AddToSummaries(summary_path, keyToRemove, -1, removed_value ? &*removed_value : nullptr);
+                ReleaseAllSharedLatches(summary_path);
                 current->ReleaseNodeExclusiveLatch();
+                CountOperation(OperationCounter::OptimisticDeletes);
                 return true;
             }
 
+            ReleaseAllSharedLatches(summary_path);
             current->ReleaseNodeExclusiveLatch();
+            CountOperation(OperationCounter::PessimisticDeletes);
             /**
              * Optimistic approach failed.
              */
 
-            root_latch_.LockExclusive();
-            bool holds_root_latch = true;
+            bool holds_root_latch = false;
+            current = LatchRootNodeExclusive([](BaseNode *root) {
+                // The root node is replaced only when an inner node is left
+                // without any keys, or a leaf node without any elements.
+                return GetNodeCurrentSize(root) > 1;
+            }, holds_root_latch);
 
-            current = root_;
-            current->GetNodeExclusiveLatch();
+            // The last key-value element was removed by another thread
+            if (current == nullptr) {
+                root_latch_.UnlockExclusive();
+                return false;
+            }
 
             std::vector<BaseNode *> stack_latched_nodes{};
             while (current->GetType() != NodeType::LeafType) {
-                auto node = static_cast<InnerNode *>(current);
+                auto node = static_cast<InnerNodeType *>(current);
 
                 // Release all parent latches if this node is safe
                 if (node->GetCurrentSize() > node->GetMinSize()) {
-                    holds_root_latch = ReleaseAllWriteLatches(stack_latched_nodes, holds_root_latch);
+                    holds_root_latch = ReleaseSafeAncestors(stack_latched_nodes, holds_root_latch, summary_path);
                 }
 
                 stack_latched_nodes.push_back(current);
@@ -1215,11 +2446,39 @@ namespace bplustree {
                 current->GetNodeExclusiveLatch();
             }
 
-            node = static_cast<LeafNode *>(current);
+            node = static_cast<LeafNodeType *>(current);
             iter = node->FindLocation(keyToRemove);
 
+            /**
+             * The key may not exist, or may have been removed by another
+             * thread after the optimistic attempt failed. Deleting at the
+             * lower bound location would then remove a different key.
+             */
+            if (iter == node->End() || !KeyCmpEqual(keyToRemove, iter->first)) {
+                node->ReleaseNodeExclusiveLatch();
+                ReleaseAllWriteLatches(stack_latched_nodes, holds_root_latch);
+                ReleaseAllWriteLatches(summary_path, false);
+
+                return false;
+            }
+
+            // Kept until the summaries are updated, after the element is
+            // destroyed
+            std::optional<ValueType> removed_value;
+            if (augmentation_ == Augmentation::Aggregates) { removed_value = iter->second; }
+
             node->DeleteElement(iter);
 
+            /**
+             * The element is taken out of the summaries on the path before
+             * the leaf node is rebalanced, from the leaf level up. Borrowing
+             * and merging recompute the summaries of the child pointers they
+             * change, while their parent is latched.
+             */
+            AddToSummaries(stack_latched_nodes, keyToRemove, -1, removed_value ? &*removed_value : nullptr);
+            AddToSummaries(summary_path, keyToRemove, -1, removed_value ? &*removed_value : nullptr);
+            ReleaseAllWriteLatches(summary_path, false);
+
             /**
              * Verify underflow condition exists before proceeding
              * to rebalance the B+Tree. It is possible by the time
@@ -1238,11 +2497,11 @@ namespace bplustree {
              * Rebalance the B+Tree
              */
 
-            ElasticNode<KeyNodePointerPair> *inner_node{nullptr};
+            ElasticNode<KeyType, KeyNodePointerPair> *inner_node{nullptr};
             bool deletion_finished = false;
 
             if (!stack_latched_nodes.empty()) {
-                auto parent = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(*stack_latched_nodes.rbegin());
+                auto parent = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(*stack_latched_nodes.rbegin());
                 stack_latched_nodes.pop_back();
 
                 /**
@@ -1257,7 +2516,7 @@ namespace bplustree {
                  * of th neighbour leaf nodes.
                  */
 
-                auto maybe_previous = static_cast<InnerNode *>(parent)->MaybePreviousWithSeparator(keyToRemove);
+                auto maybe_previous = static_cast<InnerNodeType *>(parent)->MaybePreviousWithSeparator(keyToRemove);
                 if (maybe_previous.has_value()) {
                     /**
                      * A bug narrative:
@@ -1297,7 +2556,7 @@ namespace bplustree {
                      * This adds complexity to the code but is essential for
                      * correctness.
                      */
-                    auto other = reinterpret_cast<ElasticNode<KeyValuePair> *>((*maybe_previous).first);
+                    auto other = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>((*maybe_previous).first);
                     auto pivot = (*maybe_previous).second;
 
                     current->ReleaseNodeExclusiveLatch();
@@ -1310,15 +2569,18 @@ namespace bplustree {
                         current->ReleaseNodeExclusiveLatch();
                         other->ReleaseNodeExclusiveLatch();
                     } else {
-                        bool will_underflow = (other->GetCurrentSize() - 1) < static_cast<LeafNode *>(other)->GetMinSize();
+                        bool will_underflow = (other->GetCurrentSize() - 1) < static_cast<LeafNodeType *>(other)->GetMinSize();
                         if (!will_underflow) {
                             node->InsertElementIfPossible((*other->RBegin()), node->Begin());
                             other->PopEnd();
                             pivot->first = node->Begin()->first;
+                            CountOperation(OperationCounter::LeafBorrows);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, node);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
-                            BPLUSTREE_ASSERT(node->GetCurrentSize() >= static_cast<LeafNode *>(node)->GetMinSize(),
+                            BPLUSTREE_ASSERT(node->GetCurrentSize() >= static_cast<LeafNodeType *>(node)->GetMinSize(),
                                              "node meets minimum occupancy requirement after borrow from previous leaf node");
-                            BPLUSTREE_ASSERT(other->GetCurrentSize() >= static_cast<LeafNode *>(other)->GetMinSize(),
+                            BPLUSTREE_ASSERT(other->GetCurrentSize() >= static_cast<LeafNodeType *>(other)->GetMinSize(),
                                              "borrowing one element did not cause underflow in previous leaf node");
 
                             current->ReleaseNodeExclusiveLatch();
@@ -1328,8 +2590,9 @@ namespace bplustree {
                             BPLUSTREE_ASSERT(other->GetCurrentSize() + node->GetCurrentSize() <= node->GetMaxSize(),
                                              "contents will fit a single leaf node after merge");
                             other->MergeNode(node);
+                            CountOperation(OperationCounter::LeafMerges);
                             if (node->GetSiblingRight() != nullptr) {
-                                auto sibling_right = static_cast<LeafNode *>(node->GetSiblingRight());
+                                auto sibling_right = static_cast<LeafNodeType *>(node->GetSiblingRight());
 
                                 sibling_right->GetNodeExclusiveLatch();
                                 sibling_right->SetSiblingLeft(other);
@@ -1338,30 +2601,34 @@ namespace bplustree {
                             other->SetSiblingRight(node->GetSiblingRight());
 
                             parent->DeleteElement(pivot);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
                             current->ReleaseNodeExclusiveLatch();
                             other->ReleaseNodeExclusiveLatch();
-                            node->FreeElasticNode();
+                            RetireNode(node);
                         }
                     }
                 } else {
-                    auto maybe_next = static_cast<InnerNode *>(parent)->MaybeNextWithSeparator(keyToRemove);
+                    auto maybe_next = static_cast<InnerNodeType *>(parent)->MaybeNextWithSeparator(keyToRemove);
                     if (maybe_next.has_value()) {
-                        auto other = reinterpret_cast<ElasticNode<KeyValuePair> *>((*maybe_next).first);
+                        auto other = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>((*maybe_next).first);
                         auto pivot = (*maybe_next).second;
 
                         other->GetNodeExclusiveLatch();
 
                         bool will_underflow =
-                                (other->GetCurrentSize() - 1) < static_cast<LeafNode *>(other)->GetMinSize();
+                                (other->GetCurrentSize() - 1) < static_cast<LeafNodeType *>(other)->GetMinSize();
                         if (!will_underflow) {
                             node->InsertElementIfPossible((*other->Begin()), node->End());
                             other->PopBegin();
                             pivot->first = other->Begin()->first;
+                            CountOperation(OperationCounter::LeafBorrows);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, node);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
-                            BPLUSTREE_ASSERT(node->GetCurrentSize() >= static_cast<LeafNode *>(node)->GetMinSize(),
+                            BPLUSTREE_ASSERT(node->GetCurrentSize() >= static_cast<LeafNodeType *>(node)->GetMinSize(),
                                              "node meets minimum occupancy requirement after borrow from previous leaf node");
-                            BPLUSTREE_ASSERT(other->GetCurrentSize() >= static_cast<LeafNode *>(other)->GetMinSize(),
+                            BPLUSTREE_ASSERT(other->GetCurrentSize() >= static_cast<LeafNodeType *>(other)->GetMinSize(),
                                              "borrowing one element did not cause underflow in previous leaf node");
 
                             current->ReleaseNodeExclusiveLatch();
@@ -1372,8 +2639,9 @@ namespace bplustree {
                             BPLUSTREE_ASSERT(other->GetCurrentSize() + node->GetCurrentSize() <= node->GetMaxSize(),
                                              "contents will fit a single leaf node after merge");
                             node->MergeNode(other);
+                            CountOperation(OperationCounter::LeafMerges);
                             if (other->GetSiblingRight() != nullptr) {
-                                auto sibling_right = static_cast<LeafNode *>(other->GetSiblingRight());
+                                auto sibling_right = static_cast<LeafNodeType *>(other->GetSiblingRight());
 
                                 sibling_right->GetNodeExclusiveLatch();
                                 sibling_right->SetSiblingLeft(node);
@@ -1382,16 +2650,17 @@ namespace bplustree {
                             node->SetSiblingRight(other->GetSiblingRight());
 
                             parent->DeleteElement(pivot);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, node);
 
                             other->ReleaseNodeExclusiveLatch();
-                            other->FreeElasticNode();
+                            RetireNode(other);
 
                             current->ReleaseNodeExclusiveLatch();
                         }
                     }
                 }
 
-                if (parent->GetCurrentSize() >= static_cast<InnerNode *>(parent)->GetMinSize()) {
+                if (parent->GetCurrentSize() >= static_cast<InnerNodeType *>(parent)->GetMinSize()) {
                     deletion_finished = true;
                 }
 
@@ -1407,10 +2676,10 @@ namespace bplustree {
 
             // Re-balances tree
             while (!deletion_finished && !stack_latched_nodes.empty()) {
-                auto parent = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(*stack_latched_nodes.rbegin());
+                auto parent = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(*stack_latched_nodes.rbegin());
                 stack_latched_nodes.pop_back();
 
-                auto maybe_previous = static_cast<InnerNode *>(parent)->MaybePreviousWithSeparator(keyToRemove);
+                auto maybe_previous = static_cast<InnerNodeType *>(parent)->MaybePreviousWithSeparator(keyToRemove);
                 if (maybe_previous.has_value()) {
                     /**
                      * A bug narrative:
@@ -1450,30 +2719,35 @@ namespace bplustree {
                      * This adds complexity to the code but is essential for
                      * correctness.
                      */
-                    auto other = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>((*maybe_previous).first);
+                    auto other = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>((*maybe_previous).first);
                     inner_node->ReleaseNodeExclusiveLatch();
                     other->GetNodeExclusiveLatch();
                     inner_node->GetNodeExclusiveLatch();
 
                     auto pivot = (*maybe_previous).second;
 
-                    if (inner_node->GetCurrentSize() >= static_cast<InnerNode *>(inner_node)->GetMinSize()) {
+                    if (inner_node->GetCurrentSize() >= static_cast<InnerNodeType *>(inner_node)->GetMinSize()) {
                         // Underflow was resolved by another thread.
                         deletion_finished = true;
                         inner_node->ReleaseNodeExclusiveLatch();
                         other->ReleaseNodeExclusiveLatch();
                     } else {
-                        bool will_underflow = (other->GetCurrentSize() - 1) < static_cast<InnerNode *>(other)->GetMinSize();
+                        bool will_underflow = (other->GetCurrentSize() - 1) < static_cast<InnerNodeType *>(other)->GetMinSize();
                         if (!will_underflow) {
-                            auto borrowed = *(other->RBegin());
-                            other->PopEnd();
+                            KeyNodePointerPair borrowed = *(other->RBegin());
 
                             inner_node->InsertElementIfPossible(
                                     std::make_pair(pivot->first, inner_node->GetLowKeyPair().second),
                                     inner_node->Begin());
+                            inner_node->CopySummary(1, inner_node, 0);
+                            inner_node->CopySummary(0, other, other->GetCurrentSize());
                             inner_node->SetLowKeyPair(std::make_pair(pivot->first, borrowed.second));
+                            other->PopEnd();
 
                             pivot->first = borrowed.first;
+                            CountOperation(OperationCounter::InnerBorrows);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, inner_node);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
                             inner_node->ReleaseNodeExclusiveLatch();
                             other->ReleaseNodeExclusiveLatch();
@@ -1511,35 +2785,43 @@ namespace bplustree {
                                     std::make_pair(pivot->first, inner_node->GetLowKeyPair().second),
                                     other->End()
                             );
+                            other->CopySummary(other->GetCurrentSize(), inner_node, 0);
                             other->MergeNode(inner_node);
+                            CountOperation(OperationCounter::InnerMerges);
 
                             parent->DeleteElement(pivot);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
                             inner_node->ReleaseNodeExclusiveLatch();
                             other->ReleaseNodeExclusiveLatch();
-                            inner_node->FreeElasticNode();
+                            RetireNode(inner_node);
                         }
                     }
                 } else {
-                    auto maybe_next = static_cast<InnerNode *>(parent)->MaybeNextWithSeparator(keyToRemove);
+                    auto maybe_next = static_cast<InnerNodeType *>(parent)->MaybeNextWithSeparator(keyToRemove);
                     if (maybe_next.has_value()) {
-                        auto other = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>((*maybe_next).first);
+                        auto other = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>((*maybe_next).first);
                         auto pivot = (*maybe_next).second;
 
                         other->GetNodeExclusiveLatch();
 
                         bool will_underflow =
-                                (other->GetCurrentSize() - 1) < static_cast<InnerNode *>(other)->GetMinSize();
+                                (other->GetCurrentSize() - 1) < static_cast<InnerNodeType *>(other)->GetMinSize();
                         if (!will_underflow) {
-                            auto borrowed = *(other->Begin());
-                            other->PopBegin();
+                            KeyNodePointerPair borrowed = *(other->Begin());
 
                             inner_node->InsertElementIfPossible(
                                     std::make_pair(pivot->first, other->GetLowKeyPair().second),
                                     inner_node->End()
                             );
+                            inner_node->CopySummary(inner_node->GetCurrentSize(), other, 0);
+                            other->CopySummary(0, other, 1);
                             other->SetLowKeyPair(std::make_pair(pivot->first, borrowed.second));
+                            other->PopBegin();
                             pivot->first = borrowed.first;
+                            CountOperation(OperationCounter::InnerBorrows);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, inner_node);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, other);
 
                             other->ReleaseNodeExclusiveLatch();
                             inner_node->ReleaseNodeExclusiveLatch();
@@ -1577,19 +2859,22 @@ namespace bplustree {
                                     std::make_pair(pivot->first, other->GetLowKeyPair().second),
                                     inner_node->End()
                             );
+                            inner_node->CopySummary(inner_node->GetCurrentSize(), other, 0);
                             inner_node->MergeNode(other);
+                            CountOperation(OperationCounter::InnerMerges);
 
                             parent->DeleteElement(pivot);
+                            RefreshSummaryOf(static_cast<InnerNodeType *>(parent), nullptr, inner_node);
 
                             other->ReleaseNodeExclusiveLatch();
-                            other->FreeElasticNode();
+                            RetireNode(other);
 
                             inner_node->ReleaseNodeExclusiveLatch();
                         }
                     }
                 }
 
-                if (parent->GetCurrentSize() >= static_cast<InnerNode *>(parent)->GetMinSize()) {
+                if (parent->GetCurrentSize() >= static_cast<InnerNodeType *>(parent)->GetMinSize()) {
                     deletion_finished = true;
                 }
 
@@ -1607,21 +2892,24 @@ namespace bplustree {
              * Reduce tree depth if root node has insufficient children
              */
             if (!deletion_finished && inner_node != nullptr) {
-                BPLUSTREE_ASSERT(holds_root_latch, "Exclusive root latch held");
                 BPLUSTREE_ASSERT(inner_node == root_, "delete returned back to root node");
 
                 if (inner_node->GetCurrentSize() == 0) {
+                    BPLUSTREE_ASSERT(holds_root_latch, "Exclusive root latch held");
                     auto old_root = root_;
                     root_ = inner_node->GetLowKeyPair().second;
+                    CountOperation(OperationCounter::RootCollapses);
 
                     inner_node->ReleaseNodeExclusiveLatch();
 
-                    static_cast<InnerNode *>(old_root)->FreeElasticNode();
+                    RetireNode(old_root);
                 } else {
                     inner_node->ReleaseNodeExclusiveLatch();
                 }
 
-                root_latch_.UnlockExclusive();
+                if (holds_root_latch) {
+                    root_latch_.UnlockExclusive();
+                }
 
                 return true;
             }
@@ -1630,17 +2918,17 @@ namespace bplustree {
              * Update root if the B+Tree has no more elements left
              */
             if (!deletion_finished && inner_node == nullptr && node == root_) {
-                BPLUSTREE_ASSERT(holds_root_latch, "Has exclusive latch for modifying root");
-
                 if (node->GetCurrentSize() == 0) {
+                    BPLUSTREE_ASSERT(holds_root_latch, "Has exclusive latch for modifying root");
                     node->ReleaseNodeExclusiveLatch();
-                    node->FreeElasticNode();
+                    RetireNode(node);
 
                     root_ = nullptr;
-                    root_latch_.UnlockExclusive();
                 } else {
                     node->ReleaseNodeExclusiveLatch();
+                }
 
+                if (holds_root_latch) {
                     root_latch_.UnlockExclusive();
                 }
             }
@@ -1648,6 +2936,93 @@ namespace bplustree {
             return true;
         }
 
+        /**
+         * Removes the elements with keys in `[lo, hi]`.
+         *
+         * Deleting a range one key at a time rebalances the B+Tree every
+         * time a leaf node underflows. Instead, the leaf nodes inside the
+         * range are unlinked and retired together, the leaf nodes at the
+         * edges of the range are trimmed, and each level is rebalanced once.
+         *
+         * The root latch is held in exclusive mode like in a bulk load. The
+         * levels are latched from the root down, and each level from left to
+         * right, which is the order in which writers acquire their latches.
+         * On every level the nodes containing `lo` and `hi` stay latched,
+         * and also the nearest node on either side of them. The nodes in
+         * between are only latched until the threads in them have left, and
+         * are retired. Going back up from the leaf level, the elements left
+         * over in the latched nodes of a level are spread evenly across as
+         * few of those nodes as needed, and the nodes which are not needed
+         * anymore are retired. The level above is then rebuilt from its
+         * remaining child pointers, and the rebuilt nodes below it. A
+         * separator key is replaced only when the node it points to was
+         * rebuilt.
+         *
+         * @return no. of elements removed
+         */
+        size_t DeleteRange(const KeyType &lo, const KeyType &hi) {
+            if (KeyCmpLess(hi, lo)) { return 0; }
+
+            root_latch_.LockExclusive();
+            if (root_ == nullptr) {
+                root_latch_.UnlockExclusive();
+                return 0;
+            }
+
+            // The nodes inside the range are not latched anymore, but cannot
+            // be reached by other threads
+            std::vector<BaseNode *> retired;
+            auto levels = LatchRangeLevels(lo, hi, retired);
+
+            size_t removed = 0;
+            for (auto node: retired) {
+                if (node->GetType() == NodeType::LeafType) {
+                    removed += GetNodeCurrentSize(node);
+                }
+            }
+            for (auto &entry: levels.back().nodes_) {
+                auto leaf = static_cast<LeafNodeType *>(entry.second);
+                auto [first, last] = FindRangeInLeaf(leaf, lo, hi);
+                removed += last - first;
+            }
+
+            if (removed > 0) {
+                // The nodes rebuilt on each level, from the leaf level up
+                std::vector<std::vector<KeyNodePointerPair>> rebuilt;
+                rebuilt.push_back(RebuildLeafLevel(lo, hi, levels.back().nodes_, retired));
+                for (auto level = std::next(levels.rbegin()); level != levels.rend(); ++level) {
+                    rebuilt.push_back(RebuildInnerLevel(*level, rebuilt.back(), retired));
+                }
+
+                BPLUSTREE_ASSERT(rebuilt.back().size() <= 1, "The root level is rebuilt into a single node");
+                root_ = rebuilt.back().empty() ? nullptr : rebuilt.back().front().second;
+
+                // Remove root nodes which are left with a single child. The
+                // size is read only for nodes which are still latched.
+                for (auto level = std::next(rebuilt.rbegin()); root_ != nullptr; ++level) {
+                    if (root_->GetType() != NodeType::InnerType || GetNodeCurrentSize(root_) > 0) { break; }
+
+                    retired.push_back(root_);
+                    root_ = static_cast<InnerNodeType *>(root_)->GetLowKeyPair().second;
+                    CountOperation(OperationCounter::RootCollapses);
+
+                    if (level->size() != 1 || level->front().second != root_) { break; }
+                }
+            }
+
+            for (auto &level: levels) {
+                for (auto &entry: level.nodes_) {
+                    entry.second->ReleaseNodeExclusiveLatch();
+                }
+            }
+            for (auto node: retired) {
+                RetireNode(node);
+            }
+
+            root_latch_.UnlockExclusive();
+            return removed;
+        }
+
         std::string ToGraph() {
             if (root_ == nullptr) {
                 return "digraph empty_bplus_tree {}";
@@ -1666,7 +3041,7 @@ namespace bplustree {
                 nodes.pop();
 
                 if (current_node->GetType() == NodeType::InnerType) {
-                    auto inner_node = reinterpret_cast<ElasticNode<KeyNodePointerPair> *>(current_node);
+                    auto inner_node = reinterpret_cast<ElasticNode<KeyType, KeyNodePointerPair> *>(current_node);
 
                     graph << std::endl;
                     graph << MakeNodeIdFor(inner_node);
@@ -1689,7 +3064,7 @@ namespace bplustree {
                         nodes.push(child_node);
                     }
                 } else {
-                    auto leaf_node = reinterpret_cast<ElasticNode<KeyValuePair> *>(current_node);
+                    auto leaf_node = reinterpret_cast<ElasticNode<KeyType, KeyValuePair> *>(current_node);
 
                     graph << std::endl;
                     graph << MakeNodeIdFor(leaf_node);
@@ -1752,79 +3127,1735 @@ namespace bplustree {
         }
 
     private:
-        std::string MakeNodeIdFor(BaseNode *node) {
-            std::string node_prefix = "Node_";
-            std::stringstream out;
-            out << node_prefix << reinterpret_cast<std::uintptr_t>(node);
-            return out.str();
+        /**
+         * Optimistic reads are enabled only when a torn read of a key or a
+         * value cannot crash the reader. The torn read is discarded later
+         * when the node version fails to validate.
+         */
+        static constexpr bool kOptimisticReads =
+                std::is_trivially_copyable_v<KeyType> && std::is_trivially_copyable_v<ValueType>;
+
+        static constexpr bool kTriviallyDestructibleElements =
+                std::is_trivially_destructible_v<KeyType> && std::is_trivially_destructible_v<ValueType>;
+
+        // Bounds the number of restarts when writers keep changing the
+        // nodes on the path, before falling back to latch crabbing.
+        static constexpr int kMaxOptimisticAttempts = 8;
+
+        /**
+         * The leaf node reached by an optimistic descent, and the versions
+         * which have to be validated before trusting what was read.
+         */
+        struct OptimisticPath {
+            BaseNode *leaf_{nullptr};
+            uint64_t leaf_version_{0};
+
+            // `nullptr` when the leaf node is also the root node, and the
+            // version then belongs to the root latch
+            BaseNode *parent_{nullptr};
+            uint64_t parent_version_{0};
+        };
+
+        bool ValidateOptimisticParent(const OptimisticPath &path) const {
+            if (path.parent_ == nullptr) {
+                return root_latch_.ValidateOptimisticRead(path.parent_version_);
+            }
+            return path.parent_->ValidateOptimisticRead(path.parent_version_);
         }
 
-        std::string WrapInDoubleQuotes(std::string s) {
-            std::string dq = "\"";
-            std::stringstream out;
-            out << dq << s << dq;
-            return out.str();
+        /**
+         * Optimistic lock coupling
+         * ------------------------
+         *
+         * Descends from the root to a leaf node without writing to any
+         * latch. It is the optimistic counterpart of latch crabbing. For
+         * every inner node, we read the node version, read the child node
+         * pointer and validate the version. The child node pointer can only
+         * be followed once the validation succeeds. We then read the version
+         * of the child node, and validate the parent version once again.
+         * This makes sure the child node was still linked to the parent when
+         * its version was read. Any later change to the child node will bump
+         * its version, because writers modify a node only while holding an
+         * exclusive latch on it.
+         *
+         * Must be called between `BPLUSTREE_TSAN_IGNORE_READS_BEGIN` and
+         * `BPLUSTREE_TSAN_IGNORE_READS_END`, and is only safe to use when
+         * nodes removed from the B+Tree are not freed while a reader could
+         * still be holding a pointer to them.
+         *
+         * @param select_child returns the child node to descend into from
+         * the given inner node
+         * @param path is set to the leaf node and the versions to validate
+         * @return false if a version failed to validate, and the descent has
+         * to be restarted. Returns true with `path.leaf_` set to `nullptr`
+         * if the B+Tree is empty.
+         */
+        template<typename ChildSelector>
+        bool TryOptimisticDescent(const ChildSelector &select_child, OptimisticPath &path) {
+            uint64_t root_latch_version;
+            if (!root_latch_.TryOptimisticRead(root_latch_version)) { return false; }
+
+            BaseNode *current = root_;
+            if (current == nullptr) {
+                path = OptimisticPath{};
+                return root_latch_.ValidateOptimisticRead(root_latch_version);
+            }
+
+            uint64_t current_version;
+            if (!current->TryOptimisticRead(current_version)) { return false; }
+            if (!root_latch_.ValidateOptimisticRead(root_latch_version)) { return false; }
+
+            BaseNode *parent = nullptr;
+            uint64_t parent_version = root_latch_version;
+
+            while (current->GetType() != NodeType::LeafType) {
+                BaseNode *child = select_child(static_cast<InnerNodeType *>(current));
+                if (!current->ValidateOptimisticRead(current_version)) { return false; }
+
+                uint64_t child_version;
+                if (!child->TryOptimisticRead(child_version)) { return false; }
+                if (!current->ValidateOptimisticRead(current_version)) { return false; }
+
+                parent = current;
+                parent_version = current_version;
+                current = child;
+                current_version = child_version;
+            }
+
+            path = OptimisticPath{current, current_version, parent, parent_version};
+            return true;
         }
 
-        std::string ToHTMLTable(ElasticNode<KeyNodePointerPair> *inner_node) {
-            std::stringstream table;
-            auto colspan = std::to_string(inner_node->GetCurrentSize() + 1);
+        /**
+         * @param result set to the value of the key when the lookup succeeds
+         * @return false if the lookup has to be retried
+         */
+        bool TryOptimisticMaybeGet(const KeyType &key, std::optional<ValueType> &result) {
+            OptimisticPath path;
+            EpochManager::Guard epoch_guard{epoch_manager_};
+
+            BPLUSTREE_TSAN_IGNORE_READS_BEGIN();
+            bool success = TryOptimisticDescent([&key](InnerNodeType *node) {
+                return node->FindPivot(key)->second;
+            }, path);
+
+            if (success && path.leaf_ != nullptr) {
+                auto node = static_cast<LeafNodeType *>(path.leaf_);
+                auto iter = node->FindLocation(key);
+
+                result = (iter == node->End() || !KeyCmpEqual(key, iter->first))
+                         ? std::nullopt
+                         : std::optional<ValueType>{iter->second};
+                success = node->ValidateOptimisticRead(path.leaf_version_);
+            } else {
+                result = std::nullopt;
+            }
+            BPLUSTREE_TSAN_IGNORE_READS_END();
 
-            table << "<table cellspacing=" << WrapInDoubleQuotes("2");
-            table << " cellborder=" << WrapInDoubleQuotes("2");
-            table << " border=" << WrapInDoubleQuotes("0");
-            table << ">" << std::endl;
+            return success;
+        }
 
-            table << "<tr>" << "<td colspan=" << WrapInDoubleQuotes(colspan) << ">"
-                  << "count: " << inner_node->GetCurrentSize()
-                  << "</td></tr>" << std::endl;
+        // No. of lookups of a `MultiGet` which descend the B+Tree together.
+        // Enough to keep the outstanding cache misses of a core busy.
+        static constexpr size_t kMultiGetGroupSize = 16;
 
-            table << "<tr>" << std::endl;
-            table << "<td port=" << WrapInDoubleQuotes("low_key") << ">low key:" << inner_node->GetLowKeyPair().first
-                  << "</td>" << std::endl;
-            for (int i = 0; i < inner_node->GetCurrentSize(); ++i) {
-                table << "<td port=" << WrapInDoubleQuotes("key_" + std::to_string(i)) << ">"
-                      << inner_node->At(i).first
-                      << "</td>" << std::endl;
+        void PrefetchNode(BaseNode *node) {
+            // The type of the node is not known without reading it
+            static_cast<InnerNodeType *>(node)->PrefetchForSearch(inner_node_max_size_);
+            static_cast<LeafNodeType *>(node)->PrefetchForSearch(leaf_node_max_size_);
+        }
+
+        /**
+         * Looks up at most `kMultiGetGroupSize` keys together, using
+         * optimistic lock coupling. Every lookup follows the protocol of
+         * `TryOptimisticDescent`.
+         */
+        void MultiGetGroup(const KeyType *keys, size_t count, std::optional<ValueType> *values) {
+            // The node each lookup has reached, and its version. A lookup
+            // which failed to validate is retried after the group finishes.
+            BaseNode *nodes[kMultiGetGroupSize];
+            uint64_t versions[kMultiGetGroupSize];
+            BaseNode *children[kMultiGetGroupSize];
+            bool failed[kMultiGetGroupSize];
+
+            {
+                EpochManager::Guard epoch_guard{epoch_manager_};
+                BPLUSTREE_TSAN_IGNORE_READS_BEGIN();
+
+                uint64_t root_latch_version;
+                bool root_valid = root_latch_.TryOptimisticRead(root_latch_version);
+                BaseNode *root = root_;
+
+                uint64_t root_version = 0;
+                if (root_valid && root != nullptr) {
+                    root_valid = root->TryOptimisticRead(root_version);
+                }
+                root_valid = root_valid && root_latch_.ValidateOptimisticRead(root_latch_version);
+
+                for (size_t i = 0; i < count; ++i) {
+                    nodes[i] = root;
+                    versions[i] = root_version;
+                    failed[i] = !root_valid;
+                    if (root_valid && root == nullptr) {
+                        values[i] = std::nullopt;
+                    }
+                }
+
+                bool descending = root_valid && root != nullptr;
+                while (descending) {
+                    descending = false;
+
+                    // Find the child node of every lookup, and prefetch it
+                    for (size_t i = 0; i < count; ++i) {
+                        children[i] = nullptr;
+                        if (failed[i] || nodes[i]->GetType() == NodeType::LeafType) { continue; }
+
+                        auto child = static_cast<InnerNodeType *>(nodes[i])->FindPivot(keys[i])->second;
+                        if (!nodes[i]->ValidateOptimisticRead(versions[i])) {
+                            failed[i] = true;
+                            continue;
+                        }
+
+                        PrefetchNode(child);
+                        children[i] = child;
+                    }
+
+                    // Move every lookup down to its child node
+                    for (size_t i = 0; i < count; ++i) {
+                        if (children[i] == nullptr) { continue; }
+
+                        uint64_t child_version;
+                        if (!children[i]->TryOptimisticRead(child_version) ||
+                            !nodes[i]->ValidateOptimisticRead(versions[i])) {
+                            failed[i] = true;
+                            continue;
+                        }
+
+                        nodes[i] = children[i];
+                        versions[i] = child_version;
+                        descending = true;
+                    }
+                }
+
+                for (size_t i = 0; i < count; ++i) {
+                    if (failed[i] || nodes[i] == nullptr) { continue; }
+
+                    auto node = static_cast<LeafNodeType *>(nodes[i]);
+                    auto iter = node->FindLocation(keys[i]);
+                    values[i] = (iter == node->End() || !KeyCmpEqual(keys[i], iter->first))
+                                ? std::nullopt
+                                : std::optional<ValueType>{iter->second};
+                    failed[i] = !node->ValidateOptimisticRead(versions[i]);
+                }
+
+                BPLUSTREE_TSAN_IGNORE_READS_END();
             }
-            table << "</tr>" << std::endl;
 
-            table << "</table>" << std::endl;
+            for (size_t i = 0; i < count; ++i) {
+                if (failed[i]) {
+                    values[i] = MaybeGet(keys[i]);
+                }
+            }
+        }
 
-            return table.str();
+#ifdef BPLUSTREE_COROUTINES
+
+        /**
+         * A single lookup of `InterleavedGet`, which suspends after
+         * prefetching every node it visits below the root node. It follows
+         * the protocol of `TryOptimisticDescent`.
+         *
+         * Has to run inside an epoch guard, and between
+         * `BPLUSTREE_TSAN_IGNORE_READS_BEGIN` and
+         * `BPLUSTREE_TSAN_IGNORE_READS_END`.
+         *
+         * @param succeeded set to false if a version failed to validate, and
+         * the lookup has to be retried
+         */
+        CoroutineTask OptimisticLookup(const KeyType &key, std::optional<ValueType> &result, char &succeeded) {
+            succeeded = false;
+
+            uint64_t root_latch_version;
+            if (!root_latch_.TryOptimisticRead(root_latch_version)) { co_return; }
+
+            BaseNode *current = root_;
+            if (current == nullptr) {
+                result = std::nullopt;
+                succeeded = root_latch_.ValidateOptimisticRead(root_latch_version);
+                co_return;
+            }
+
+            uint64_t current_version;
+            if (!current->TryOptimisticRead(current_version)) { co_return; }
+            if (!root_latch_.ValidateOptimisticRead(root_latch_version)) { co_return; }
+
+            while (current->GetType() != NodeType::LeafType) {
+                BaseNode *child = static_cast<InnerNodeType *>(current)->FindPivot(key)->second;
+                if (!current->ValidateOptimisticRead(current_version)) { co_return; }
+
+                PrefetchNode(child);
+                co_await std::suspend_always{};
+
+                uint64_t child_version;
+                if (!child->TryOptimisticRead(child_version)) { co_return; }
+                if (!current->ValidateOptimisticRead(current_version)) { co_return; }
+
+                current = child;
+                current_version = child_version;
+            }
+
+            auto node = static_cast<LeafNodeType *>(current);
+            auto iter = node->FindLocation(key);
+            result = (iter == node->End() || !KeyCmpEqual(key, iter->first))
+                     ? std::nullopt
+                     : std::optional<ValueType>{iter->second};
+            succeeded = node->ValidateOptimisticRead(current_version);
         }
 
-        std::string ToHTMLTable(ElasticNode<KeyValuePair> *leaf_node) {
-            std::stringstream table;
-            auto colspan = std::to_string(leaf_node->GetCurrentSize());
+#endif /* BPLUSTREE_COROUTINES */
 
-            table << "<table cellspacing=" << WrapInDoubleQuotes("2");
-            table << " cellborder=" << WrapInDoubleQuotes("2");
-            table << " border=" << WrapInDoubleQuotes("0");
-            table << ">" << std::endl;
+        /**
+         * Descends to a leaf node and acquires a shared latch on it.
+         *
+         * The inner nodes are traversed using optimistic lock coupling. Only
+         * the shared latch on the leaf node is actually acquired. The parent
+         * version is validated after that, to make sure the leaf node was
+         * not removed from the B+Tree before it could be latched. After
+         * repeated failures we fall back to latch crabbing.
+         *
+         * @param select_child returns the child node to descend into from
+         * the given inner node
+         * @return The leaf node latched in shared mode, or `nullptr` if the
+         * B+Tree is empty.
+         */
+        template<typename ChildSelector>
+        BaseNode *FindLeafNodeShared(const ChildSelector &select_child) {
+            if constexpr (kOptimisticReads) {
+                for (int attempt = 0; attempt < kMaxOptimisticAttempts; ++attempt) {
+                    OptimisticPath path;
+
+                    // Also protects the leaf node from being freed while it is
+                    // latched, until the parent version is validated
+                    EpochManager::Guard epoch_guard{epoch_manager_};
+
+                    BPLUSTREE_TSAN_IGNORE_READS_BEGIN();
+                    bool success = TryOptimisticDescent(select_child, path);
+                    BPLUSTREE_TSAN_IGNORE_READS_END();
+
+                    if (!success) { continue; }
+                    if (path.leaf_ == nullptr) { return nullptr; }
+
+                    path.leaf_->GetNodeSharedLatch();
+                    if (ValidateOptimisticParent(path)) {
+                        return path.leaf_;
+                    }
+                    path.leaf_->ReleaseNodeSharedLatch();
+                }
+            }
 
-            table << "<tr>" << "<td colspan=" << WrapInDoubleQuotes(colspan) << ">"
-                  << "count: " << leaf_node->GetCurrentSize()
-                  << "</td></tr>" << std::endl;
+            root_latch_.LockShared();
+            if (root_ == nullptr) {
+                root_latch_.UnlockShared();
+                return nullptr;
+            }
 
-            table << "<tr>" << std::endl;
-            for (int i = 0; i < leaf_node->GetCurrentSize(); ++i) {
-                table << "<td port=" << WrapInDoubleQuotes("key_" + std::to_string(i)) << ">"
-                      << leaf_node->At(i).first
-                      << "</td>" << std::endl;
+            BaseNode *current = root_;
+            BaseNode *parent = nullptr;
+
+            current->GetNodeSharedLatch();
+            root_latch_.UnlockShared();
+
+            while (current->GetType() != NodeType::LeafType) {
+                parent = current;
+                current = select_child(static_cast<InnerNodeType *>(current));
+
+                current->GetNodeSharedLatch();
+                parent->ReleaseNodeSharedLatch();
             }
-            table << "</tr>" << std::endl;
 
-            table << "</table>" << std::endl;
+            return current;
+        }
 
-            return table.str();
+        /**
+         * Positions an iterator at the first element with a key greater
+         * than `key`, or also equal to it when `inclusive`.
+         *
+         * When the element is not in the leaf node reached by the descent,
+         * it is the first element of a right sibling. Moving right waits for
+         * no latch, like the iterator, and the descent is restarted when a
+         * right sibling is latched by a writer.
+         */
+        BPlusTreeIterator SeekForward(const KeyType &key, bool inclusive) {
+            while (true) {
+                auto leaf = static_cast<LeafNodeType *>(FindLeafNodeShared([&key](InnerNodeType *node) {
+                    return node->FindPivot(key)->second;
+                }));
+                if (leaf == nullptr) { return End(); }
+
+                auto iter = leaf->FindLocation(key);
+                if (!inclusive && iter != leaf->End() && KeyCmpEqual(iter->first, key)) {
+                    ++iter;
+                }
+
+                while (iter == leaf->End()) {
+                    auto sibling = static_cast<LeafNodeType *>(leaf->GetSiblingRight());
+                    if (sibling == nullptr) {
+                        leaf->ReleaseNodeSharedLatch();
+                        return End();
+                    }
+
+                    if (!sibling->TrySharedLock()) { break; }
+                    leaf->ReleaseNodeSharedLatch();
+
+                    leaf = sibling;
+                    iter = leaf->Begin();
+                }
+
+                if (iter != leaf->End()) {
+                    return BPlusTreeIterator(this, leaf, iter);
+                }
+
+                leaf->ReleaseNodeSharedLatch();
+                std::this_thread::yield();
+            }
         }
 
-    private:
-        BaseNode *root_;
-        SharedLatch root_latch_;
-        int inner_node_max_size_;
-        int leaf_node_max_size_;
+        /**
+         * Positions an iterator at the last element with a key less than
+         * `key`, or also equal to it when `inclusive`. The mirror image of
+         * `SeekForward`, moving left.
+         */
+        BPlusTreeIterator SeekBackward(const KeyType &key, bool inclusive) {
+            while (true) {
+                auto leaf = static_cast<LeafNodeType *>(FindLeafNodeShared([&key](InnerNodeType *node) {
+                    return node->FindPivot(key)->second;
+                }));
+                if (leaf == nullptr) { return REnd(); }
+
+                auto iter = leaf->FindLocation(key);
+                if (inclusive && iter != leaf->End() && KeyCmpEqual(iter->first, key)) {
+                    return BPlusTreeIterator(this, leaf, iter);
+                }
+
+                while (iter == leaf->Begin()) {
+                    auto sibling = static_cast<LeafNodeType *>(leaf->GetSiblingLeft());
+                    if (sibling == nullptr) {
+                        leaf->ReleaseNodeSharedLatch();
+                        return REnd();
+                    }
+
+                    if (!sibling->TrySharedLock()) { break; }
+                    leaf->ReleaseNodeSharedLatch();
+
+                    leaf = sibling;
+                    iter = leaf->End();
+                }
+
+                if (iter != leaf->Begin()) {
+                    return BPlusTreeIterator(this, leaf, std::prev(iter));
+                }
+
+                leaf->ReleaseNodeSharedLatch();
+                std::this_thread::yield();
+            }
+        }
+
+        void CountReseek(bool forward) {
+            CountOperation(forward ? OperationCounter::ForwardReseeks : OperationCounter::BackwardReseeks);
+        }
+
+        void CountOperation(OperationCounter counter) { operation_counters_.Increment(counter); }
+
+        /**
+         * Visits the elements with keys in `[lo, hi]`, or `[lo, hi)` when
+         * `hi` is not inclusive. See `Scan`.
+         */
+        template<typename Visitor>
+        size_t ScanPart(const KeyType &lo, const KeyType &hi, bool hi_inclusive, Visitor &&visitor) {
+            // Reuses the buffer of the previous scan in this thread. A scan
+            // started by the visitor gets an empty buffer of its own.
+            std::vector<KeyValuePair> buffer;
+            buffer.swap(ScanBuffer());
+
+            size_t visited = 0;
+            std::optional<KeyType> last_key;
+            bool done = hi_inclusive ? KeyCmpLess(hi, lo) : !KeyCmpLess(lo, hi);
+            while (!done) {
+                buffer.clear();
+                done = CopyRangeBatch(lo, hi, hi_inclusive, last_key, kScanBatchSize, [&buffer](auto first, size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        buffer.emplace_back(first[i]);
+                    }
+                });
+
+                for (auto &element: buffer) {
+                    ++visited;
+                    if constexpr (std::is_same_v<std::invoke_result_t<Visitor &, const KeyType &, const ValueType &>, bool>) {
+                        if (!visitor(std::as_const(element.first), std::as_const(element.second))) {
+                            done = true;
+                            break;
+                        }
+                    } else {
+                        visitor(std::as_const(element.first), std::as_const(element.second));
+                    }
+                }
+
+                if (buffer.empty()) {
+                    // Waiting for a writer to release the right sibling
+                    std::this_thread::yield();
+                } else {
+                    last_key = std::move(buffer.back().first);
+                }
+            }
+
+            buffer.clear();
+            ScanBuffer().swap(buffer);
+            return visited;
+        }
+
+        // A scan copies at least this many elements, unless it reaches the
+        // end of the range, before releasing the latch and visiting them
+        static constexpr size_t kScanBatchSize = 512;
+
+        static std::vector<KeyValuePair> &ScanBuffer() {
+            thread_local std::vector<KeyValuePair> buffer;
+            return buffer;
+        }
+
+        /**
+         * Copies the next batch of elements of a range, starting after
+         * `last_key`, or from `lo` when nothing was copied yet. Moves right
+         * through the leaf nodes by latch crabbing. Stops once `min_count`
+         * elements were copied, or at a right sibling which cannot be
+         * latched without waiting.
+         *
+         * @param hi_inclusive whether the range includes `hi`
+         * @param copy_run called as `copy_run(first, count)` for the run of
+         * elements in the range found in each leaf node, while its latch is
+         * held
+         * @return true if the copy reached the end of the range, or the end
+         * of the B+Tree
+         */
+        template<typename RunCopier>
+        bool CopyRangeBatch(const KeyType &lo, const KeyType &hi, bool hi_inclusive,
+                            const std::optional<KeyType> &last_key, size_t min_count, RunCopier &&copy_run) {
+            const KeyType &start = last_key.has_value() ? *last_key : lo;
+            auto leaf = static_cast<LeafNodeType *>(FindLeafNodeShared([&start](InnerNodeType *node) {
+                return node->FindPivot(start)->second;
+            }));
+            if (leaf == nullptr) { return true; }
+
+            auto iter = leaf->FindLocation(start);
+            if (last_key.has_value() && iter != leaf->End() && KeyCmpEqual(iter->first, start)) {
+                ++iter;
+            }
+
+            auto in_range = [&hi, hi_inclusive](const KeyType &key) {
+                return hi_inclusive ? !KeyCmpLess(hi, key) : KeyCmpLess(key, hi);
+            };
+
+            size_t copied = 0;
+            while (true) {
+                // Only the last leaf node of the range has to be searched
+                // for the end of the run
+                auto end = leaf->End();
+                bool range_ends = leaf->GetCurrentSize() > 0 && !in_range(leaf->RBegin()->first);
+                if (range_ends) {
+                    end = leaf->FindLocation(hi);
+                    if (hi_inclusive && end != leaf->End() && KeyCmpEqual(end->first, hi)) {
+                        ++end;
+                    }
+                }
+
+                if (iter < end) {
+                    copy_run(iter, static_cast<size_t>(end - iter));
+                    copied += end - iter;
+                }
+
+                auto sibling = static_cast<LeafNodeType *>(leaf->GetSiblingRight());
+                if (range_ends || sibling == nullptr) {
+                    leaf->ReleaseNodeSharedLatch();
+                    return true;
+                }
+
+                if (copied >= min_count || !sibling->TrySharedLock()) {
+                    leaf->ReleaseNodeSharedLatch();
+                    return false;
+                }
+                leaf->ReleaseNodeSharedLatch();
+
+                leaf = sibling;
+                iter = leaf->Begin();
+            }
+        }
+
+        /**
+         * Appends the elements with keys in `[lo, hi]`, or `[lo, hi)` when
+         * `hi` is not inclusive, to `keys` and `values`.
+         */
+        void ExportPart(const KeyType &lo, const KeyType &hi, bool hi_inclusive,
+                        std::vector<KeyType> &keys, std::vector<ValueType> &values) {
+            std::optional<KeyType> last_key;
+            bool done = false;
+            while (!done) {
+                auto size = keys.size();
+                done = CopyRangeBatch(lo, hi, hi_inclusive, last_key, std::numeric_limits<size_t>::max(),
+                                      [&keys, &values](auto first, size_t count) {
+                                          keys.insert(keys.end(), first.Key(), first.Key() + count);
+                                          values.insert(values.end(), first.Payload(), first.Payload() + count);
+                                      });
+
+                if (keys.size() == size) {
+                    // Waiting for a writer to release the right sibling
+                    std::this_thread::yield();
+                } else {
+                    last_key = keys.back();
+                }
+            }
+        }
+
+        /**
+         * Picks at most `parts - 1` increasing keys in `(lo, hi]` which
+         * split the range into parts of a similar no. of nodes.
+         *
+         * The keys are separators of the inner nodes. Levels of inner nodes
+         * are read from the root down, holding shared latches on the nodes
+         * of a level which overlap the range, until a level has enough
+         * separators in the range or the next level is the leaf level.
+         */
+        std::vector<KeyType> PartitionRange(const KeyType &lo, const KeyType &hi, int parts) {
+            std::vector<KeyType> separators;
+            if (parts <= 1) { return separators; }
+
+            root_latch_.LockShared();
+            if (root_ == nullptr) {
+                root_latch_.UnlockShared();
+                return separators;
+            }
+            std::vector<BaseNode *> level{root_};
+            root_->GetNodeSharedLatch();
+            root_latch_.UnlockShared();
+
+            while (level.front()->GetType() == NodeType::InnerType) {
+                std::vector<KeyType> candidates;
+                std::vector<BaseNode *> children;
+                for (auto node: level) {
+                    auto inner = static_cast<InnerNodeType *>(node);
+                    children.push_back(inner->FindPivot(lo)->second);
+                    for (auto iter = inner->Begin(); iter != inner->End(); ++iter) {
+                        if (KeyCmpLess(lo, iter->first) && !KeyCmpLess(hi, iter->first)) {
+                            candidates.push_back(iter->first);
+                            children.push_back(iter->second);
+                        }
+                    }
+                }
+                separators = std::move(candidates);
+
+                if (separators.size() + 1 >= static_cast<size_t>(parts) ||
+                    children.front()->GetType() == NodeType::LeafType) {
+                    break;
+                }
+
+                for (auto child: children) {
+                    child->GetNodeSharedLatch();
+                }
+                for (auto node: level) {
+                    node->ReleaseNodeSharedLatch();
+                }
+                level = std::move(children);
+            }
+
+            for (auto node: level) {
+                node->ReleaseNodeSharedLatch();
+            }
+
+            // Spread the parts evenly over the separators
+            if (separators.size() + 1 > static_cast<size_t>(parts)) {
+                std::vector<KeyType> picked;
+                for (int part = 1; part < parts; ++part) {
+                    picked.push_back(separators[part * (separators.size() + 1) / parts - 1]);
+                }
+                separators = std::move(picked);
+            }
+            return separators;
+        }
+
+        /**
+         * Removes a node which was unlinked from the B+Tree.
+         *
+         * An optimistic reader may still hold a pointer to the node, so it
+         * cannot be freed immediately. It is freed by the epoch manager once
+         * all the readers which could have reached it are done.
+         */
+        void RetireNode(BaseNode *node) {
+            if constexpr (kLatchStats) {
+                std::lock_guard<std::mutex> guard{removed_latch_counts_mutex_};
+                removed_latch_counts_.Add(node->GetLatchCounts());
+            }
+
+            epoch_manager_.Retire(node, [](void *retired_node) {
+                FreeNode(static_cast<BaseNode *>(retired_node));
+            });
+        }
+
+        static void FreeNode(BaseNode *node) {
+            if (node->GetType() == NodeType::LeafType) {
+                static_cast<LeafNodeType *>(node)->FreeElasticNode();
+            } else {
+                static_cast<InnerNodeType *>(node)->FreeElasticNode();
+            }
+        }
+
+        /**
+         * The no. of elements below child pointer `child` of an inner node,
+         * with `Augmentation::OrderStatistics`. Stored as the summary of the
+         * child pointer.
+         */
+        static std::atomic<uint64_t> &SubtreeSize(InnerNodeType *node, int child) {
+            static_assert(std::atomic<uint64_t>::is_always_lock_free, "Counts are updated in place");
+            return *reinterpret_cast<std::atomic<uint64_t> *>(node->Summary(child));
+        }
+
+        static BaseNode *ChildAt(InnerNodeType *node, int child) {
+            return child == 0 ? node->GetLowKeyPair().second : node->At(child - 1).second;
+        }
+
+        /**
+         * @return index of the child pointer `FindPivot` returned, where the
+         * low key pair is at index 0
+         */
+        static int ChildIndex(InnerNodeType *node, typename InnerNodeType::ElementIterator pivot) {
+            if (pivot.Key() == &node->GetLowKeyPair().first) { return 0; }
+            return static_cast<int>(std::distance(node->Begin(), pivot)) + 1;
+        }
+
+        /**
+         * @return no. of elements below `node`, from the counts of its child
+         * pointers
+         */
+        static uint64_t CountElements(BaseNode *node) {
+            if (node->GetType() == NodeType::LeafType) {
+                return static_cast<LeafNodeType *>(node)->GetCurrentSize();
+            }
+
+            auto inner = static_cast<InnerNodeType *>(node);
+            uint64_t count = 0;
+            for (int child = 0; child <= inner->GetCurrentSize(); ++child) {
+                count += SubtreeSize(inner, child).load(std::memory_order_relaxed);
+            }
+            return count;
+        }
+
+        /**
+         * The summary of child pointer `child` of an inner node, with
+         * `Augmentation::Aggregates`. Its count is what `SubtreeSize` reads.
+         */
+        static AtomicRangeAggregate<ValueType> &AggregateOf(InnerNodeType *node, int child) {
+            static_assert(offsetof(AtomicRangeAggregate<ValueType>, count_) == 0, "Counts are read by SubtreeSize");
+            return *reinterpret_cast<AtomicRangeAggregate<ValueType> *>(node->Summary(child));
+        }
+
+        /**
+         * @return the values below `node` folded together, from the
+         * summaries of its child pointers
+         */
+        static RangeAggregateType AggregateElements(BaseNode *node) {
+            RangeAggregateType aggregate;
+            if (node->GetType() == NodeType::LeafType) {
+                auto leaf = static_cast<LeafNodeType *>(node);
+                for (auto iter = leaf->Begin(); iter != leaf->End(); ++iter) {
+                    aggregate.Add(iter->second);
+                }
+                return aggregate;
+            }
+
+            auto inner = static_cast<InnerNodeType *>(node);
+            for (int child = 0; child <= inner->GetCurrentSize(); ++child) {
+                aggregate.Add(AggregateOf(inner, child).Load());
+            }
+            return aggregate;
+        }
+
+        /**
+         * Recomputes the summary of child pointer `child` of an inner node
+         * from the child, whose own summaries are up to date.
+         */
+        void SummarizeChild(InnerNodeType *node, int child) {
+            if constexpr (std::is_arithmetic_v<ValueType>) {
+                if (augmentation_ == Augmentation::Aggregates) {
+                    AggregateOf(node, child).Store(AggregateElements(ChildAt(node, child)));
+                    return;
+                }
+            }
+            SubtreeSize(node, child).store(CountElements(ChildAt(node, child)), std::memory_order_relaxed);
+        }
+
+        /**
+         * Ends the latch on the parent of the node a descent in shared mode
+         * just latched, or the root latch when that node is the root. With
+         * an augmentation the parent stays latched and is added to `path`,
+         * until `AddToSummaries` has updated its summaries.
+         */
+        void ReleaseParentSharedLatch(BaseNode *parent, std::vector<BaseNode *> &path) {
+            if (parent == nullptr) {
+                root_latch_.UnlockShared();
+            } else if (summary_size_ > 0) {
+                path.push_back(parent);
+            } else {
+                parent->ReleaseNodeSharedLatch();
+            }
+        }
+
+        void ReleaseAllSharedLatches(std::vector<BaseNode *> &latches) {
+            while (!latches.empty()) {
+                latches.back()->ReleaseNodeSharedLatch();
+                latches.pop_back();
+            }
+        }
+
+        /**
+         * Releases the exclusive latches on the ancestors of a safe node
+         * during a pessimistic descent. With an augmentation the ancestors
+         * stay latched and are moved to `path`, until `AddToSummaries`
+         * has updated their summaries.
+         *
+         * @return true if the root latch is still held in exclusive mode
+         */
+        bool ReleaseSafeAncestors(std::vector<BaseNode *> &latches, bool holds_root_latch,
+                                  std::vector<BaseNode *> &path) {
+            if (summary_size_ == 0) {
+                return ReleaseAllWriteLatches(latches, holds_root_latch);
+            }
+
+            path.insert(path.end(), latches.begin(), latches.end());
+            latches.clear();
+
+            if (holds_root_latch) {
+                root_latch_.UnlockExclusive();
+            }
+            return false;
+        }
+
+        /**
+         * Adds an element inserted into or removed from the leaf node of
+         * `key` to the summaries of the child pointers in `path` on the path
+         * to `key`, or before a pessimistic write moves it.
+         *
+         * Every writer keeps the inner nodes on its path latched until it
+         * has updated their summaries. Nodes split, borrow and merge only
+         * while they and their parent are latched in exclusive mode, so no
+         * writer is below them and the summaries of the child pointers which
+         * move are exact. Writers which share the latch on a node update the
+         * same summaries, so they are updated atomically.
+         *
+         * A removed value which is the minimum or maximum of a summary is
+         * only taken out by recomputing the summary, from the leaf level up.
+         * That needs `path` to be latched in exclusive mode, so a delete in
+         * shared mode checks `IsInsideSummaries` first.
+         *
+         * @param delta 1 or -1 with `Augmentation::Aggregates`, or the no. of
+         * elements inserted or removed with `Augmentation::OrderStatistics`
+         * @param changed_value the value inserted or removed, only used with
+         * `Augmentation::Aggregates`
+         */
+        void AddToSummaries(const std::vector<BaseNode *> &path, const KeyType &key, int64_t delta,
+                            const ValueType *changed_value) {
+            if (summary_size_ == 0) { return; }
+
+            for (auto node = path.rbegin(); node != path.rend(); ++node) {
+                auto inner = static_cast<InnerNodeType *>(*node);
+                auto child = ChildIndex(inner, inner->FindPivot(key));
+
+                if (augmentation_ == Augmentation::OrderStatistics) {
+                    SubtreeSize(inner, child).fetch_add(static_cast<uint64_t>(delta), std::memory_order_relaxed);
+                    continue;
+                }
+                if constexpr (std::is_arithmetic_v<ValueType>) {
+                    auto &aggregate = AggregateOf(inner, child);
+                    if (delta > 0) {
+                        aggregate.Add(*changed_value);
+                    } else if (aggregate.IsInside(*changed_value)) {
+                        aggregate.Remove(*changed_value);
+                    } else {
+                        SummarizeChild(inner, child);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @return true if removing `value` from the leaf node of `key`
+         * changes no minimum or maximum of the summaries in `path`. Always
+         * true without `Augmentation::Aggregates`.
+         */
+        bool IsInsideSummaries(const std::vector<BaseNode *> &path, const KeyType &key, const ValueType &value) {
+            if constexpr (std::is_arithmetic_v<ValueType>) {
+                if (augmentation_ != Augmentation::Aggregates) { return true; }
+
+                for (auto node: path) {
+                    auto inner = static_cast<InnerNodeType *>(node);
+                    if (!AggregateOf(inner, ChildIndex(inner, inner->FindPivot(key))).IsInside(value)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Recomputes the summary of `child` after a split, borrow or merge
+         * moved elements into or out of it, while the inner node holding its
+         * child pointer is latched in exclusive mode. The child pointer is in
+         * `node`, or in `split` which was split off from it.
+         */
+        void RefreshSummaryOf(InnerNodeType *node, InnerNodeType *split, BaseNode *child) {
+            if (summary_size_ == 0) { return; }
+
+            for (auto inner: {node, split}) {
+                if (inner == nullptr) { continue; }
+
+                for (int i = 0; i <= inner->GetCurrentSize(); ++i) {
+                    if (ChildAt(inner, i) == child) {
+                        SummarizeChild(inner, i);
+                        return;
+                    }
+                }
+            }
+        }
+
+        /**
+         * Summarizes every child pointer of an inner node which was built
+         * from its children, after the children are summarized.
+         */
+        void SummarizeChildren(InnerNodeType *node) {
+            if (summary_size_ == 0) { return; }
+
+            for (int child = 0; child <= node->GetCurrentSize(); ++child) {
+                SummarizeChild(node, child);
+            }
+        }
+
+        /**
+         * @return no. of elements with keys less than `key`, or also equal
+         * to it when `inclusive`. Adds up the counts of the child pointers
+         * left of the path to `key`, and the elements before `key` in its
+         * leaf node. The nodes are latched in shared mode from the root
+         * down, so that no split, borrow or merge moves child pointers
+         * while their counts are read.
+         */
+        size_t CountLess(const KeyType &key, bool inclusive) {
+            BaseNode *node = LatchRootNodeShared();
+            if (node == nullptr) { return 0; }
+
+            size_t count = 0;
+            while (node->GetType() != NodeType::LeafType) {
+                auto inner = static_cast<InnerNodeType *>(node);
+                auto pivot = inner->FindPivot(key);
+                for (int child = 0, last = ChildIndex(inner, pivot); child < last; ++child) {
+                    count += SubtreeSize(inner, child).load(std::memory_order_relaxed);
+                }
+                node = pivot->second;
+                node->GetNodeSharedLatch();
+                inner->ReleaseNodeSharedLatch();
+            }
+
+            auto leaf = static_cast<LeafNodeType *>(node);
+            auto iter = leaf->FindLocation(key);
+            count += std::distance(leaf->Begin(), iter);
+            if (inclusive && iter != leaf->End() && KeyCmpEqual(key, iter->first)) {
+                count += 1;
+            }
+            leaf->ReleaseNodeSharedLatch();
+
+            return count;
+        }
+
+        /**
+         * Descends to the `k`-th element by the counts of the child pointers,
+         * latching the nodes in shared mode from the root down.
+         *
+         * Writers sharing the latch on an inner node update its counts after
+         * they changed a leaf node below it, so the counts read on the way
+         * down can be ahead of the leaf node by the elements removed since.
+         * The element is then in a right sibling. Moving right waits for no
+         * latch, like the iterator, and fails when a right sibling is latched
+         * by a writer. A count is added to the path from the root down, so
+         * the count of a child pointer can also be ahead of the counts inside
+         * the child, and the descent then moves into the last child.
+         *
+         * @return false when the descent has to be restarted
+         */
+        bool TrySelect(size_t k, std::optional<KeyValuePair> &result) {
+            result = std::nullopt;
+
+            BaseNode *node = LatchRootNodeShared();
+            if (node == nullptr) { return true; }
+
+            while (node->GetType() != NodeType::LeafType) {
+                auto inner = static_cast<InnerNodeType *>(node);
+                int child = 0;
+                for (; child < inner->GetCurrentSize(); ++child) {
+                    auto count = SubtreeSize(inner, child).load(std::memory_order_relaxed);
+                    if (k < count) { break; }
+                    k -= count;
+                }
+                node = ChildAt(inner, child);
+                node->GetNodeSharedLatch();
+                inner->ReleaseNodeSharedLatch();
+            }
+
+            auto leaf = static_cast<LeafNodeType *>(node);
+            while (k >= static_cast<size_t>(leaf->GetCurrentSize())) {
+                k -= leaf->GetCurrentSize();
+
+                auto sibling = static_cast<LeafNodeType *>(leaf->GetSiblingRight());
+                if (sibling != nullptr && !sibling->TrySharedLock()) {
+                    leaf->ReleaseNodeSharedLatch();
+                    return false;
+                }
+                leaf->ReleaseNodeSharedLatch();
+
+                if (sibling == nullptr) { return true; }
+                leaf = sibling;
+            }
+
+            auto element = leaf->At(static_cast<int>(k));
+            result = KeyValuePair{element.first, element.second};
+            leaf->ReleaseNodeSharedLatch();
+
+            return true;
+        }
+
+        /**
+         * Folds the values of the elements with keys in `[lo, hi]` below
+         * `node` into `result`, with `Augmentation::Aggregates`. A child
+         * pointer whose subtree lies between the paths to `lo` and `hi` adds
+         * its summary, and only the children on the paths are visited.
+         * `node` is latched in shared mode, and each child is latched before
+         * it is visited, so that no split, borrow or merge moves elements
+         * between the summaries which were added and the child.
+         *
+         * @param check_lo false when every key below `node` is at least `lo`
+         * @param check_hi false when every key below `node` is at most `hi`
+         */
+        void AggregateBelow(BaseNode *node, const KeyType &lo, const KeyType &hi, bool check_lo, bool check_hi,
+                            RangeAggregateType &result) {
+            if (node->GetType() == NodeType::LeafType) {
+                auto leaf = static_cast<LeafNodeType *>(node);
+                auto iter = check_lo ? leaf->FindLocation(lo) : leaf->Begin();
+                for (; iter != leaf->End() && !(check_hi && KeyCmpLess(hi, iter->first)); ++iter) {
+                    result.Add(iter->second);
+                }
+                return;
+            }
+
+            auto inner = static_cast<InnerNodeType *>(node);
+            auto first = check_lo ? ChildIndex(inner, inner->FindPivot(lo)) : 0;
+            auto last = check_hi ? ChildIndex(inner, inner->FindPivot(hi)) : inner->GetCurrentSize();
+            for (auto child = first; child <= last; ++child) {
+                auto child_check_lo = check_lo && child == first;
+                auto child_check_hi = check_hi && child == last;
+                if (child_check_lo || child_check_hi) {
+                    auto child_node = ChildAt(inner, child);
+                    child_node->GetNodeSharedLatch();
+                    AggregateBelow(child_node, lo, hi, child_check_lo, child_check_hi, result);
+                    child_node->ReleaseNodeSharedLatch();
+                } else {
+                    result.Add(AggregateOf(inner, child).Load());
+                }
+            }
+        }
+
+        /**
+         * The nodes of one level which stay latched during a range delete,
+         * from left to right, with the lowest key which can be found below
+         * each of them. These are the nodes which contain `lo` and `hi`, and
+         * the nearest node on either side of them. For a level of inner
+         * nodes, `children_` holds the child pointers of these nodes in
+         * order. The children in `[first_child_, last_child_]` are either
+         * latched on the level below, or inside the range.
+         */
+        struct RangeLevel {
+            std::vector<KeyNodePointerPair> nodes_;
+            std::vector<KeyNodePointerPair> children_;
+            size_t first_child_{0};
+            size_t last_child_{0};
+        };
+
+        /**
+         * Latches the edges of `[lo, hi]` level by level, while holding the
+         * root latch in exclusive mode.
+         *
+         * A node inside the range is only reachable from its parent, which
+         * is also latched or inside the range, and from its sibling leaf
+         * nodes. So it is latched only long enough to wait for the readers
+         * and writers already in it, and then added to `drained`. While the
+         * next leaf node inside the range is latched, the left sibling of
+         * the current one is changed to the leaf node containing `lo`. This
+         * way an iterator moving left cannot step back into a drained leaf
+         * node.
+         *
+         * @return the levels, starting from the root
+         */
+        std::vector<RangeLevel> LatchRangeLevels(const KeyType &lo, const KeyType &hi,
+                                                 std::vector<BaseNode *> &drained) {
+            std::vector<RangeLevel> levels(1);
+
+            root_->GetNodeExclusiveLatch();
+            auto root_low_key = root_->GetType() == NodeType::LeafType
+                                ? static_cast<LeafNodeType *>(root_)->GetLowKeyPair().first
+                                : static_cast<InnerNodeType *>(root_)->GetLowKeyPair().first;
+            levels.back().nodes_.emplace_back(root_low_key, root_);
+
+            // Children of the inner nodes inside the range, on the level
+            // which was latched last
+            std::vector<BaseNode *> inside_children;
+
+            while (levels.back().nodes_.front().second->GetType() != NodeType::LeafType) {
+                auto &level = levels.back();
+                for (auto &[low_key, node]: level.nodes_) {
+                    auto inner = static_cast<InnerNodeType *>(node);
+                    level.children_.emplace_back(low_key, inner->GetLowKeyPair().second);
+                    for (auto element = inner->Begin(); element != inner->End(); ++element) {
+                        level.children_.emplace_back(element->first, element->second);
+                    }
+                }
+
+                // The first child is left of the range or contains `lo`, so
+                // its low key is not compared
+                auto find_child = [&children = level.children_](const KeyType &key) {
+                    auto next = std::upper_bound(std::next(children.begin()), children.end(), key,
+                                                 [](const KeyType &k, const KeyNodePointerPair &child) {
+                                                     return KeyCmpLess(k, child.first);
+                                                 });
+                    return static_cast<size_t>(std::distance(children.begin(), next) - 1);
+                };
+                auto first = find_child(lo);
+                auto last = find_child(hi);
+                level.first_child_ = first > 0 ? first - 1 : first;
+                level.last_child_ = std::min(last + 1, level.children_.size() - 1);
+
+                RangeLevel below;
+                for (auto i = level.first_child_; i <= first; ++i) {
+                    below.nodes_.push_back(level.children_[i]);
+                    below.nodes_.back().second->GetNodeExclusiveLatch();
+                }
+
+                auto lo_child = level.children_[first].second;
+                if (lo_child->GetType() == NodeType::LeafType) {
+                    if (last > first) {
+                        DrainLeavesBetween(static_cast<LeafNodeType *>(lo_child), level.children_[last].second,
+                                           drained);
+                        below.nodes_.push_back(level.children_[last]);
+                    }
+                } else {
+                    for (auto i = first + 1; i < last; ++i) {
+                        inside_children.push_back(level.children_[i].second);
+                    }
+
+                    std::vector<BaseNode *> inside_below;
+                    for (auto node: inside_children) {
+                        auto inner = static_cast<InnerNodeType *>(node);
+                        inner->GetNodeExclusiveLatch();
+                        inside_below.push_back(inner->GetLowKeyPair().second);
+                        for (auto element = inner->Begin(); element != inner->End(); ++element) {
+                            inside_below.push_back(element->second);
+                        }
+                        inner->ReleaseNodeExclusiveLatch();
+                        drained.push_back(inner);
+                    }
+                    inside_children = std::move(inside_below);
+
+                    if (last > first) {
+                        below.nodes_.push_back(level.children_[last]);
+                        below.nodes_.back().second->GetNodeExclusiveLatch();
+                    }
+                }
+
+                if (level.last_child_ > last) {
+                    below.nodes_.push_back(level.children_[level.last_child_]);
+                    below.nodes_.back().second->GetNodeExclusiveLatch();
+                }
+
+                levels.push_back(std::move(below));
+            }
+
+            return levels;
+        }
+
+        /**
+         * Drains the leaf nodes between `lo_leaf` and `hi_leaf` from left to
+         * right, holding the latches on at most two of them at a time. The
+         * latch on `lo_leaf` is held, and `hi_leaf` is latched last.
+         */
+        void DrainLeavesBetween(LeafNodeType *lo_leaf, BaseNode *hi_leaf, std::vector<BaseNode *> &drained) {
+            LeafNodeType *previous = nullptr;
+            auto leaf = static_cast<LeafNodeType *>(lo_leaf->GetSiblingRight());
+
+            while (true) {
+                leaf->GetNodeExclusiveLatch();
+                if (previous != nullptr) {
+                    previous->ReleaseNodeExclusiveLatch();
+                }
+                if (leaf == hi_leaf) { break; }
+
+                leaf->SetSiblingLeft(lo_leaf);
+                drained.push_back(leaf);
+
+                previous = leaf;
+                leaf = static_cast<LeafNodeType *>(leaf->GetSiblingRight());
+            }
+        }
+
+        /**
+         * @return the elements of the leaf node with keys in `[lo, hi]`
+         */
+        static std::pair<typename LeafNodeType::ElementIterator, typename LeafNodeType::ElementIterator>
+        FindRangeInLeaf(LeafNodeType *leaf, const KeyType &lo, const KeyType &hi) {
+            auto first = leaf->FindLocation(lo);
+            auto last = leaf->FindLocation(hi);
+            if (last != leaf->End() && KeyCmpEqual(last->first, hi)) {
+                ++last;
+            }
+            return std::make_pair(first, last);
+        }
+
+        /**
+         * Removes the elements in `[lo, hi]` from the latched leaf nodes, and
+         * spreads the remaining elements evenly across as few of them as
+         * needed. The leaf nodes which are left empty are unlinked from their
+         * siblings, and added to `retired`.
+         *
+         * @return the lowest key and the pointer of each remaining leaf node
+         */
+        std::vector<KeyNodePointerPair> RebuildLeafLevel(const KeyType &lo, const KeyType &hi,
+                                                         const std::vector<KeyNodePointerPair> &leaves,
+                                                         std::vector<BaseNode *> &retired) {
+            std::vector<KeyValuePair> elements;
+            for (auto &entry: leaves) {
+                auto leaf = static_cast<LeafNodeType *>(entry.second);
+                auto [first, last] = FindRangeInLeaf(leaf, lo, hi);
+
+                for (auto element = leaf->Begin(); element != leaf->End(); ++element) {
+                    if (element == first) { element = last; }
+                    if (element == leaf->End()) { break; }
+                    elements.emplace_back(std::move(*element.Key()), std::move(*element.Payload()));
+                }
+                leaf->DeleteElements(leaf->Begin(), leaf->End());
+            }
+
+            auto leaf_sizes = SplitEvenly(elements.size(), leaf_node_max_size_,
+                                          FastCeilIntDivision(leaf_node_max_size_, 2), leaf_node_max_size_);
+
+            std::vector<KeyNodePointerPair> rebuilt;
+            auto element = elements.begin();
+            for (size_t i = 0; i < leaf_sizes.size(); ++i) {
+                auto leaf = static_cast<LeafNodeType *>(leaves[i].second);
+                leaf->SetLowKeyPair(std::make_pair(element->first, nullptr));
+                rebuilt.emplace_back(element->first, leaf);
+
+                for (int j = 0; j < leaf_sizes[i]; ++j, ++element) {
+                    leaf->InsertElementIfPossible(*element, leaf->End());
+                }
+            }
+
+            for (size_t i = leaf_sizes.size(); i < leaves.size(); ++i) {
+                retired.push_back(leaves[i].second);
+            }
+
+            // Only the right sibling of the last latched leaf node is not
+            // latched yet. It is right of every latched leaf node, so it is
+            // latched last.
+            auto last_leaf = static_cast<LeafNodeType *>(leaves.back().second);
+            auto sibling_right = static_cast<LeafNodeType *>(last_leaf->GetSiblingRight());
+            for (size_t i = 0; i + 1 < rebuilt.size(); ++i) {
+                static_cast<LeafNodeType *>(rebuilt[i].second)->SetSiblingRight(rebuilt[i + 1].second);
+                static_cast<LeafNodeType *>(rebuilt[i + 1].second)->SetSiblingLeft(rebuilt[i].second);
+            }
+            if (!rebuilt.empty()) {
+                static_cast<LeafNodeType *>(rebuilt.back().second)->SetSiblingRight(sibling_right);
+            }
+            if (sibling_right != nullptr) {
+                BPLUSTREE_ASSERT(!rebuilt.empty(), "The nearest leaf node on each side is latched");
+
+                sibling_right->GetNodeExclusiveLatch();
+                sibling_right->SetSiblingLeft(rebuilt.back().second);
+                sibling_right->ReleaseNodeExclusiveLatch();
+            }
+
+            return rebuilt;
+        }
+
+        /**
+         * Replaces the latched children of the latched inner nodes with the
+         * `rebuilt` nodes of the level below, and spreads the child pointers
+         * evenly across as few of the inner nodes as needed. The inner nodes
+         * which are not needed anymore are added to `retired`.
+         *
+         * @return the lowest key and the pointer of each remaining inner node
+         */
+        std::vector<KeyNodePointerPair> RebuildInnerLevel(const RangeLevel &level,
+                                                          const std::vector<KeyNodePointerPair> &rebuilt_below,
+                                                          std::vector<BaseNode *> &retired) {
+            std::vector<KeyNodePointerPair> children{level.children_.begin(),
+                                                     level.children_.begin() + level.first_child_};
+            children.insert(children.end(), rebuilt_below.begin(), rebuilt_below.end());
+            children.insert(children.end(), level.children_.begin() + level.last_child_ + 1, level.children_.end());
+
+            int max_children = inner_node_max_size_ + 1;
+            auto inner_sizes = SplitEvenly(children.size(), max_children, FastCeilIntDivision(max_children, 2),
+                                           max_children);
+
+            std::vector<KeyNodePointerPair> rebuilt;
+            auto child = children.begin();
+            for (size_t i = 0; i < inner_sizes.size(); ++i) {
+                auto inner = static_cast<InnerNodeType *>(level.nodes_[i].second);
+                inner->DeleteElements(inner->Begin(), inner->End());
+                inner->SetLowKeyPair(*child);
+                rebuilt.emplace_back(child->first, inner);
+                ++child;
+
+                for (int j = 1; j < inner_sizes[i]; ++j, ++child) {
+                    inner->InsertElementIfPossible(*child, inner->End());
+                }
+                SummarizeChildren(inner);
+            }
+
+            for (size_t i = inner_sizes.size(); i < level.nodes_.size(); ++i) {
+                retired.push_back(level.nodes_[i].second);
+            }
+
+            return rebuilt;
+        }
+
+        // A thread builds at least this many nodes of a level when a bulk
+        // load is parallel. Smaller levels are built by fewer threads.
+        static constexpr size_t kMinBulkLoadNodesPerThread = 64;
+
+        template<typename Iterator>
+        bool BulkLoadWithThreads(Iterator first, Iterator last, double fill_factor, int num_threads) {
+            BPLUSTREE_ASSERT(fill_factor > 0.0 && fill_factor <= 1.0, "Fill factor is in the range (0, 1]");
+
+            root_latch_.LockExclusive();
+            if (root_ != nullptr) {
+                root_latch_.UnlockExclusive();
+                return false;
+            }
+
+            auto leaf_sizes = SplitEvenly(std::distance(first, last), leaf_node_max_size_ * fill_factor,
+                                          FastCeilIntDivision(leaf_node_max_size_, 2), leaf_node_max_size_);
+
+            std::vector<KeyNodePointerPair> level;
+            if (!BuildLeafLevel(first, leaf_sizes, num_threads, level)) {
+                for (auto &entry: level) {
+                    FreeNode(entry.second);
+                }
+                root_latch_.UnlockExclusive();
+                return false;
+            }
+
+            while (level.size() > 1) {
+                level = BuildInnerLevel(level, fill_factor, num_threads);
+            }
+
+            root_ = level.empty() ? nullptr : level.front().second;
+            root_latch_.UnlockExclusive();
+            return true;
+        }
+
+        /**
+         * Divides `count` elements into the fewest nodes which hold close
+         * to `target` elements each, and spreads the elements evenly across
+         * those nodes.
+         *
+         * @return the no. of elements in each node, every one of them in the
+         * range [min, max] unless all the elements fit in a single node
+         */
+        static std::vector<int> SplitEvenly(size_t count, double target, int min, int max) {
+            if (count == 0) { return {}; }
+
+            auto target_size = std::clamp(static_cast<int>(target), min, max);
+            auto node_count = (count + target_size - 1) / target_size;
+            node_count = std::min(node_count, std::max<size_t>(1, count / min));
+
+            std::vector<int> sizes(node_count, static_cast<int>(count / node_count));
+            for (size_t i = 0; i < count % node_count; ++i) {
+                sizes[i] += 1;
+            }
+
+            BPLUSTREE_ASSERT(sizes.front() <= max, "Node does not overflow");
+            return sizes;
+        }
+
+        /**
+         * Divides the nodes of a level into contiguous slices, one for each
+         * thread which builds the level.
+         *
+         * @return the index of the first node in every slice, followed by
+         * the no. of nodes in the level
+         */
+        static std::vector<size_t> SliceLevel(size_t node_count, int num_threads) {
+            auto slice_count = std::min<size_t>(num_threads, std::max<size_t>(1, node_count / kMinBulkLoadNodesPerThread));
+
+            std::vector<size_t> bounds;
+            for (size_t i = 0; i <= slice_count; ++i) {
+                bounds.push_back(node_count * i / slice_count);
+            }
+            return bounds;
+        }
+
+        /**
+         * Calls `run(slice)` for every slice, each in its own thread. The
+         * first slice is run by the calling thread.
+         */
+        template<typename Function>
+        static void RunSlices(size_t slice_count, Function run) {
+            std::vector<std::thread> threads;
+            for (size_t slice = 1; slice < slice_count; ++slice) {
+                threads.emplace_back(run, slice);
+            }
+            run(0);
+
+            for (auto &thread: threads) {
+                thread.join();
+            }
+        }
+
+        /**
+         * Fills a leaf node for every entry in `leaf_sizes`, and appends
+         * the lowest key and the pointer of each leaf node to `level`.
+         *
+         * @return false if the keys are not strictly increasing. The leaf
+         * nodes created so far are left in `level`.
+         */
+        template<typename Iterator>
+        bool BuildLeafLevel(Iterator first, const std::vector<int> &leaf_sizes, int num_threads,
+                            std::vector<KeyNodePointerPair> &level) {
+            auto bounds = SliceLevel(leaf_sizes.size(), num_threads);
+            auto slice_count = bounds.size() - 1;
+
+            if (slice_count == 1) {
+                level.reserve(leaf_sizes.size());
+                return BuildLeafNodes(first, leaf_sizes.begin(), leaf_sizes.end(), level);
+            }
+
+            // Offset of the first element of each slice in the input
+            std::vector<size_t> offsets{0};
+            for (size_t slice = 0; slice < slice_count; ++slice) {
+                offsets.push_back(offsets.back() + std::accumulate(leaf_sizes.begin() + bounds[slice],
+                                                                   leaf_sizes.begin() + bounds[slice + 1],
+                                                                   size_t{0}));
+            }
+
+            std::vector<std::vector<KeyNodePointerPair>> slice_levels(slice_count);
+            std::unique_ptr<bool[]> slice_built{new bool[slice_count]};
+            RunSlices(slice_count, [&](size_t slice) {
+                slice_levels[slice].reserve(bounds[slice + 1] - bounds[slice]);
+                slice_built[slice] = BuildLeafNodes(std::next(first, offsets[slice]),
+                                                    leaf_sizes.begin() + bounds[slice],
+                                                    leaf_sizes.begin() + bounds[slice + 1],
+                                                    slice_levels[slice]);
+            });
+
+            // Stitch the neighbouring slices together at their edges
+            bool built = std::all_of(slice_built.get(), slice_built.get() + slice_count, [](bool b) { return b; });
+            level.reserve(leaf_sizes.size());
+            for (size_t slice = 0; slice < slice_count; ++slice) {
+                if (built && slice > 0) {
+                    auto left = static_cast<LeafNodeType *>(level.back().second);
+                    auto right = static_cast<LeafNodeType *>(slice_levels[slice].front().second);
+
+                    built = KeyCmpLess(left->RBegin()->first, right->Begin()->first);
+                    left->SetSiblingRight(right);
+                    right->SetSiblingLeft(left);
+                }
+                level.insert(level.end(), slice_levels[slice].begin(), slice_levels[slice].end());
+            }
+
+            return built;
+        }
+
+        /**
+         * Fills the leaf nodes of a single slice, and links them to their
+         * siblings within the slice.
+         */
+        template<typename Iterator>
+        bool BuildLeafNodes(Iterator first, std::vector<int>::const_iterator sizes_begin,
+                            std::vector<int>::const_iterator sizes_end, std::vector<KeyNodePointerPair> &level) {
+            ElasticNode<KeyType, KeyValuePair> *previous = nullptr;
+
+            for (auto leaf_size = sizes_begin; leaf_size != sizes_end; ++leaf_size) {
+                const KeyValuePair &lowest = *first;
+                if (previous != nullptr && !KeyCmpLess(previous->RBegin()->first, lowest.first)) {
+                    return false;
+                }
+
+                auto leaf = ElasticNode<KeyType, KeyValuePair>::Get(NodeType::LeafType,
+                                                                    std::make_pair(lowest.first, nullptr),
+                                                                    leaf_node_max_size_, allocator_.get());
+                level.emplace_back(lowest.first, leaf);
+
+                for (int i = 0; i < *leaf_size; ++i, ++first) {
+                    const KeyValuePair &element = *first;
+                    if (i > 0 && !KeyCmpLess(leaf->RBegin()->first, element.first)) {
+                        return false;
+                    }
+                    leaf->InsertElementIfPossible(element, leaf->End());
+                }
+
+                if (previous != nullptr) {
+                    previous->SetSiblingRight(leaf);
+                    leaf->SetSiblingLeft(previous);
+                }
+                previous = leaf;
+            }
+
+            return true;
+        }
+
+        /**
+         * Builds the level of inner nodes above `children`. The first child
+         * of an inner node becomes its low key pair.
+         *
+         * @return the lowest key and the pointer of each new inner node
+         */
+        std::vector<KeyNodePointerPair> BuildInnerLevel(const std::vector<KeyNodePointerPair> &children,
+                                                        double fill_factor, int num_threads) {
+            int max_children = inner_node_max_size_ + 1;
+            auto inner_sizes = SplitEvenly(children.size(), max_children * fill_factor,
+                                           FastCeilIntDivision(max_children, 2), max_children);
+
+            auto bounds = SliceLevel(inner_sizes.size(), num_threads);
+            auto slice_count = bounds.size() - 1;
+
+            // Index of the first child of each slice
+            std::vector<size_t> offsets{0};
+            for (size_t slice = 0; slice < slice_count; ++slice) {
+                offsets.push_back(offsets.back() + std::accumulate(inner_sizes.begin() + bounds[slice],
+                                                                   inner_sizes.begin() + bounds[slice + 1],
+                                                                   size_t{0}));
+            }
+
+            std::vector<std::vector<KeyNodePointerPair>> slice_levels(slice_count);
+            RunSlices(slice_count, [&](size_t slice) {
+                slice_levels[slice].reserve(bounds[slice + 1] - bounds[slice]);
+
+                auto child = std::next(children.begin(), offsets[slice]);
+                for (auto i = bounds[slice]; i < bounds[slice + 1]; ++i) {
+                    auto inner = ElasticNode<KeyType, KeyNodePointerPair>::Get(NodeType::InnerType, *child,
+                                                                               inner_node_max_size_,
+                                                                               allocator_.get(), summary_size_);
+                    slice_levels[slice].emplace_back(child->first, inner);
+                    ++child;
+
+                    for (int j = 1; j < inner_sizes[i]; ++j, ++child) {
+                        inner->InsertElementIfPossible(*child, inner->End());
+                    }
+                    SummarizeChildren(static_cast<InnerNodeType *>(inner));
+                }
+            });
+
+            if (slice_count == 1) {
+                return std::move(slice_levels.front());
+            }
+
+            std::vector<KeyNodePointerPair> level;
+            level.reserve(inner_sizes.size());
+            for (auto &slice_level: slice_levels) {
+                level.insert(level.end(), slice_level.begin(), slice_level.end());
+            }
+            return level;
+        }
+
+        /**
+         * Descends to the leaf node for the first element, and inserts the
+         * elements which belong to the same leaf node until the first one
+         * which does not.
+         *
+         * @return the first element which was not inserted
+         */
+        template<typename ForwardIterator>
+        ForwardIterator InsertIntoSameLeaf(ForwardIterator first, ForwardIterator last, std::vector<bool> &inserted) {
+            const KeyValuePair &element = *first;
+
+            root_latch_.LockShared();
+            if (root_ == nullptr) {
+                root_latch_.UnlockShared();
+                inserted.push_back(Insert(element));
+                return std::next(first);
+            }
+
+            // Keys in the leaf node are in the range [lower, upper). No bound
+            // is known at the edges of the B+Tree.
+            std::optional<KeyType> lower;
+            std::optional<KeyType> upper;
+
+            BaseNode *current_node = root_;
+            BaseNode *parent_node = nullptr;
+            // Inner nodes kept latched until their summaries are updated
+            std::vector<BaseNode *> summary_path{};
+
+            current_node->GetNodeSharedLatch();
+            while (current_node->GetType() != NodeType::LeafType) {
+                ReleaseParentSharedLatch(parent_node, summary_path);
+
+                // Same child as `FindPivot`. `next` is the first separator
+                // key greater than the search key.
+                auto inner_node = static_cast<InnerNodeType *>(current_node);
+                auto next = inner_node->FindLocation(element.first);
+                if (next != inner_node->End() && !KeyCmpLess(element.first, next->first)) {
+                    next = std::next(next);
+                }
+                if (next != inner_node->Begin()) {
+                    lower = std::prev(next)->first;
+                }
+                if (next != inner_node->End()) {
+                    upper = next->first;
+                }
+
+                parent_node = current_node;
+                current_node = (next == inner_node->Begin())
+                               ? inner_node->GetLowKeyPair().second
+                               : std::prev(next)->second;
+                current_node->GetNodeSharedLatch();
+            }
+
+            current_node->ReleaseNodeSharedLatch();
+            current_node->GetNodeExclusiveLatch();
+            ReleaseParentSharedLatch(parent_node, summary_path);
+
+            auto node = static_cast<LeafNodeType *>(current_node);
+            for (; first != last; ++first) {
+                const KeyValuePair &current = *first;
+                if ((lower.has_value() && KeyCmpLess(current.first, *lower)) ||
+                    (upper.has_value() && !KeyCmpLess(current.first, *upper))) {
+                    break;
+                }
+
+                auto iter = node->FindLocation(current.first);
+                if (iter != node->End() && KeyCmpEqual(current.first, iter->first)) { // Duplicate insertion
+                    inserted.push_back(false);
+                    continue;
+                }
+
+                if (!node->InsertElementIfPossible(current, iter)) {
+                    // The leaf node is full, and has to split
+                    ReleaseAllSharedLatches(summary_path);
+                    node->ReleaseNodeExclusiveLatch();
+                    inserted.push_back(Insert(current));
+                    return std::next(first);
+                }
+                AddToSummaries(summary_path, element.first, 1, &current.second);
+                inserted.push_back(true);
+            }
+
+            ReleaseAllSharedLatches(summary_path);
+            node->ReleaseNodeExclusiveLatch();
+            return first;
+        }
+
+        static int GetNodeCurrentSize(BaseNode *node) {
+            if (node->GetType() == NodeType::LeafType) {
+                return static_cast<LeafNodeType *>(node)->GetCurrentSize();
+            }
+            return static_cast<InnerNodeType *>(node)->GetCurrentSize();
+        }
+
+        static bool KeyCmpLess(const KeyType &a, const KeyType &b) { return KeyComparator{}(a, b); }
+
+        static bool KeyCmpEqual(const KeyType &a, const KeyType &b) { return !KeyCmpLess(a, b) && !KeyCmpLess(b, a); }
+
+        std::string MakeNodeIdFor(BaseNode *node) {
+            std::string node_prefix = "Node_";
+            std::stringstream out;
+            out << node_prefix << reinterpret_cast<std::uintptr_t>(node);
+            return out.str();
+        }
+
+        std::string WrapInDoubleQuotes(std::string s) {
+            std::string dq = "\"";
+            std::stringstream out;
+            out << dq << s << dq;
+            return out.str();
+        }
+
+        std::string ToHTMLTable(ElasticNode<KeyType, KeyNodePointerPair> *inner_node) {
+            std::stringstream table;
+            auto colspan = std::to_string(inner_node->GetCurrentSize() + 1);
+
+            table << "<table cellspacing=" << WrapInDoubleQuotes("2");
+            table << " cellborder=" << WrapInDoubleQuotes("2");
+            table << " border=" << WrapInDoubleQuotes("0");
+            table << ">" << std::endl;
+
+            table << "<tr>" << "<td colspan=" << WrapInDoubleQuotes(colspan) << ">"
+                  << "count: " << inner_node->GetCurrentSize()
+                  << "</td></tr>" << std::endl;
+
+            table << "<tr>" << std::endl;
+            table << "<td port=" << WrapInDoubleQuotes("low_key") << ">low key:" << inner_node->GetLowKeyPair().first
+                  << "</td>" << std::endl;
+            for (int i = 0; i < inner_node->GetCurrentSize(); ++i) {
+                table << "<td port=" << WrapInDoubleQuotes("key_" + std::to_string(i)) << ">"
+                      << inner_node->At(i).first
+                      << "</td>" << std::endl;
+            }
+            table << "</tr>" << std::endl;
+
+            table << "</table>" << std::endl;
+
+            return table.str();
+        }
+
+        std::string ToHTMLTable(ElasticNode<KeyType, KeyValuePair> *leaf_node) {
+            std::stringstream table;
+            auto colspan = std::to_string(leaf_node->GetCurrentSize());
+
+            table << "<table cellspacing=" << WrapInDoubleQuotes("2");
+            table << " cellborder=" << WrapInDoubleQuotes("2");
+            table << " border=" << WrapInDoubleQuotes("0");
+            table << ">" << std::endl;
+
+            table << "<tr>" << "<td colspan=" << WrapInDoubleQuotes(colspan) << ">"
+                  << "count: " << leaf_node->GetCurrentSize()
+                  << "</td></tr>" << std::endl;
+
+            table << "<tr>" << std::endl;
+            for (int i = 0; i < leaf_node->GetCurrentSize(); ++i) {
+                table << "<td port=" << WrapInDoubleQuotes("key_" + std::to_string(i)) << ">"
+                      << leaf_node->At(i).first
+                      << "</td>" << std::endl;
+            }
+            table << "</tr>" << std::endl;
+
+            table << "</table>" << std::endl;
+
+            return table.str();
+        }
+
+    private:
+        BaseNode *root_;
+        VersionedLatch root_latch_;
+        int inner_node_max_size_;
+        int leaf_node_max_size_;
+
+        // Declared before the epoch manager, so that it outlives the nodes
+        // which are still retired when the B+Tree is destroyed
+        std::unique_ptr<NodeAllocator> allocator_;
+        EpochManager epoch_manager_;
+
+        OperationCounters operation_counters_;
+
+        // The latch counts of the nodes which were retired, so that
+        // GetLatchStats keeps them after the nodes are gone
+        std::mutex removed_latch_counts_mutex_;
+        LatchCounts removed_latch_counts_;
+
+        Augmentation augmentation_{Augmentation::None};
+
+        // No. of bytes of the summary of each child pointer in an inner
+        // node, or zero without augmentation
+        int summary_size_{0};
     };
 
 }
@@ -0,0 +1,131 @@
+#ifndef BTREE_COROUTINE_TASK_H
+#define BTREE_COROUTINE_TASK_H
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#define BPLUSTREE_COROUTINES
+
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Coroutine Tasks
+ * ---------------
+ *
+ * A lookup which suspends itself right after prefetching the next node it
+ * is going to read. While the cache line is on its way, the scheduler
+ * resumes the other lookups it is interleaving. By the time the scheduler
+ * comes back around, the node is likely in the cache.
+ *
+ * A task starts suspended, runs until its next suspension point on every
+ * `Resume`, and is done when the coroutine returns. The task owns the
+ * coroutine frame, and destroys it.
+ *
+ * Only available when compiled as C++20 or later.
+ */
+namespace bplustree {
+
+    class CoroutineTask {
+    public:
+        struct promise_type {
+            CoroutineTask get_return_object() {
+                return CoroutineTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            void return_void() {}
+
+            void unhandled_exception() { throw; }
+
+            // A lookup allocates a frame of the same size every time, so
+            // freed frames are kept around to be reused by this thread
+            static void *operator new(size_t size) { return FrameCache().Allocate(size); }
+
+            static void operator delete(void *frame, size_t size) { FrameCache().Free(frame, size); }
+        };
+
+        CoroutineTask() = default;
+
+        ~CoroutineTask() {
+            if (handle_) { handle_.destroy(); }
+        }
+
+        CoroutineTask(const CoroutineTask &) = delete;
+
+        CoroutineTask &operator=(const CoroutineTask &) = delete;
+
+        CoroutineTask(CoroutineTask &&other) noexcept: handle_{std::exchange(other.handle_, nullptr)} {}
+
+        CoroutineTask &operator=(CoroutineTask &&other) noexcept {
+            if (this != &other) {
+                if (handle_) { handle_.destroy(); }
+                handle_ = std::exchange(other.handle_, nullptr);
+            }
+            return *this;
+        }
+
+        /**
+         * @return true while the task has not started, or is suspended
+         * before its end
+         */
+        bool Pending() const { return handle_ && !handle_.done(); }
+
+        void Resume() { handle_.resume(); }
+
+    private:
+        explicit CoroutineTask(std::coroutine_handle<promise_type> handle) : handle_{handle} {}
+
+        /**
+         * Frames of a single size, freed by this thread
+         */
+        class FrameList {
+        public:
+            ~FrameList() {
+                for (auto frame: frames_) {
+                    ::operator delete(frame);
+                }
+            }
+
+            void *Allocate(size_t size) {
+                if (size == frame_size_ && !frames_.empty()) {
+                    auto frame = frames_.back();
+                    frames_.pop_back();
+                    return frame;
+                }
+                return ::operator new(size);
+            }
+
+            void Free(void *frame, size_t size) {
+                if (frames_.empty()) { frame_size_ = size; }
+
+                if (size == frame_size_ && frames_.size() < kMaxCachedFrames) {
+                    frames_.push_back(frame);
+                } else {
+                    ::operator delete(frame);
+                }
+            }
+
+        private:
+            static constexpr size_t kMaxCachedFrames = 256;
+
+            size_t frame_size_{0};
+            std::vector<void *> frames_;
+        };
+
+        static FrameList &FrameCache() {
+            thread_local FrameList frame_list;
+            return frame_list;
+        }
+
+        std::coroutine_handle<promise_type> handle_{nullptr};
+    };
+}
+
+#endif /* __cpp_impl_coroutine */
+
+#endif //BTREE_COROUTINE_TASK_H
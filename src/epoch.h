@@ -0,0 +1,358 @@
+#ifndef BTREE_EPOCH_H
+#define BTREE_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "macros.h"
+
+/**
+ * Epoch-based memory reclamation
+ * ------------------------------
+ *
+ * A node which is unlinked from the B+Tree cannot be freed immediately if
+ * a reader traversing the tree without latches may still hold a pointer to
+ * it. Such a node is instead retired, tagged with the global epoch at the
+ * time it was retired.
+ *
+ * A reader announces the global epoch it observed before it begins reading
+ * shared nodes, and withdraws the announcement once it is done. A node
+ * retired in epoch `e` is safe to free once every announced epoch is
+ * greater than `e`. The readers which announced a later epoch started only
+ * after the node was unlinked, so they cannot reach it.
+ *
+ * Retired nodes are collected in a per-thread list and reclaimed in
+ * batches, so that a writer does not scan the announced epochs of all
+ * threads every time it unlinks a node.
+ */
+namespace bplustree {
+
+    class EpochManager {
+    public:
+        using Deleter = void (*)(void *);
+
+        EpochManager() : id_{NextManagerId()} {
+            std::lock_guard<std::mutex> guard{RegistryMutex()};
+            LiveManagers().insert(id_);
+        }
+
+        ~EpochManager() {
+            {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                LiveManagers().erase(id_);
+            }
+
+            ReclaimAll();
+
+            auto record = records_.load(std::memory_order_acquire);
+            while (record != nullptr) {
+                auto next = record->next_;
+                delete record;
+                record = next;
+            }
+        }
+
+        EpochManager(const EpochManager &) = delete;
+
+        EpochManager &operator=(const EpochManager &) = delete;
+
+        EpochManager(EpochManager &&) = delete;
+
+        EpochManager &operator=(EpochManager &&) = delete;
+
+        /**
+         * Marks a region in which shared nodes are read without holding a
+         * latch on them. Guards can be nested.
+         */
+        class Guard {
+        public:
+            explicit Guard(EpochManager &manager) : manager_{manager}, record_{manager.Enter()} {}
+
+            ~Guard() { manager_.Exit(record_); }
+
+            Guard(const Guard &) = delete;
+
+            Guard &operator=(const Guard &) = delete;
+
+        private:
+            EpochManager &manager_;
+            void *record_;
+        };
+
+        /**
+         * Registers the calling thread. A thread is also registered
+         * implicitly the first time it enters a guard or retires an object,
+         * so calling this only moves the registration cost out of the first
+         * operation.
+         */
+        void RegisterThread() { LocalRecord(); }
+
+        /**
+         * Unregisters the calling thread. Objects retired by the thread which
+         * cannot be freed yet are handed over to the next thread which
+         * registers. A thread is also unregistered when it exits.
+         *
+         * Must not be called from within a guard.
+         */
+        void UnregisterThread() {
+            auto &entries = LocalEntries().entries_;
+            for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+                if (iter->manager_id_ == id_) {
+                    BPLUSTREE_ASSERT(iter->record_->guard_depth_ == 0, "Thread is not inside a guard");
+
+                    Reclaim(iter->record_);
+                    iter->record_->Release();
+                    entries.erase(iter);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Defers freeing an object until no reader can hold a reference
+         * to it anymore.
+         *
+         * @param object which is already unreachable for new readers
+         * @param deleter frees the object
+         */
+        void Retire(void *object, Deleter deleter) {
+            auto record = LocalRecord();
+            auto epoch = global_epoch_.load(std::memory_order_seq_cst);
+            record->retired_.push_back(RetiredObject{object, deleter, epoch});
+
+            if (record->retired_.size() >= record->reclaim_threshold_) {
+                Reclaim(record);
+            }
+        }
+
+        /**
+         * Frees every retired object irrespective of epochs. Only safe to
+         * call when no other thread is accessing the B+Tree.
+         */
+        void ReclaimAll() {
+            auto record = records_.load(std::memory_order_acquire);
+            while (record != nullptr) {
+                for (auto &retired: record->retired_) {
+                    retired.deleter_(retired.object_);
+                }
+                record->retired_.clear();
+                record->reclaim_threshold_ = kReclaimBatchSize;
+                record = record->next_;
+            }
+        }
+
+    private:
+        static constexpr uint64_t kInactive = std::numeric_limits<uint64_t>::max();
+
+        // Number of retired objects a thread accumulates before it attempts
+        // to reclaim them
+        static constexpr size_t kReclaimBatchSize = 64;
+
+        struct RetiredObject {
+            void *object_;
+            Deleter deleter_;
+            uint64_t epoch_;
+        };
+
+        /**
+         * State of a registered thread. Aligned to a cache line so that
+         * announcing an epoch does not invalidate the line holding the
+         * announcement of another thread.
+         */
+        struct alignas(64) ThreadRecord {
+            std::atomic<uint64_t> local_epoch_{kInactive};
+            std::atomic<bool> in_use_{true};
+
+            // Only accessed by the thread owning this record
+            int guard_depth_{0};
+            size_t reclaim_threshold_{kReclaimBatchSize};
+            std::vector<RetiredObject> retired_;
+
+            // Records are never unlinked until the manager is destroyed
+            ThreadRecord *next_{nullptr};
+
+            bool TryAcquire() {
+                bool expected = false;
+                return in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire);
+            }
+
+            void Release() { in_use_.store(false, std::memory_order_release); }
+        };
+
+        struct ThreadEntry {
+            uint64_t manager_id_;
+            ThreadRecord *record_;
+        };
+
+        /**
+         * The records the calling thread owns, one for every manager it
+         * used. Releases them when the thread exits, unless the manager was
+         * destroyed before that.
+         */
+        struct ThreadEntries {
+            std::vector<ThreadEntry> entries_;
+
+            ~ThreadEntries() {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                for (auto &entry: entries_) {
+                    if (LiveManagers().count(entry.manager_id_) != 0) {
+                        entry.record_->Release();
+                    }
+                }
+            }
+
+            void PruneDestroyedManagers() {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                auto &live_managers = LiveManagers();
+
+                auto end = entries_.begin();
+                for (auto &entry: entries_) {
+                    if (live_managers.count(entry.manager_id_) != 0) {
+                        *end++ = entry;
+                    }
+                }
+                entries_.erase(end, entries_.end());
+            }
+        };
+
+        // Number of entries a thread keeps before it drops the entries of
+        // destroyed managers
+        static constexpr size_t kPruneThreshold = 32;
+
+        static uint64_t NextManagerId() {
+            static std::atomic<uint64_t> next_id{0};
+            return next_id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static std::mutex &RegistryMutex() {
+            static std::mutex registry_mutex;
+            return registry_mutex;
+        }
+
+        static std::unordered_set<uint64_t> &LiveManagers() {
+            static std::unordered_set<uint64_t> live_managers;
+            return live_managers;
+        }
+
+        static ThreadEntries &LocalEntries() {
+            thread_local ThreadEntries local_entries;
+            return local_entries;
+        }
+
+        /**
+         * Orders the announcement of an epoch before the reads which follow
+         * it. TSAN does not model standalone fences and warns about them,
+         * and the racy reads are hidden from TSAN anyway.
+         */
+        static void AnnouncementFence() {
+#ifndef BPLUSTREE_TSAN_ENABLED
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+        }
+
+        ThreadRecord *LocalRecord() {
+            auto &local = LocalEntries();
+            for (auto &entry: local.entries_) {
+                if (entry.manager_id_ == id_) {
+                    return entry.record_;
+                }
+            }
+
+            if (local.entries_.size() >= kPruneThreshold) {
+                local.PruneDestroyedManagers();
+            }
+
+            auto record = AcquireRecord();
+            local.entries_.push_back(ThreadEntry{id_, record});
+            return record;
+        }
+
+        /**
+         * Reuses the record of a thread which unregistered or exited, or
+         * links a new record.
+         */
+        ThreadRecord *AcquireRecord() {
+            auto record = records_.load(std::memory_order_acquire);
+            while (record != nullptr) {
+                if (record->TryAcquire()) {
+                    return record;
+                }
+                record = record->next_;
+            }
+
+            auto new_record = new ThreadRecord{};
+            new_record->next_ = records_.load(std::memory_order_relaxed);
+            while (!records_.compare_exchange_weak(new_record->next_, new_record,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed)) {}
+            return new_record;
+        }
+
+        void *Enter() {
+            auto record = LocalRecord();
+            if (record->guard_depth_++ == 0) {
+                record->local_epoch_.store(global_epoch_.load(std::memory_order_seq_cst),
+                                           std::memory_order_seq_cst);
+                AnnouncementFence();
+            }
+            return record;
+        }
+
+        void Exit(void *opaque_record) {
+            auto record = static_cast<ThreadRecord *>(opaque_record);
+            if (--record->guard_depth_ == 0) {
+                record->local_epoch_.store(kInactive, std::memory_order_release);
+            }
+        }
+
+        uint64_t MinAnnouncedEpoch() const {
+            auto min_epoch = kInactive;
+
+            auto record = records_.load(std::memory_order_acquire);
+            while (record != nullptr) {
+                auto epoch = record->local_epoch_.load(std::memory_order_seq_cst);
+                if (epoch < min_epoch) {
+                    min_epoch = epoch;
+                }
+                record = record->next_;
+            }
+
+            return min_epoch;
+        }
+
+        /**
+         * Advances the global epoch and frees the retired objects of the
+         * calling thread which no reader can reach anymore.
+         */
+        void Reclaim(ThreadRecord *record) {
+            global_epoch_.fetch_add(1, std::memory_order_seq_cst);
+            auto min_epoch = MinAnnouncedEpoch();
+
+            auto &retired = record->retired_;
+            auto end = retired.begin();
+            for (auto &object: retired) {
+                if (object.epoch_ < min_epoch) {
+                    object.deleter_(object.object_);
+                } else {
+                    *end++ = object;
+                }
+            }
+            retired.erase(end, retired.end());
+
+            // A long running reader can hold back reclamation. Wait for
+            // another full batch before trying again.
+            record->reclaim_threshold_ = retired.size() + kReclaimBatchSize;
+        }
+
+        const uint64_t id_;
+        std::atomic<uint64_t> global_epoch_{0};
+        std::atomic<ThreadRecord *> records_{nullptr};
+    };
+
+}
+
+#endif //BTREE_EPOCH_H
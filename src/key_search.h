@@ -0,0 +1,257 @@
+#ifndef BTREE_KEY_SEARCH_H
+#define BTREE_KEY_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BPLUSTREE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+/**
+ * Vectorized Key Search
+ * ---------------------
+ *
+ * Keys in a node are sorted, so the lower bound of a search key is the
+ * number of keys which are less than the search key. Instead of a binary
+ * search which mispredicts a branch at every level, the search key is
+ * compared against several keys at once. The comparison results are turned
+ * into a bitmask, and the set bits are counted. There are no data dependent
+ * branches. `LowerBound` narrows down the range with branch-free halving
+ * before comparing against the last few keys at once.
+ *
+ * The kernels are compiled for AVX2 and SSE4.2 using function attributes,
+ * and the widest kernel supported by the CPU is chosen at runtime. The
+ * scalar kernel is used everywhere else.
+ *
+ * Kernels exist for 32-bit and 64-bit integer keys compared by `std::less`.
+ * Unsigned keys are compared as signed keys after flipping the sign bit.
+ *
+ * Keys do not have to be contiguous. The key at index `i` is read from
+ * `base + i * stride` bytes, so the kernels also search the keys embedded
+ * in an array of key-value pairs.
+ */
+namespace bplustree::key_search {
+
+    enum class SearchKernel { Scalar, SSE42, AVX2 };
+
+    /**
+     * @return true if the keys of type `KeyType` ordered by `KeyComparator`
+     * can be searched by the vectorized kernels.
+     */
+    template<typename KeyType, typename KeyComparator>
+    constexpr bool IsVectorizable() {
+        return std::is_integral_v<KeyType> && !std::is_same_v<KeyType, bool> &&
+               (sizeof(KeyType) == 4 || sizeof(KeyType) == 8) &&
+               (std::is_same_v<KeyComparator, std::less<KeyType>> || std::is_same_v<KeyComparator, std::less<>>);
+    }
+
+    namespace internal {
+
+        template<typename KeyType>
+        using SignedKey = std::conditional_t<sizeof(KeyType) == 4, int32_t, int64_t>;
+
+        template<typename KeyType>
+        constexpr SignedKey<KeyType> kSignFlip = std::is_signed_v<KeyType>
+                                                 ? 0
+                                                 : std::numeric_limits<SignedKey<KeyType>>::min();
+
+        template<typename KeyType>
+        inline SignedKey<KeyType> LoadSigned(const char *base, size_t index, size_t stride) {
+            KeyType key;
+            std::memcpy(&key, base + index * stride, sizeof(KeyType));
+            return static_cast<SignedKey<KeyType>>(key) ^ kSignFlip<KeyType>;
+        }
+
+        template<typename KeyType>
+        inline size_t CountLessScalar(const char *base, size_t count, size_t stride, KeyType key) {
+            auto search_key = static_cast<SignedKey<KeyType>>(key) ^ kSignFlip<KeyType>;
+
+            size_t less = 0;
+            for (size_t i = 0; i < count; ++i) {
+                less += LoadSigned<KeyType>(base, i, stride) < search_key;
+            }
+            return less;
+        }
+
+#ifdef BPLUSTREE_X86_SIMD
+        template<typename KeyType>
+        __attribute__((target("sse4.2,popcnt")))
+        size_t CountLessSSE42(const char *base, size_t count, size_t stride, KeyType key) {
+            auto search_key = static_cast<SignedKey<KeyType>>(key) ^ kSignFlip<KeyType>;
+
+            size_t less = 0;
+            size_t i = 0;
+            if constexpr (sizeof(KeyType) == 4) {
+                __m128i needle = _mm_set1_epi32(search_key);
+                for (; i + 4 <= count; i += 4) {
+                    __m128i keys = _mm_set_epi32(LoadSigned<KeyType>(base, i + 3, stride),
+                                                 LoadSigned<KeyType>(base, i + 2, stride),
+                                                 LoadSigned<KeyType>(base, i + 1, stride),
+                                                 LoadSigned<KeyType>(base, i, stride));
+                    auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, keys)));
+                    less += __builtin_popcount(mask);
+                }
+            } else {
+                __m128i needle = _mm_set1_epi64x(search_key);
+                for (; i + 2 <= count; i += 2) {
+                    __m128i keys = _mm_set_epi64x(LoadSigned<KeyType>(base, i + 1, stride),
+                                                  LoadSigned<KeyType>(base, i, stride));
+                    auto mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, keys)));
+                    less += __builtin_popcount(mask);
+                }
+            }
+
+            return less + CountLessScalar<KeyType>(base + i * stride, count - i, stride, key);
+        }
+
+        template<typename KeyType>
+        __attribute__((target("avx2,popcnt")))
+        size_t CountLessAVX2(const char *base, size_t count, size_t stride, KeyType key) {
+            auto search_key = static_cast<SignedKey<KeyType>>(key) ^ kSignFlip<KeyType>;
+
+            size_t less = 0;
+            size_t i = 0;
+            if constexpr (sizeof(KeyType) == 4) {
+                __m256i needle = _mm256_set1_epi32(search_key);
+                __m256i flip = _mm256_set1_epi32(kSignFlip<KeyType>);
+                if (stride == sizeof(KeyType)) {
+                    for (; i + 8 <= count; i += 8) {
+                        __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(base + i * stride));
+                        keys = _mm256_xor_si256(keys, flip);
+                        auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, keys)));
+                        less += __builtin_popcount(mask);
+                    }
+                } else {
+                    auto s = static_cast<int>(stride);
+                    __m256i offsets = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+                    for (; i + 8 <= count; i += 8) {
+                        __m256i keys = _mm256_i32gather_epi32(reinterpret_cast<const int *>(base + i * stride),
+                                                              offsets, 1);
+                        keys = _mm256_xor_si256(keys, flip);
+                        auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, keys)));
+                        less += __builtin_popcount(mask);
+                    }
+                }
+            } else {
+                __m256i needle = _mm256_set1_epi64x(search_key);
+                __m256i flip = _mm256_set1_epi64x(kSignFlip<KeyType>);
+                if (stride == sizeof(KeyType)) {
+                    for (; i + 4 <= count; i += 4) {
+                        __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(base + i * stride));
+                        keys = _mm256_xor_si256(keys, flip);
+                        auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, keys)));
+                        less += __builtin_popcount(mask);
+                    }
+                } else {
+                    auto s = static_cast<int>(stride);
+                    __m128i offsets = _mm_setr_epi32(0, s, 2 * s, 3 * s);
+                    for (; i + 4 <= count; i += 4) {
+                        __m256i keys = _mm256_i32gather_epi64(reinterpret_cast<const long long *>(base + i * stride),
+                                                              offsets, 1);
+                        keys = _mm256_xor_si256(keys, flip);
+                        auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, keys)));
+                        less += __builtin_popcount(mask);
+                    }
+                }
+            }
+
+            return less + CountLessScalar<KeyType>(base + i * stride, count - i, stride, key);
+        }
+#endif /* BPLUSTREE_X86_SIMD */
+
+        inline SearchKernel DetectSearchKernel() {
+#ifdef BPLUSTREE_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+                return SearchKernel::AVX2;
+            }
+            if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+                return SearchKernel::SSE42;
+            }
+#endif
+            return SearchKernel::Scalar;
+        }
+
+    }
+
+    /**
+     * @return The widest kernel supported by the CPU, detected once.
+     */
+    inline SearchKernel ActiveSearchKernel() {
+        static const SearchKernel kernel = internal::DetectSearchKernel();
+        return kernel;
+    }
+
+    /**
+     * @return true if the CPU can run the kernel
+     */
+    inline bool IsSupported(SearchKernel kernel) {
+        return static_cast<int>(kernel) <= static_cast<int>(ActiveSearchKernel());
+    }
+
+    /**
+     * Counts the keys which are less than the search key, using the given
+     * kernel. The kernel must be supported by the CPU.
+     *
+     * @param base address of the first key
+     * @param count number of keys
+     * @param stride distance in bytes between consecutive keys
+     */
+    template<typename KeyType>
+    size_t CountLess(SearchKernel kernel, const void *base, size_t count, size_t stride, KeyType key) {
+        static_assert(IsVectorizable<KeyType, std::less<KeyType>>(), "32-bit or 64-bit integer keys");
+
+        auto bytes = static_cast<const char *>(base);
+        switch (kernel) {
+#ifdef BPLUSTREE_X86_SIMD
+            case SearchKernel::AVX2:
+                return internal::CountLessAVX2<KeyType>(bytes, count, stride, key);
+            case SearchKernel::SSE42:
+                return internal::CountLessSSE42<KeyType>(bytes, count, stride, key);
+#endif
+            default:
+                return internal::CountLessScalar<KeyType>(bytes, count, stride, key);
+        }
+    }
+
+    /**
+     * Number of keys left to search after which the search switches from
+     * halving the range to comparing against all the remaining keys.
+     */
+    constexpr size_t kSearchWindow = 16;
+
+    /**
+     * Finds the lower bound of the search key among sorted keys, using the
+     * widest kernel supported by the CPU.
+     *
+     * The range is first halved without branches until at most
+     * `kSearchWindow` keys remain, which are compared at once. Comparing
+     * against every key in the node is slower for large fanouts, and when
+     * the keys are not contiguous.
+     *
+     * @return index of the first key which is not less than the search key
+     */
+    template<typename KeyType>
+    size_t LowerBound(const void *base, size_t count, size_t stride, KeyType key) {
+        auto bytes = static_cast<const char *>(base);
+        auto search_key = static_cast<internal::SignedKey<KeyType>>(key) ^ internal::kSignFlip<KeyType>;
+
+        size_t first = 0;
+        while (count > kSearchWindow) {
+            size_t half = count / 2;
+            first += internal::LoadSigned<KeyType>(bytes, first + half, stride) < search_key ? half : 0;
+            count -= half;
+        }
+
+        return first + CountLess(ActiveSearchKernel(), bytes + first * stride, count, stride, key);
+    }
+
+}
+
+#endif //BTREE_KEY_SEARCH_H
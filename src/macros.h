@@ -12,4 +12,42 @@
 #define BPLUSTREE_ASSERT(expr, message) assert((expr) && (message))
 #endif /* NDEBUG */
 
+/**
+ * Prefetch a cache line for reading, without waiting for it to arrive
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BPLUSTREE_PREFETCH(addr) __builtin_prefetch((addr), 0, 3)
+#else
+#define BPLUSTREE_PREFETCH(addr) ((void)(addr))
+#endif
+
+/**
+ * ThreadSanitizer annotations
+ *
+ * Optimistic readers read nodes which a writer may be modifying at the
+ * same time. What was read is discarded when the node version changed,
+ * so these races are benign and the reads are hidden from TSAN.
+ */
+#if defined(__SANITIZE_THREAD__)
+#define BPLUSTREE_TSAN_ENABLED
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define BPLUSTREE_TSAN_ENABLED
+#endif
+#endif
+
+#ifdef BPLUSTREE_TSAN_ENABLED
+extern "C" void AnnotateIgnoreReadsBegin(const char *file, int line);
+extern "C" void AnnotateIgnoreReadsEnd(const char *file, int line);
+#define BPLUSTREE_TSAN_IGNORE_READS_BEGIN() AnnotateIgnoreReadsBegin(__FILE__, __LINE__)
+#define BPLUSTREE_TSAN_IGNORE_READS_END() AnnotateIgnoreReadsEnd(__FILE__, __LINE__)
+
+extern "C" void __tsan_mutex_destroy(void *addr, unsigned flags);
+#define BPLUSTREE_TSAN_MUTEX_DESTROY(addr) __tsan_mutex_destroy((addr), 0)
+#else
+#define BPLUSTREE_TSAN_IGNORE_READS_BEGIN() ((void)0)
+#define BPLUSTREE_TSAN_IGNORE_READS_END() ((void)0)
+#define BPLUSTREE_TSAN_MUTEX_DESTROY(addr) ((void)0)
+#endif /* BPLUSTREE_TSAN_ENABLED */
+
 #endif //BTREE_MACROS_H
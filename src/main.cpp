@@ -115,7 +115,7 @@ int main() {
 //        std::cout << "Key: " << (*iter).first << " Value: " << (*iter).second << std::endl;
 //    }
 
-    bplustree::BPlusTree index{3, 3};
+    bplustree::BPlusTree<int, int> index{3, 3};
 
 //    std::vector<int> items(1024);
 //    std::iota(items.begin(), items.end(), 0);
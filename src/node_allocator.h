@@ -0,0 +1,331 @@
+#ifndef BTREE_NODE_ALLOCATOR_H
+#define BTREE_NODE_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "macros.h"
+#include "thread_local_records.h"
+
+namespace bplustree {
+
+    struct NodeAllocatorStats {
+        // Memory obtained from the system
+        size_t bytes_reserved_{0};
+
+        // Memory currently handed out for nodes
+        size_t bytes_in_use_{0};
+    };
+
+    /**
+     * Provides the storage for B+Tree nodes.
+     *
+     * A B+Tree owns its node allocator. Every node of the B+Tree is
+     * allocated from, and returned to the same allocator.
+     */
+    class NodeAllocator {
+    public:
+        virtual ~NodeAllocator() = default;
+
+        virtual void *Allocate(size_t size) = 0;
+
+        /**
+         * @param size is the same size which was passed to `Allocate`
+         */
+        virtual void Deallocate(void *ptr, size_t size) = 0;
+
+        /**
+         * Frees all the memory handed out by this allocator at once. Must
+         * not be called while other threads are using the allocator.
+         *
+         * @return false if the allocator cannot release its memory wholesale,
+         * and every allocation has to be deallocated individually.
+         */
+        virtual bool ReleaseAll() { return false; }
+
+        virtual NodeAllocatorStats GetStats() const = 0;
+    };
+
+    /**
+     * Allocates every node separately from the global heap.
+     */
+    class HeapNodeAllocator : public NodeAllocator {
+    public:
+        void *Allocate(size_t size) override {
+            bytes_in_use_.fetch_add(size, std::memory_order_relaxed);
+            return new char[size];
+        }
+
+        void Deallocate(void *ptr, size_t size) override {
+            delete[] static_cast<char *>(ptr);
+            bytes_in_use_.fetch_sub(size, std::memory_order_relaxed);
+        }
+
+        NodeAllocatorStats GetStats() const override {
+            auto bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+            return NodeAllocatorStats{bytes_in_use, bytes_in_use};
+        }
+
+    private:
+        std::atomic<size_t> bytes_in_use_{0};
+    };
+
+    /**
+     * Slab Allocator
+     * --------------
+     *
+     * Nodes of a B+Tree come in only two sizes, one for inner nodes and one
+     * for leaf nodes. Requests are rounded up to a multiple of the cache line
+     * size, and every distinct size is a size class. Memory is reserved in
+     * large slabs, and each slab is carved into fixed-size blocks of a single
+     * size class. Blocks are aligned to cache lines, so a node never shares a
+     * cache line with another node.
+     *
+     * Every thread keeps a small cache of free blocks for each size class.
+     * A node is allocated from, and freed to the cache of the calling thread
+     * without a lock or an atomic read-modify-write. Only when the cache runs
+     * empty, or grows past its capacity, the thread moves a batch of blocks
+     * between its cache and a shared pool.
+     *
+     * The shared pool keeps the free lists and the slabs. To avoid a single
+     * lock shared by all the threads, it is partitioned into shards, and a
+     * thread always refills from, and flushes to the same shard.
+     *
+     * Slabs are returned to the system only when the allocator is destroyed
+     * or through `ReleaseAll`.
+     */
+    class SlabNodeAllocator : public NodeAllocator {
+    public:
+        static constexpr size_t kCacheLineSize = 64;
+
+        SlabNodeAllocator() = default;
+
+        ~SlabNodeAllocator() override { ReleaseAll(); }
+
+        SlabNodeAllocator(const SlabNodeAllocator &) = delete;
+
+        SlabNodeAllocator &operator=(const SlabNodeAllocator &) = delete;
+
+        void *Allocate(size_t size) override {
+            auto block_size = RoundUpToCacheLine(size);
+            auto &cache = caches_.Local();
+            cache.AddBytesInUse(static_cast<int64_t>(block_size));
+
+            auto &cached = cache.GetSizeClass(block_size);
+            if (cached.free_list_ == nullptr) {
+                Refill(cached);
+            }
+
+            auto block = cached.free_list_;
+            cached.free_list_ = block->next_;
+            --cached.count_;
+            return block;
+        }
+
+        void Deallocate(void *ptr, size_t size) override {
+            auto block_size = RoundUpToCacheLine(size);
+            auto &cache = caches_.Local();
+            cache.AddBytesInUse(-static_cast<int64_t>(block_size));
+
+            auto &cached = cache.GetSizeClass(block_size);
+            auto block = static_cast<FreeBlock *>(ptr);
+            block->next_ = cached.free_list_;
+            cached.free_list_ = block;
+
+            // Keeps half of the cache, so that a thread which alternates
+            // between freeing and allocating does not go to the shard
+            // every time
+            if (++cached.count_ > kCacheCapacity) {
+                Flush(cached, kCacheCapacity / 2);
+            }
+        }
+
+        bool ReleaseAll() override {
+            caches_.ForEach([](ThreadCache &cache) {
+                cache.size_classes_.clear();
+                cache.bytes_in_use_.store(0, std::memory_order_relaxed);
+            });
+
+            for (auto &shard: shards_) {
+                std::lock_guard<std::mutex> guard{shard.mutex_};
+                for (auto slab: shard.slabs_) {
+                    ::operator delete(slab, std::align_val_t{kCacheLineSize});
+                }
+                shard.slabs_.clear();
+                shard.size_classes_.clear();
+                shard.bytes_reserved_ = 0;
+            }
+            return true;
+        }
+
+        NodeAllocatorStats GetStats() const override {
+            int64_t bytes_reserved = 0;
+            for (auto &shard: shards_) {
+                std::lock_guard<std::mutex> guard{shard.mutex_};
+                bytes_reserved += shard.bytes_reserved_;
+            }
+
+            // A block can be freed by a different thread than the one which
+            // allocated it, so only the sum over all threads is meaningful
+            int64_t bytes_in_use = 0;
+            caches_.ForEach([&bytes_in_use](const ThreadCache &cache) {
+                bytes_in_use += cache.bytes_in_use_.load(std::memory_order_relaxed);
+            });
+            return NodeAllocatorStats{static_cast<size_t>(bytes_reserved), static_cast<size_t>(bytes_in_use)};
+        }
+
+    private:
+        static constexpr size_t kShardCount = 16;
+        static constexpr size_t kMinSlabSize = 64 * 1024;
+        static constexpr size_t kMinBlocksPerSlab = 16;
+
+        // Number of free blocks of a size class a thread keeps in its cache
+        static constexpr size_t kCacheCapacity = 64;
+        // Number of blocks a thread takes from its shard when its cache
+        // is empty
+        static constexpr size_t kRefillCount = 16;
+
+        struct FreeBlock {
+            FreeBlock *next_;
+        };
+
+        struct SizeClass {
+            size_t block_size_;
+            FreeBlock *free_list_{nullptr};
+
+            // Unused part of the most recently reserved slab
+            char *bump_{nullptr};
+            char *bump_end_{nullptr};
+        };
+
+        struct CachedSizeClass {
+            size_t block_size_;
+            FreeBlock *free_list_{nullptr};
+            size_t count_{0};
+        };
+
+        struct ThreadCache {
+            std::vector<CachedSizeClass> size_classes_;
+
+            // Only written by the thread owning the cache, which is why it
+            // does not need an atomic read-modify-write
+            std::atomic<int64_t> bytes_in_use_{0};
+
+            CachedSizeClass &GetSizeClass(size_t block_size) {
+                for (auto &size_class: size_classes_) {
+                    if (size_class.block_size_ == block_size) {
+                        return size_class;
+                    }
+                }
+                size_classes_.push_back(CachedSizeClass{block_size});
+                return size_classes_.back();
+            }
+
+            void AddBytesInUse(int64_t delta) {
+                bytes_in_use_.store(bytes_in_use_.load(std::memory_order_relaxed) + delta,
+                                    std::memory_order_relaxed);
+            }
+        };
+
+        struct alignas(kCacheLineSize) Shard {
+            mutable std::mutex mutex_;
+            std::vector<SizeClass> size_classes_;
+            std::vector<char *> slabs_;
+            int64_t bytes_reserved_{0};
+
+            SizeClass &GetSizeClass(size_t block_size) {
+                for (auto &size_class: size_classes_) {
+                    if (size_class.block_size_ == block_size) {
+                        return size_class;
+                    }
+                }
+                size_classes_.push_back(SizeClass{block_size});
+                return size_classes_.back();
+            }
+        };
+
+        static size_t RoundUpToCacheLine(size_t size) {
+            return (size + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+        }
+
+        static size_t SlabSize(size_t block_size) {
+            auto slab_size = block_size * kMinBlocksPerSlab;
+            return slab_size < kMinSlabSize ? kMinSlabSize : slab_size;
+        }
+
+        // Threads are assigned to shards round-robin, in the order in which
+        // they first refill or flush their cache
+        Shard &LocalShard() {
+            static std::atomic<size_t> next_shard_index{0};
+            thread_local size_t shard_index = next_shard_index.fetch_add(1, std::memory_order_relaxed);
+            return shards_[shard_index % kShardCount];
+        }
+
+        /**
+         * Moves free blocks of the shard into the empty cache, and carves
+         * new blocks out of a slab when the shard has too few free blocks.
+         */
+        void Refill(CachedSizeClass &cached) {
+            auto block_size = cached.block_size_;
+            auto &shard = LocalShard();
+
+            std::lock_guard<std::mutex> guard{shard.mutex_};
+            auto &size_class = shard.GetSizeClass(block_size);
+
+            while (cached.count_ < kRefillCount && size_class.free_list_ != nullptr) {
+                auto block = size_class.free_list_;
+                size_class.free_list_ = block->next_;
+                block->next_ = cached.free_list_;
+                cached.free_list_ = block;
+                ++cached.count_;
+            }
+
+            while (cached.count_ < kRefillCount) {
+                if (size_class.bump_ == size_class.bump_end_) {
+                    auto slab_size = SlabSize(block_size);
+                    auto slab = static_cast<char *>(::operator new(slab_size, std::align_val_t{kCacheLineSize}));
+
+                    shard.slabs_.push_back(slab);
+                    shard.bytes_reserved_ += static_cast<int64_t>(slab_size);
+
+                    size_class.bump_ = slab;
+                    size_class.bump_end_ = slab + (slab_size / block_size) * block_size;
+                }
+
+                auto block = reinterpret_cast<FreeBlock *>(size_class.bump_);
+                size_class.bump_ += block_size;
+                block->next_ = cached.free_list_;
+                cached.free_list_ = block;
+                ++cached.count_;
+            }
+        }
+
+        /**
+         * Moves `count` free blocks from the cache to the shard.
+         */
+        void Flush(CachedSizeClass &cached, size_t count) {
+            auto &shard = LocalShard();
+
+            std::lock_guard<std::mutex> guard{shard.mutex_};
+            auto &size_class = shard.GetSizeClass(cached.block_size_);
+
+            for (size_t i = 0; i < count; ++i) {
+                auto block = cached.free_list_;
+                cached.free_list_ = block->next_;
+                block->next_ = size_class.free_list_;
+                size_class.free_list_ = block;
+            }
+            cached.count_ -= count;
+        }
+
+        ThreadLocalRecords<ThreadCache> caches_;
+        Shard shards_[kShardCount];
+    };
+
+}
+
+#endif //BTREE_NODE_ALLOCATOR_H
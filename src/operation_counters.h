@@ -0,0 +1,119 @@
+#ifndef BTREE_OPERATION_COUNTERS_H
+#define BTREE_OPERATION_COUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include "thread_local_records.h"
+
+namespace bplustree {
+
+    /**
+     * The paths which the operations of a B+Tree took, added up over every
+     * thread.
+     */
+    struct OperationStats {
+        // Inserts and deletes which finished in their first descent, which
+        // latches only the leaf node in exclusive mode
+        uint64_t optimistic_inserts_{0};
+        uint64_t optimistic_deletes_{0};
+
+        // Inserts and deletes which descended again latching every unsafe
+        // node in exclusive mode, because the leaf node was full, or would
+        // underflow
+        uint64_t pessimistic_inserts_{0};
+        uint64_t pessimistic_deletes_{0};
+
+        uint64_t leaf_splits_{0};
+        uint64_t inner_splits_{0};
+        // Splits which added a level above the root node. The split of the
+        // old root node is also counted as a leaf or an inner split.
+        uint64_t root_splits_{0};
+
+        // Underflowing nodes which took an element from a sibling
+        uint64_t leaf_borrows_{0};
+        uint64_t inner_borrows_{0};
+        // Underflowing nodes which were merged with a sibling
+        uint64_t leaf_merges_{0};
+        uint64_t inner_merges_{0};
+        // Root inner nodes left with a single child, which were removed
+        uint64_t root_collapses_{0};
+
+        // Iterators which descended from the root again, because the
+        // sibling leaf node was latched by a writer
+        uint64_t forward_reseeks_{0};
+        uint64_t backward_reseeks_{0};
+    };
+
+    enum class OperationCounter : int {
+        OptimisticInserts, OptimisticDeletes, PessimisticInserts, PessimisticDeletes,
+        LeafSplits, InnerSplits, RootSplits,
+        LeafBorrows, InnerBorrows, LeafMerges, InnerMerges, RootCollapses,
+        ForwardReseeks, BackwardReseeks,
+        Count
+    };
+
+    /**
+     * Counters which are written by many threads and read rarely.
+     *
+     * Every thread counts in its own record, which is aligned to a cache
+     * line, so that counting does not invalidate the lines of the other
+     * threads. The records are added up only when the counters are read.
+     * A record is only written by the thread which owns it, so a count is
+     * incremented without a read-modify-write. The counts are atomic only
+     * so that they can be read while they are written.
+     */
+    class OperationCounters {
+    public:
+        void Increment(OperationCounter counter) {
+            auto &count = records_.Local().counts_[static_cast<int>(counter)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /**
+         * The records are read one at a time, without stopping the threads
+         * which count, so the stats may miss the latest operations.
+         */
+        OperationStats GetStats() const {
+            std::array<uint64_t, kCounterCount> totals{};
+            records_.ForEach([&totals](const Record &record) {
+                for (size_t counter = 0; counter < kCounterCount; ++counter) {
+                    totals[counter] += record.counts_[counter].load(std::memory_order_relaxed);
+                }
+            });
+
+            auto total = [&totals](OperationCounter counter) { return totals[static_cast<int>(counter)]; };
+            OperationStats stats;
+            stats.optimistic_inserts_ = total(OperationCounter::OptimisticInserts);
+            stats.optimistic_deletes_ = total(OperationCounter::OptimisticDeletes);
+            stats.pessimistic_inserts_ = total(OperationCounter::PessimisticInserts);
+            stats.pessimistic_deletes_ = total(OperationCounter::PessimisticDeletes);
+            stats.leaf_splits_ = total(OperationCounter::LeafSplits);
+            stats.inner_splits_ = total(OperationCounter::InnerSplits);
+            stats.root_splits_ = total(OperationCounter::RootSplits);
+            stats.leaf_borrows_ = total(OperationCounter::LeafBorrows);
+            stats.inner_borrows_ = total(OperationCounter::InnerBorrows);
+            stats.leaf_merges_ = total(OperationCounter::LeafMerges);
+            stats.inner_merges_ = total(OperationCounter::InnerMerges);
+            stats.root_collapses_ = total(OperationCounter::RootCollapses);
+            stats.forward_reseeks_ = total(OperationCounter::ForwardReseeks);
+            stats.backward_reseeks_ = total(OperationCounter::BackwardReseeks);
+            return stats;
+        }
+
+    private:
+        static constexpr size_t kCounterCount = static_cast<size_t>(OperationCounter::Count);
+
+        // A thread which exits leaves its counts in the record, and the next
+        // thread which takes over the record adds to them
+        struct Record {
+            std::array<std::atomic<uint64_t>, kCounterCount> counts_{};
+        };
+
+        ThreadLocalRecords<Record> records_;
+    };
+
+}
+
+#endif //BTREE_OPERATION_COUNTERS_H
@@ -1,19 +1,61 @@
+#ifndef BTREE_SHARED_LATCH_H
+#define BTREE_SHARED_LATCH_H
+
 #include <shared_mutex>
 #include <cassert>
 #include <cstdio>
+#include <cstdint>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "macros.h"
 
 /**
  * A wrapper around std::shared_mutex
  */
 namespace bplustree {
 
+#ifdef ENABLE_LATCH_STATS
+    constexpr bool kLatchStats = true;
+#else
+    constexpr bool kLatchStats = false;
+#endif
+
+    /**
+     * How often a latch was acquired, and how long the acquisitions which
+     * found it held in a conflicting mode waited. Only counted when built
+     * with ENABLE_LATCH_STATS, and zero otherwise.
+     */
+    struct LatchCounts {
+        static constexpr int kWaitBuckets = 32;
+
+        uint64_t shared_acquisitions_{0};
+        uint64_t exclusive_acquisitions_{0};
+        // Acquisitions which had to wait for another thread
+        uint64_t contended_acquisitions_{0};
+        // Bucket i counts the waits of [2^i, 2^(i+1)) nanoseconds. The last
+        // bucket also counts the longer waits.
+        std::array<uint64_t, kWaitBuckets> wait_histogram_{};
+
+        void Add(const LatchCounts &other) {
+            shared_acquisitions_ += other.shared_acquisitions_;
+            exclusive_acquisitions_ += other.exclusive_acquisitions_;
+            contended_acquisitions_ += other.contended_acquisitions_;
+            for (int bucket = 0; bucket < kWaitBuckets; ++bucket) {
+                wait_histogram_[bucket] += other.wait_histogram_[bucket];
+            }
+        }
+    };
+
     class SharedLatch {
     public:
         SharedLatch() = default;
 
-#ifdef ENABLE_LATCH_DEBUGGING
+#if defined(ENABLE_LATCH_DEBUGGING) || defined(BPLUSTREE_TSAN_ENABLED)
         ~SharedLatch() {
+#ifdef ENABLE_LATCH_DEBUGGING
             if (exclusive_lock_count_ != 0) {
                 fprintf(stderr, "exclusive_lock_count_ is %d, expected 0 for latch %p\n", exclusive_lock_count_.load(), this);
             }
@@ -22,19 +64,41 @@ namespace bplustree {
                 fprintf(stderr, "shared_lock_count_ is %d, expected 0 for latch %p\n", shared_lock_count_.load(), this);
             }
             assert(shared_lock_count_ == 0);
+#endif
+            // The node allocator reuses the memory of freed nodes, and
+            // std::shared_mutex does not tell TSAN when it is destroyed
+            BPLUSTREE_TSAN_MUTEX_DESTROY(&latch_);
         }
 #endif
 
 
         void LockExclusive() {
+#ifdef ENABLE_LATCH_STATS
+            if (!latch_.try_lock()) {
+                auto start = std::chrono::steady_clock::now();
+                latch_.lock();
+                CountWait(start);
+            }
+            exclusive_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+#else
             latch_.lock();
+#endif
 #ifdef ENABLE_LATCH_DEBUGGING
             exclusive_lock_count_++;
 #endif
         }
 
         void LockShared() {
+#ifdef ENABLE_LATCH_STATS
+            if (!latch_.try_lock_shared()) {
+                auto start = std::chrono::steady_clock::now();
+                latch_.lock_shared();
+                CountWait(start);
+            }
+            shared_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+#else
             latch_.lock_shared();
+#endif
 #ifdef ENABLE_LATCH_DEBUGGING
             shared_lock_count_++;
 #endif
@@ -60,16 +124,151 @@ namespace bplustree {
             if (success) {
                 shared_lock_count_++;
             }
+#endif
+#ifdef ENABLE_LATCH_STATS
+            if (success) {
+                shared_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+            }
 #endif
             return success;
         }
 
+        /**
+         * @return the acquisitions of this latch so far. The counts are read
+         * one at a time, so they may be off by the acquisitions made while
+         * they are read.
+         */
+        LatchCounts GetCounts() const {
+            LatchCounts counts;
+#ifdef ENABLE_LATCH_STATS
+            counts.shared_acquisitions_ = shared_acquisitions_.load(std::memory_order_relaxed);
+            counts.exclusive_acquisitions_ = exclusive_acquisitions_.load(std::memory_order_relaxed);
+            counts.contended_acquisitions_ = contended_acquisitions_.load(std::memory_order_relaxed);
+            for (int bucket = 0; bucket < LatchCounts::kWaitBuckets; ++bucket) {
+                counts.wait_histogram_[bucket] = wait_histogram_[bucket].load(std::memory_order_relaxed);
+            }
+#endif
+            return counts;
+        }
+
     private:
+#ifdef ENABLE_LATCH_STATS
+        /**
+         * Only an acquisition which failed to take the latch right away is
+         * timed, so that uncontended acquisitions do not read the clock.
+         */
+        void CountWait(std::chrono::steady_clock::time_point start) {
+            auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            int bucket = 0;
+            while (bucket < LatchCounts::kWaitBuckets - 1 && (waited >> (bucket + 1)) > 0) {
+                ++bucket;
+            }
+            contended_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+            wait_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+#endif
+
         std::shared_mutex latch_;
 #ifdef ENABLE_LATCH_DEBUGGING
         std::atomic<int> exclusive_lock_count_{0};
         std::atomic<int> shared_lock_count_{0};
 #endif
+#ifdef ENABLE_LATCH_STATS
+        std::atomic<uint64_t> shared_acquisitions_{0};
+        std::atomic<uint64_t> exclusive_acquisitions_{0};
+        std::atomic<uint64_t> contended_acquisitions_{0};
+        std::array<std::atomic<uint64_t>, LatchCounts::kWaitBuckets> wait_histogram_{};
+#endif
+    };
+
+
+    /**
+     * A SharedLatch which additionally supports optimistic reads.
+     *
+     * The latch carries a version which is odd while the latch is held in
+     * exclusive mode, and is incremented once more on release. A reader
+     * which does not want to write to the latch, reads the version before
+     * and after reading the data protected by this latch. The data read is
+     * consistent if the version was even and did not change in between.
+     * Otherwise, the reader has to discard what it read and retry.
+     *
+     * The shared and exclusive modes work exactly like SharedLatch, so
+     * writers and iterators continue to use latch crabbing.
+     */
+    class VersionedLatch {
+    public:
+        VersionedLatch() = default;
+
+        void LockExclusive() {
+            latch_.LockExclusive();
+            version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            OptimisticReadFence(std::memory_order_release);
+        }
+
+        void UnlockExclusive() {
+            version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            latch_.UnlockExclusive();
+        }
+
+        void LockShared() { latch_.LockShared(); }
+
+        void UnlockShared() { latch_.UnlockShared(); }
+
+        bool TryLockShared() { return latch_.TryLockShared(); }
+
+        LatchCounts GetCounts() const { return latch_.GetCounts(); }
+
+        /**
+         * Begins an optimistic read. Waits for a short while if the latch
+         * is currently held in exclusive mode.
+         *
+         * @param version set to the version to validate against, after
+         * reading the protected data
+         * @return false if the latch is still held in exclusive mode
+         */
+        bool TryOptimisticRead(uint64_t &version) const {
+            for (int spin = 0; spin < kMaxOptimisticSpins; ++spin) {
+                version = version_.load(std::memory_order_acquire);
+                if ((version & 1) == 0) {
+                    return true;
+                }
+                std::this_thread::yield();
+            }
+            return false;
+        }
+
+        /**
+         * @param version returned by `TryOptimisticRead`
+         * @return true if no writer acquired the latch since the optimistic
+         * read began
+         */
+        bool ValidateOptimisticRead(uint64_t version) const {
+            OptimisticReadFence(std::memory_order_acquire);
+            return version_.load(std::memory_order_relaxed) == version;
+        }
+
+    private:
+        /**
+         * TSAN does not model standalone fences and warns about them. The
+         * racy reads are hidden from TSAN anyway, so the fence is skipped in
+         * sanitized builds.
+         */
+        static void OptimisticReadFence(std::memory_order order) {
+#ifndef BPLUSTREE_TSAN_ENABLED
+            std::atomic_thread_fence(order);
+#else
+            (void) order;
+#endif
+        }
+
+        static constexpr int kMaxOptimisticSpins = 64;
+
+        SharedLatch latch_;
+        std::atomic<uint64_t> version_{0};
     };
 
-}
\ No newline at end of file
+}
+
+#endif //BTREE_SHARED_LATCH_H
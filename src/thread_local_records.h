@@ -0,0 +1,190 @@
+#ifndef BTREE_THREAD_LOCAL_RECORDS_H
+#define BTREE_THREAD_LOCAL_RECORDS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace bplustree {
+
+    /**
+     * Gives every thread its own record of type `Record` per owner object.
+     *
+     * The records are linked into a list owned by this object, so that the
+     * owner can visit the records of all threads, for example to add up
+     * their counts. A record is released when its thread exits, and reused
+     * by the next thread which asks for a record. Records are freed only
+     * when this object is destroyed.
+     *
+     * The record of a thread is only written by that thread, except when
+     * the owner visits the records while no other thread is using it.
+     */
+    template<typename Record>
+    class ThreadLocalRecords {
+    public:
+        ThreadLocalRecords() : id_{NextOwnerId()} {
+            std::lock_guard<std::mutex> guard{RegistryMutex()};
+            LiveOwners().insert(id_);
+        }
+
+        ~ThreadLocalRecords() {
+            {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                LiveOwners().erase(id_);
+            }
+
+            auto node = nodes_.load(std::memory_order_acquire);
+            while (node != nullptr) {
+                auto next = node->next_;
+                delete node;
+                node = next;
+            }
+        }
+
+        ThreadLocalRecords(const ThreadLocalRecords &) = delete;
+
+        ThreadLocalRecords &operator=(const ThreadLocalRecords &) = delete;
+
+        Record &Local() {
+            auto &local = LocalEntries();
+            for (auto &entry: local.entries_) {
+                if (entry.owner_id_ == id_) {
+                    return entry.node_->record_;
+                }
+            }
+
+            if (local.entries_.size() >= kPruneThreshold) {
+                local.PruneDestroyedOwners();
+            }
+
+            auto node = AcquireNode();
+            local.entries_.push_back(ThreadEntry{id_, node});
+            return node->record_;
+        }
+
+        /**
+         * Visits the records of every thread, including the released
+         * records of threads which have exited.
+         */
+        template<typename Fn>
+        void ForEach(Fn &&fn) const {
+            auto node = nodes_.load(std::memory_order_acquire);
+            while (node != nullptr) {
+                fn(static_cast<const Record &>(node->record_));
+                node = node->next_;
+            }
+        }
+
+        template<typename Fn>
+        void ForEach(Fn &&fn) {
+            auto node = nodes_.load(std::memory_order_acquire);
+            while (node != nullptr) {
+                fn(node->record_);
+                node = node->next_;
+            }
+        }
+
+    private:
+        // Aligned to a cache line, so that a thread writing its record does
+        // not invalidate the line holding the record of another thread
+        struct alignas(64) Node {
+            Record record_;
+            std::atomic<bool> in_use_{true};
+
+            // Nodes are never unlinked until the owner is destroyed
+            Node *next_{nullptr};
+
+            bool TryAcquire() {
+                bool expected = false;
+                return in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire);
+            }
+
+            void Release() { in_use_.store(false, std::memory_order_release); }
+        };
+
+        struct ThreadEntry {
+            uint64_t owner_id_;
+            Node *node_;
+        };
+
+        /**
+         * The records the calling thread owns, one for every owner it used.
+         * Releases them when the thread exits, unless the owner was
+         * destroyed before that.
+         */
+        struct ThreadEntries {
+            std::vector<ThreadEntry> entries_;
+
+            ~ThreadEntries() {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                for (auto &entry: entries_) {
+                    if (LiveOwners().count(entry.owner_id_) != 0) {
+                        entry.node_->Release();
+                    }
+                }
+            }
+
+            void PruneDestroyedOwners() {
+                std::lock_guard<std::mutex> guard{RegistryMutex()};
+                auto &live_owners = LiveOwners();
+
+                auto end = entries_.begin();
+                for (auto &entry: entries_) {
+                    if (live_owners.count(entry.owner_id_) != 0) {
+                        *end++ = entry;
+                    }
+                }
+                entries_.erase(end, entries_.end());
+            }
+        };
+
+        // Number of entries a thread keeps before it drops the entries of
+        // destroyed owners
+        static constexpr size_t kPruneThreshold = 32;
+
+        static uint64_t NextOwnerId() {
+            static std::atomic<uint64_t> next_id{0};
+            return next_id.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static std::mutex &RegistryMutex() {
+            static std::mutex registry_mutex;
+            return registry_mutex;
+        }
+
+        static std::unordered_set<uint64_t> &LiveOwners() {
+            static std::unordered_set<uint64_t> live_owners;
+            return live_owners;
+        }
+
+        static ThreadEntries &LocalEntries() {
+            thread_local ThreadEntries local_entries;
+            return local_entries;
+        }
+
+        Node *AcquireNode() {
+            auto node = nodes_.load(std::memory_order_acquire);
+            while (node != nullptr) {
+                if (node->TryAcquire()) {
+                    return node;
+                }
+                node = node->next_;
+            }
+
+            auto new_node = new Node{};
+            new_node->next_ = nodes_.load(std::memory_order_relaxed);
+            while (!nodes_.compare_exchange_weak(new_node->next_, new_node,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed)) {}
+            return new_node;
+        }
+
+        const uint64_t id_;
+        std::atomic<Node *> nodes_{nullptr};
+    };
+
+}
+
+#endif //BTREE_THREAD_LOCAL_RECORDS_H
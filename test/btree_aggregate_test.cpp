@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using Index = BPlusTree<int, int>;
+
+    /**
+     * Checks the summary stored for every child pointer against the values
+     * below it, and returns the values below `node` folded together
+     */
+    RangeAggregate<int> CheckAggregates(BaseNode *node) {
+        RangeAggregate<int> aggregate;
+        if (node->GetType() == NodeType::LeafType) {
+            auto leaf = static_cast<LeafNode<int, int> *>(node);
+            for (auto iter = leaf->Begin(); iter != leaf->End(); ++iter) {
+                aggregate.Add(iter->second);
+            }
+            return aggregate;
+        }
+
+        auto inner = static_cast<InnerNode<int> *>(node);
+        for (int child = 0; child <= inner->GetCurrentSize(); ++child) {
+            auto child_node = child == 0 ? inner->GetLowKeyPair().second : inner->At(child - 1).second;
+            auto expected = CheckAggregates(child_node);
+            auto stored = reinterpret_cast<RangeAggregate<int> *>(inner->Summary(child));
+            EXPECT_EQ(stored->count_, expected.count_);
+            EXPECT_EQ(stored->sum_, expected.sum_);
+            if (expected.count_ > 0) {
+                EXPECT_EQ(stored->min_, expected.min_);
+                EXPECT_EQ(stored->max_, expected.max_);
+            }
+            aggregate.Add(*stored);
+        }
+        return aggregate;
+    }
+
+    void ExpectAggregate(Index &index, const std::map<int, int> &elements, int lo, int hi) {
+        RangeAggregate<int> expected;
+        if (lo <= hi) {
+            for (auto iter = elements.lower_bound(lo); iter != elements.upper_bound(hi); ++iter) {
+                expected.Add(iter->second);
+            }
+        }
+
+        auto aggregate = index.Aggregate(lo, hi);
+        EXPECT_EQ(aggregate.count_, expected.count_);
+        EXPECT_EQ(aggregate.sum_, expected.sum_);
+        if (expected.count_ > 0) {
+            EXPECT_EQ(aggregate.min_, expected.min_);
+            EXPECT_EQ(aggregate.max_, expected.max_);
+        }
+    }
+
+    void ExpectAggregates(Index &index, const std::map<int, int> &elements, std::mt19937 &rng) {
+        if (index.GetRoot() != nullptr) {
+            EXPECT_EQ(CheckAggregates(index.GetRoot()).count_, elements.size());
+        }
+
+        ExpectAggregate(index, elements, -10, 1010);
+        std::uniform_int_distribution<int> key_dist{-10, 1010};
+        for (int i = 0; i < 50; ++i) {
+            auto lo = key_dist(rng);
+            ExpectAggregate(index, elements, lo, key_dist(rng));
+            ExpectAggregate(index, elements, lo, lo + key_dist(rng) / 50);
+        }
+    }
+
+    TEST(BPlusTreeAggregateTest, MatchesScannedValuesAfterInsertsAndDeletes) {
+        for (auto [inner_size, leaf_size]: std::vector<std::pair<int, int>>{{3, 4}, {3, 3}, {4, 5}, {7, 8}}) {
+            Index index{inner_size, leaf_size, Augmentation::Aggregates};
+            std::map<int, int> elements;
+            std::mt19937 rng{static_cast<uint32_t>(inner_size * 17 + leaf_size)};
+            std::uniform_int_distribution<int> key_dist{0, 999};
+            std::uniform_int_distribution<int> value_dist{-5000, 5000};
+
+            for (int round = 0; round < 6; ++round) {
+                for (int i = 0; i < 400; ++i) {
+                    auto key = key_dist(rng);
+                    auto value = value_dist(rng);
+                    EXPECT_EQ(index.Insert(std::make_pair(key, value)), elements.emplace(key, value).second);
+                }
+                ExpectAggregates(index, elements, rng);
+
+                for (int i = 0; i < 300; ++i) {
+                    auto key = key_dist(rng);
+                    EXPECT_EQ(index.Delete(key), elements.erase(key) == 1);
+                }
+                ExpectAggregates(index, elements, rng);
+            }
+
+            for (auto [key, value]: std::map<int, int>{elements}) {
+                EXPECT_TRUE(index.Delete(key));
+            }
+            EXPECT_EQ(index.GetRoot(), nullptr);
+            EXPECT_EQ(index.Aggregate(0, 1000).count_, 0u);
+        }
+    }
+
+    TEST(BPlusTreeAggregateTest, MatchesScannedValuesAfterBatchesAndRanges) {
+        Index index{4, 5, Augmentation::Aggregates};
+        std::map<int, int> elements;
+        std::mt19937 rng{5};
+        std::uniform_int_distribution<int> key_dist{0, 999};
+
+        for (int round = 0; round < 8; ++round) {
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < 200; ++i) {
+                auto key = key_dist(rng);
+                batch.emplace_back(key, key % 97 - 48);
+            }
+            std::sort(batch.begin(), batch.begin() + 100);
+
+            auto inserted = index.InsertBatch(batch.begin(), batch.end());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                EXPECT_EQ(inserted[i], elements.insert(batch[i]).second);
+            }
+            ExpectAggregates(index, elements, rng);
+
+            auto lo = key_dist(rng);
+            auto hi = lo + key_dist(rng) / 8;
+            index.DeleteRange(lo, hi);
+            elements.erase(elements.lower_bound(lo), elements.upper_bound(hi));
+            ExpectAggregates(index, elements, rng);
+        }
+    }
+
+    TEST(BPlusTreeAggregateTest, BulkLoadSummarizesEveryLevel) {
+        std::vector<std::pair<int, int>> sorted;
+        std::map<int, int> elements;
+        for (int i = 0; i < 1000; ++i) {
+            sorted.emplace_back(i, (i * 7919) % 1000);
+            elements.emplace(i, (i * 7919) % 1000);
+        }
+
+        for (int num_threads: {1, 4}) {
+            Index index{3, 4, Augmentation::Aggregates};
+            EXPECT_TRUE(index.ParallelBulkLoad(sorted.begin(), sorted.end(), num_threads, 0.75));
+
+            std::mt19937 rng{9};
+            ExpectAggregates(index, elements, rng);
+        }
+    }
+
+    TEST(BPlusTreeAggregateTest, KeepsOrderStatistics) {
+        Index index{3, 4, Augmentation::Aggregates};
+        for (int i = 0; i < 500; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair((i * 37) % 500, i)));
+        }
+        for (int key = 0; key < 500; key += 5) {
+            EXPECT_TRUE(index.Delete(key));
+        }
+
+        EXPECT_EQ(index.Count(0, 100), 80u);
+        EXPECT_EQ(index.Rank(250), 200u);
+        EXPECT_EQ(index.Select(4)->first, 6);
+    }
+
+    TEST(BPlusTreeAggregateTest, WithoutAugmentationScansTheRange) {
+        for (auto augmentation: {Augmentation::None, Augmentation::OrderStatistics}) {
+            Index index{3, 4, augmentation};
+            std::map<int, int> elements;
+            for (int i = 0; i < 500; ++i) {
+                index.Insert(std::make_pair(i, 250 - i));
+                elements.emplace(i, 250 - i);
+            }
+
+            ExpectAggregate(index, elements, 100, 399);
+            ExpectAggregate(index, elements, 400, 100);
+        }
+    }
+
+    TEST(BPlusTreeAggregateTest, FloatingPointValues) {
+        BPlusTree<int64_t, double> index{4, 5, Augmentation::Aggregates};
+        for (int64_t key = 0; key < 1000; ++key) {
+            EXPECT_TRUE(index.Insert(std::make_pair(key, key * 0.5)));
+        }
+
+        auto aggregate = index.Aggregate(10, 19);
+        EXPECT_EQ(aggregate.count_, 10u);
+        EXPECT_DOUBLE_EQ(aggregate.sum_, 72.5);
+        EXPECT_DOUBLE_EQ(aggregate.min_, 5.0);
+        EXPECT_DOUBLE_EQ(aggregate.max_, 9.5);
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/node_allocator.h"
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    TEST(SlabNodeAllocatorTest, BlocksAreCacheLineAligned) {
+        SlabNodeAllocator allocator;
+
+        std::vector<void *> blocks;
+        for (size_t size = 1; size < 1000; size += 37) {
+            auto block = allocator.Allocate(size);
+            EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % SlabNodeAllocator::kCacheLineSize, 0);
+            blocks.push_back(block);
+        }
+
+        size_t size = 1;
+        for (auto block: blocks) {
+            allocator.Deallocate(block, size);
+            size += 37;
+        }
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(SlabNodeAllocatorTest, ReusesFreedBlocks) {
+        SlabNodeAllocator allocator;
+
+        auto first = allocator.Allocate(200);
+        auto stats = allocator.GetStats();
+        EXPECT_EQ(stats.bytes_in_use_, 256);
+        EXPECT_GE(stats.bytes_reserved_, stats.bytes_in_use_);
+
+        allocator.Deallocate(first, 200);
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+        EXPECT_EQ(allocator.GetStats().bytes_reserved_, stats.bytes_reserved_);
+
+        auto second = allocator.Allocate(200);
+        EXPECT_EQ(first, second);
+        allocator.Deallocate(second, 200);
+    }
+
+    TEST(SlabNodeAllocatorTest, ReleaseAll) {
+        SlabNodeAllocator allocator;
+
+        for (int i = 0; i < 10000; ++i) {
+            allocator.Allocate(1024);
+        }
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 10000 * 1024);
+        EXPECT_GE(allocator.GetStats().bytes_reserved_, 10000 * 1024);
+
+        EXPECT_TRUE(allocator.ReleaseAll());
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+        EXPECT_EQ(allocator.GetStats().bytes_reserved_, 0);
+    }
+
+    TEST(SlabNodeAllocatorTest, ConcurrentAllocations) {
+        SlabNodeAllocator allocator;
+
+        auto workload = [&]() {
+            std::vector<void *> blocks;
+            for (int i = 0; i < 10000; ++i) {
+                blocks.push_back(allocator.Allocate(512));
+            }
+            for (auto block: blocks) {
+                allocator.Deallocate(block, 512);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 8; ++i) {
+            workers.push_back(std::thread(workload));
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(SlabNodeAllocatorTest, ReusesCacheOfExitedThread) {
+        SlabNodeAllocator allocator;
+
+        void *freed = nullptr;
+        std::thread first{[&]() {
+            freed = allocator.Allocate(200);
+            allocator.Deallocate(freed, 200);
+        }};
+        first.join();
+
+        // The second thread takes over the cache the first thread released
+        // when it exited
+        void *allocated = nullptr;
+        std::thread second{[&]() {
+            allocated = allocator.Allocate(200);
+            allocator.Deallocate(allocated, 200);
+        }};
+        second.join();
+
+        EXPECT_EQ(freed, allocated);
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(BPlusTreeAllocatorTest, NodesAreAllocatedFromSlabs) {
+        BPlusTree<int, int> index{3, 4};
+        EXPECT_EQ(index.GetAllocatorStats().bytes_in_use_, 0);
+
+        for (int i = 0; i < 10000; ++i) {
+            index.Insert(std::make_pair(i, i));
+        }
+        auto stats = index.GetAllocatorStats();
+        EXPECT_GT(stats.bytes_in_use_, 0);
+        EXPECT_GE(stats.bytes_reserved_, stats.bytes_in_use_);
+
+        for (int i = 0; i < 10000; ++i) {
+            index.Delete(i);
+        }
+        EXPECT_EQ(index.GetRoot(), nullptr);
+        EXPECT_LT(index.GetAllocatorStats().bytes_in_use_, stats.bytes_in_use_);
+    }
+
+    TEST(BPlusTreeAllocatorTest, PluggableAllocator) {
+        auto allocator = std::make_unique<HeapNodeAllocator>();
+        auto heap_allocator = allocator.get();
+
+        BPlusTree<std::string, int> index{3, 4, std::move(allocator)};
+        for (int i = 0; i < 1000; ++i) {
+            index.Insert(std::make_pair(std::to_string(i), i));
+        }
+
+        auto stats = heap_allocator->GetStats();
+        EXPECT_GT(stats.bytes_in_use_, 0);
+        EXPECT_EQ(stats.bytes_reserved_, stats.bytes_in_use_);
+        EXPECT_EQ(index.GetAllocatorStats().bytes_in_use_, stats.bytes_in_use_);
+
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_EQ(index.MaybeGet(std::to_string(i)), i);
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    std::vector<std::pair<int, int>> SortedElements(int count) {
+        std::vector<std::pair<int, int>> elements;
+        for (int i = 0; i < count; ++i) {
+            elements.emplace_back(i * 2, i);
+        }
+        return elements;
+    }
+
+    /**
+     * Visits the leaf nodes from left to right, and returns their sizes
+     */
+    std::vector<int> LeafSizes(BPlusTree<int, int> &index) {
+        auto node = index.GetRoot();
+        while (node->GetType() == NodeType::InnerType) {
+            node = static_cast<InnerNode<int> *>(node)->GetLowKeyPair().second;
+        }
+
+        std::vector<int> sizes;
+        auto leaf = static_cast<LeafNode<int, int> *>(node);
+        BaseNode *previous = nullptr;
+        while (leaf != nullptr) {
+            EXPECT_EQ(leaf->GetSiblingLeft(), previous);
+            sizes.push_back(leaf->GetCurrentSize());
+            previous = leaf;
+            leaf = static_cast<LeafNode<int, int> *>(leaf->GetSiblingRight());
+        }
+        return sizes;
+    }
+
+    TEST(BPlusTreeBulkLoadTest, LoadAndFetchEveryKey) {
+        BPlusTree<int, int> index{3, 4};
+        auto elements = SortedElements(10000);
+
+        EXPECT_TRUE(index.BulkLoad(elements.begin(), elements.end()));
+
+        for (auto &element: elements) {
+            EXPECT_EQ(index.MaybeGet(element.first), element.second);
+            EXPECT_EQ(index.MaybeGet(element.first + 1), std::nullopt);
+        }
+
+        size_t i = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, elements[i++].first);
+        }
+        EXPECT_EQ(i, elements.size());
+
+        int j = elements.size() - 1;
+        for (auto iter = index.RBegin(); iter != index.REnd(); --iter) {
+            EXPECT_EQ((*iter).first, elements[j--].first);
+        }
+    }
+
+    TEST(BPlusTreeBulkLoadTest, NodesAreFilledEvenly) {
+        for (double fill_factor: {1.0, 0.75, 0.5, 0.1}) {
+            BPlusTree<int, int> index{7, 8};
+            auto elements = SortedElements(1001);
+
+            EXPECT_TRUE(index.BulkLoad(elements.begin(), elements.end(), fill_factor));
+
+            auto sizes = LeafSizes(index);
+            auto [smallest, largest] = std::minmax_element(sizes.begin(), sizes.end());
+            EXPECT_GE(*smallest, 4);
+            EXPECT_LE(*largest, 8);
+            EXPECT_LE(*largest - *smallest, 1);
+        }
+    }
+
+    TEST(BPlusTreeBulkLoadTest, InsertAndDeleteAfterLoad) {
+        BPlusTree<int, int> index{3, 4};
+        auto elements = SortedElements(5000);
+
+        EXPECT_TRUE(index.BulkLoad(elements.begin(), elements.end(), 0.5));
+
+        // Odd keys fall in between the loaded keys
+        for (int i = 0; i < 5000; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i * 2 + 1, -i)));
+        }
+        EXPECT_FALSE(index.Insert(std::make_pair(0, 0)));
+
+        std::vector<int> keys(10000);
+        std::iota(keys.begin(), keys.end(), 0);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937{42});
+        for (auto key: keys) {
+            EXPECT_TRUE(index.Delete(key));
+            EXPECT_EQ(index.MaybeGet(key), std::nullopt);
+        }
+        EXPECT_EQ(index.Begin(), index.End());
+    }
+
+    TEST(BPlusTreeBulkLoadTest, LoadStringKeys) {
+        BPlusTree<std::string, std::string> index{4, 5};
+
+        std::vector<std::pair<std::string, std::string>> elements;
+        for (int i = 0; i < 1000; ++i) {
+            auto key = "key-" + std::to_string(10000 + i);
+            elements.emplace_back(key, std::string(40, 'v') + key);
+        }
+
+        EXPECT_TRUE(index.BulkLoad(elements.begin(), elements.end(), 0.8));
+
+        for (auto &element: elements) {
+            EXPECT_EQ(index.MaybeGet(element.first), element.second);
+        }
+    }
+
+    TEST(BPlusTreeBulkLoadTest, LoadEmptyRange) {
+        BPlusTree<int, int> index{3, 4};
+        std::vector<std::pair<int, int>> elements;
+
+        EXPECT_TRUE(index.BulkLoad(elements.begin(), elements.end()));
+        EXPECT_EQ(index.GetRoot(), nullptr);
+
+        EXPECT_TRUE(index.Insert(std::make_pair(1, 1)));
+        EXPECT_EQ(index.MaybeGet(1), 1);
+    }
+
+    TEST(BPlusTreeBulkLoadTest, RejectsUnsortedKeys) {
+        BPlusTree<int, int> index{3, 4};
+
+        auto unsorted = SortedElements(1000);
+        std::swap(unsorted[500], unsorted[501]);
+        EXPECT_FALSE(index.BulkLoad(unsorted.begin(), unsorted.end()));
+
+        auto duplicates = SortedElements(1000);
+        duplicates[4].first = duplicates[3].first;
+        EXPECT_FALSE(index.BulkLoad(duplicates.begin(), duplicates.end()));
+
+        EXPECT_EQ(index.GetRoot(), nullptr);
+        EXPECT_EQ(index.GetAllocatorStats().bytes_in_use_, 0);
+    }
+
+    TEST(BPlusTreeBulkLoadTest, RejectsNonEmptyTree) {
+        BPlusTree<int, int> index{3, 4};
+        index.Insert(std::make_pair(-1, -1));
+
+        auto elements = SortedElements(100);
+        EXPECT_FALSE(index.BulkLoad(elements.begin(), elements.end()));
+
+        EXPECT_EQ(index.MaybeGet(-1), -1);
+        EXPECT_EQ(index.MaybeGet(0), std::nullopt);
+    }
+
+    TEST(BPlusTreeBulkLoadTest, ParallelLoadMatchesSerialLoad) {
+        auto elements = SortedElements(20000);
+
+        BPlusTree<int, int> serial{7, 8};
+        EXPECT_TRUE(serial.BulkLoad(elements.begin(), elements.end(), 0.7));
+        auto serial_sizes = LeafSizes(serial);
+
+        for (int num_threads: {1, 2, 3, 8}) {
+            BPlusTree<int, int> index{7, 8};
+            EXPECT_TRUE(index.ParallelBulkLoad(elements.begin(), elements.end(), num_threads, 0.7));
+            EXPECT_EQ(LeafSizes(index), serial_sizes);
+
+            for (auto &element: elements) {
+                ASSERT_EQ(index.MaybeGet(element.first), element.second);
+            }
+
+            size_t i = 0;
+            for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+                ASSERT_EQ((*iter).first, elements[i++].first);
+            }
+            EXPECT_EQ(i, elements.size());
+
+            int j = elements.size() - 1;
+            for (auto iter = index.RBegin(); iter != index.REnd(); --iter) {
+                ASSERT_EQ((*iter).first, elements[j--].first);
+            }
+        }
+    }
+
+    TEST(BPlusTreeBulkLoadTest, ParallelLoadRejectsUnsortedKeysAtSliceEdge) {
+        BPlusTree<int, int> index{7, 8};
+
+        // 1024 full leaf nodes, divided into slices of 256 leaf nodes by
+        // four threads. The second slice begins at element 2048.
+        auto elements = SortedElements(8 * 1024);
+        elements[2048].first = elements[2047].first;
+
+        EXPECT_FALSE(index.ParallelBulkLoad(elements.begin(), elements.end(), 4));
+        EXPECT_EQ(index.GetRoot(), nullptr);
+        EXPECT_EQ(index.GetAllocatorStats().bytes_in_use_, 0);
+
+        elements[2048].first = elements[2047].first + 1;
+        EXPECT_TRUE(index.ParallelBulkLoad(elements.begin(), elements.end(), 4));
+        EXPECT_EQ(index.MaybeGet(elements[2048].first), elements[2048].second);
+    }
+}
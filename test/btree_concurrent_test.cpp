@@ -1,12 +1,15 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <numeric>
 #include <thread>
 #include <random>
+#include <atomic>
+#include <limits>
 #include "../src/bplustree.h"
 
 namespace bplustree {
     TEST(BPlusTreeConcurrentTest, ConcurrentInserts) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -40,7 +43,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, ConcurrentDeletes) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -95,7 +98,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, ConcurrentRandomInserts) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -132,7 +135,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, ConcurrentRandomDeletes) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -191,7 +194,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, ConcurrentIterators) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         auto key_count = 1000 * 1000;
         std::vector<int> keys(key_count);
@@ -280,7 +283,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, HighBranchingFactorInserts) {
-        BPlusTree index{63, 64};
+        BPlusTree<int, int> index{63, 64};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -317,7 +320,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeConcurrentTest, HighBranchingFactorDeletes) {
-        BPlusTree index{63, 64};
+        BPlusTree<int, int> index{63, 64};
 
         std::vector<int> keys(1000 * 1000);
         std::iota(keys.begin(), keys.end(), 0);
@@ -377,7 +380,7 @@ namespace bplustree {
 
 
     TEST(BPlusTreeConcurrentTest, MixedWorkload) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         auto insert_workload = [&](std::vector<int> keys) {
             for (auto &key: keys) {
                 index.Insert(std::make_pair(key, key));
@@ -419,4 +422,532 @@ namespace bplustree {
         EXPECT_EQ((*index.Begin()).first, 0);
         EXPECT_EQ((*index.RBegin()).first, 998);
     }
-}
\ No newline at end of file
+    TEST(BPlusTreeConcurrentTest, OptimisticReadsWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Multiples of 3 are never modified, while the writers keep
+        // splitting and merging the nodes around them.
+        auto key_count = 30 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto reader_workload = [&](uint32_t worker_id) {
+            std::mt19937 gen{worker_id};
+            std::uniform_int_distribution<int> distribution{0, key_count / 3 - 1};
+
+            while (!writers_done.load()) {
+                int key = distribution(gen) * 3;
+                EXPECT_EQ(index.MaybeGet(key), key);
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+
+        uint32_t reader_threads = 4;
+        std::vector<std::thread> readers;
+        for (uint32_t worker_id = 0; worker_id < reader_threads; ++worker_id) {
+            readers.push_back(std::thread(reader_workload, worker_id));
+        }
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+
+        int i = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter, i += 3) {
+            EXPECT_EQ((*iter).first, i);
+        }
+        EXPECT_EQ(i, key_count);
+    }
+
+    TEST(BPlusTreeConcurrentTest, ConcurrentInsertBatches) {
+        BPlusTree<int, int> index{3, 4};
+
+        int worker_threads = 8;
+        int batches_per_worker = 20;
+        int batch_size = 500;
+
+        // Every worker inserts sorted batches of keys which interleave with
+        // the batches of the other workers
+        auto index_insert_workload = [&](uint32_t worker_id) {
+            for (int batch = 0; batch < batches_per_worker; ++batch) {
+                int stride = worker_threads * batches_per_worker;
+                int offset = batch * worker_threads + static_cast<int>(worker_id);
+
+                std::vector<std::pair<int, int>> elements;
+                for (int i = 0; i < batch_size; ++i) {
+                    elements.emplace_back(i * stride + offset, i);
+                }
+
+                auto inserted = index.InsertBatch(elements.begin(), elements.end());
+                EXPECT_TRUE(std::all_of(inserted.begin(), inserted.end(), [](bool b) { return b; }));
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int worker_id = 0; worker_id < worker_threads; ++worker_id) {
+            workers.push_back(std::thread(index_insert_workload, worker_id));
+        }
+
+        for (int worker_id = 0; worker_id < worker_threads; ++worker_id) {
+            workers[worker_id].join();
+        }
+
+        int i = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, i++);
+        }
+        EXPECT_EQ(i, worker_threads * batches_per_worker * batch_size);
+    }
+
+    TEST(BPlusTreeConcurrentTest, MultiGetWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Multiples of 3 are never modified, while the writers keep
+        // splitting and merging the nodes around them.
+        auto key_count = 30 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto reader_workload = [&](uint32_t worker_id) {
+            std::mt19937 gen{worker_id};
+            std::uniform_int_distribution<int> distribution{0, key_count / 3 - 1};
+
+            std::vector<int> keys(64);
+            std::vector<std::optional<int>> values(keys.size());
+            while (!writers_done.load()) {
+                for (auto &key: keys) {
+                    key = distribution(gen) * 3;
+                }
+
+                index.MultiGet(keys.data(), keys.size(), values.data());
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    EXPECT_EQ(values[i], keys[i]);
+                }
+
+#ifdef BPLUSTREE_COROUTINES
+                index.InterleavedGet(keys.data(), keys.size(), values.data(), 8);
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    EXPECT_EQ(values[i], keys[i]);
+                }
+#endif
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+
+        uint32_t reader_threads = 4;
+        std::vector<std::thread> readers;
+        for (uint32_t worker_id = 0; worker_id < reader_threads; ++worker_id) {
+            readers.push_back(std::thread(reader_workload, worker_id));
+        }
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+    }
+
+    TEST(BPlusTreeConcurrentTest, ScanWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Multiples of 3 are never modified, and every scan has to visit
+        // all of them, even though the writers keep latching the leaf nodes
+        auto key_count = 30 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto reader_workload = [&]() {
+            while (!writers_done.load()) {
+                int stable_keys = 0;
+                int previous_key = -1;
+                index.Scan(0, key_count, [&](const int &key, const int &value) {
+                    EXPECT_LT(previous_key, key);
+                    EXPECT_EQ(key, value);
+                    previous_key = key;
+                    if (key % 3 == 0) {
+                        EXPECT_EQ(key, stable_keys * 3);
+                        ++stable_keys;
+                    }
+                });
+                EXPECT_EQ(stable_keys, key_count / 3);
+
+                std::vector<int> keys;
+                std::vector<int> values;
+                index.ExportRange(0, key_count, keys, values, 2);
+                EXPECT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+                EXPECT_EQ(keys, values);
+                EXPECT_EQ(std::count_if(keys.begin(), keys.end(), [](int key) { return key % 3 == 0; }),
+                          key_count / 3);
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 2; ++i) {
+            readers.push_back(std::thread(reader_workload));
+        }
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+    }
+
+    TEST(BPlusTreeConcurrentTest, IteratorsWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Multiples of 3 are never modified. An iterator which finds the
+        // sibling leaf node latched by a writer descends again, so every
+        // scan visits all of them instead of stopping early.
+        auto key_count = 30 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto reader_workload = [&](bool forward) {
+            while (!writers_done.load()) {
+                std::vector<int> stable_keys;
+                int previous_key = forward ? -1 : key_count;
+
+                if (forward) {
+                    for (auto it = index.Begin(); it != index.End(); ++it) {
+                        EXPECT_LT(previous_key, (*it).first);
+                        previous_key = (*it).first;
+                        if (previous_key % 3 == 0) { stable_keys.push_back(previous_key); }
+                    }
+                } else {
+                    for (auto it = index.RBegin(); it != index.REnd(); --it) {
+                        EXPECT_GT(previous_key, (*it).first);
+                        previous_key = (*it).first;
+                        if (previous_key % 3 == 0) { stable_keys.push_back(previous_key); }
+                    }
+                }
+
+                EXPECT_EQ(stable_keys.size(), key_count / 3);
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+
+        std::vector<std::thread> readers;
+        readers.push_back(std::thread(reader_workload, true));
+        readers.push_back(std::thread(reader_workload, false));
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+    }
+
+    TEST(BPlusTreeConcurrentTest, DeleteRangeWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Multiples of 3 below `key_count` are never modified. Every range
+        // deleting thread owns a region above `key_count`, and repeatedly
+        // fills a window of it before deleting the window as a range.
+        auto key_count = 30 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto range_workload = [&](int region) {
+            auto region_start = key_count * (region + 1);
+            for (int window = 0; window < 200; ++window) {
+                auto lo = region_start + (window % 20) * 500;
+                auto hi = lo + 999;
+                for (int key = lo; key <= hi; key += 2) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                EXPECT_EQ(index.DeleteRange(lo, hi), 500);
+                EXPECT_EQ(index.MaybeGet(lo), std::nullopt);
+            }
+        };
+
+        auto reader_workload = [&](bool forward) {
+            while (!writers_done.load()) {
+                int stable_keys = 0;
+                int previous_key = forward ? -1 : std::numeric_limits<int>::max();
+
+                if (forward) {
+                    for (auto it = index.Begin(); it != index.End(); ++it) {
+                        EXPECT_LT(previous_key, (*it).first);
+                        previous_key = (*it).first;
+                        if (previous_key < key_count && previous_key % 3 == 0) { ++stable_keys; }
+                    }
+                } else {
+                    for (auto it = index.RBegin(); it != index.REnd(); --it) {
+                        EXPECT_GT(previous_key, (*it).first);
+                        previous_key = (*it).first;
+                        if (previous_key < key_count && previous_key % 3 == 0) { ++stable_keys; }
+                    }
+                }
+                EXPECT_EQ(stable_keys, key_count / 3);
+
+                for (int key = 0; key < key_count; key += 300) {
+                    EXPECT_EQ(index.MaybeGet(key), key);
+                }
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+        writers.push_back(std::thread(range_workload, 0));
+        writers.push_back(std::thread(range_workload, 1));
+
+        std::vector<std::thread> readers;
+        readers.push_back(std::thread(reader_workload, true));
+        readers.push_back(std::thread(reader_workload, false));
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+
+        for (int key = 0; key < key_count; ++key) {
+            EXPECT_EQ(index.MaybeGet(key), key % 3 == 0 ? std::optional<int>{key} : std::nullopt);
+        }
+        EXPECT_EQ(index.DeleteRange(key_count, std::numeric_limits<int>::max()), 0);
+    }
+
+    TEST(BPlusTreeConcurrentTest, OrderStatisticsWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4, Augmentation::OrderStatistics};
+
+        // Multiples of 3 below `key_count` are never modified
+        auto key_count = 6 * 1000;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto range_workload = [&]() {
+            for (int window = 0; window < 40; ++window) {
+                std::vector<std::pair<int, int>> batch;
+                for (int key = key_count; key < key_count + 1000; key += 2) {
+                    batch.emplace_back(key, key);
+                }
+                index.InsertBatch(batch.begin(), batch.end());
+                EXPECT_EQ(index.DeleteRange(key_count, key_count + 999), 500);
+            }
+        };
+
+        auto reader_workload = [&]() {
+            while (!writers_done.load()) {
+                auto count = index.Count(0, key_count);
+                EXPECT_GE(count, static_cast<size_t>(key_count / 3));
+                EXPECT_LE(count, static_cast<size_t>(key_count));
+
+                EXPECT_EQ(index.Select(0)->first, 0);
+                EXPECT_EQ(index.Rank(0), 0);
+
+                // At least as many elements as the keys which never change
+                auto element = index.Select(key_count / 3 - 1);
+                ASSERT_TRUE(element.has_value());
+                EXPECT_LT(element->first, key_count + 1000);
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+        writers.push_back(std::thread(range_workload));
+
+        std::vector<std::thread> readers;
+        readers.push_back(std::thread(reader_workload));
+        readers.push_back(std::thread(reader_workload));
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+
+        EXPECT_EQ(index.Count(0, std::numeric_limits<int>::max()), static_cast<size_t>(key_count / 3));
+        for (int k = 0; k < key_count / 3; k += 97) {
+            EXPECT_EQ(index.Select(k)->first, 3 * k);
+            EXPECT_EQ(index.Rank(3 * k), static_cast<size_t>(k));
+        }
+    }
+
+    TEST(BPlusTreeConcurrentTest, AggregatesWithConcurrentWrites) {
+        BPlusTree<int, int> index{3, 4, Augmentation::Aggregates};
+
+        // Multiples of 3 below `key_count` are never modified, and every
+        // value equals its key
+        auto key_count = 6 * 1000;
+        int64_t stable_sum = 0;
+        for (int key = 0; key < key_count; key += 3) {
+            index.Insert(std::make_pair(key, key));
+            stable_sum += key;
+        }
+
+        std::atomic<bool> writers_done{false};
+
+        auto writer_workload = [&](int offset) {
+            for (int round = 0; round < 2; ++round) {
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Insert(std::make_pair(key, key));
+                }
+                for (int key = offset; key < key_count; key += 3) {
+                    index.Delete(key);
+                }
+            }
+        };
+
+        auto range_workload = [&]() {
+            for (int window = 0; window < 40; ++window) {
+                std::vector<std::pair<int, int>> batch;
+                for (int key = key_count; key < key_count + 1000; key += 2) {
+                    batch.emplace_back(key, key);
+                }
+                index.InsertBatch(batch.begin(), batch.end());
+                EXPECT_EQ(index.DeleteRange(key_count, key_count + 999), 500);
+            }
+        };
+
+        auto reader_workload = [&]() {
+            while (!writers_done.load()) {
+                auto aggregate = index.Aggregate(0, key_count - 1);
+                EXPECT_GE(aggregate.count_, static_cast<uint64_t>(key_count / 3));
+                EXPECT_LE(aggregate.count_, static_cast<uint64_t>(key_count));
+                EXPECT_GE(aggregate.sum_, stable_sum);
+                EXPECT_EQ(aggregate.min_, 0);
+                EXPECT_GE(aggregate.max_, key_count - 3);
+
+                auto window = index.Aggregate(key_count, key_count + 999);
+                EXPECT_TRUE(window.count_ == 0 || window.min_ >= key_count);
+            }
+        };
+
+        std::vector<std::thread> writers;
+        writers.push_back(std::thread(writer_workload, 1));
+        writers.push_back(std::thread(writer_workload, 2));
+        writers.push_back(std::thread(range_workload));
+
+        std::vector<std::thread> readers;
+        readers.push_back(std::thread(reader_workload));
+        readers.push_back(std::thread(reader_workload));
+
+        for (auto &writer: writers) {
+            writer.join();
+        }
+        writers_done.store(true);
+        for (auto &reader: readers) {
+            reader.join();
+        }
+
+        auto aggregate = index.Aggregate(0, std::numeric_limits<int>::max());
+        EXPECT_EQ(aggregate.count_, static_cast<uint64_t>(key_count / 3));
+        EXPECT_EQ(aggregate.sum_, stable_sum);
+        EXPECT_EQ(aggregate.min_, 0);
+        EXPECT_EQ(aggregate.max_, key_count - 3);
+    }
+}
@@ -1,11 +1,93 @@
 #include <gtest/gtest.h>
 #include <numeric>
+#include <optional>
 #include <random>
+#include <set>
+#include <string>
 #include "../src/bplustree.h"
 
 namespace bplustree {
+    /**
+     * Checks that the keys below every child pointer are within the bounds
+     * set by its separator keys, that the leaf nodes other than the root are
+     * not underflowing, and that every inner node has a key. Collects the
+     * leaf nodes from left to right.
+     *
+     * @return height of the subtree
+     */
+    int CheckSubtree(BaseNode *node, std::optional<int> lower, std::optional<int> upper, bool is_root,
+                     std::vector<LeafNode<int, int> *> &leaves) {
+        auto in_bounds = [&](int key) {
+            return (!lower.has_value() || *lower <= key) && (!upper.has_value() || key < *upper);
+        };
+
+        if (node->GetType() == NodeType::LeafType) {
+            auto leaf = static_cast<LeafNode<int, int> *>(node);
+            EXPECT_TRUE(is_root || leaf->GetCurrentSize() >= leaf->GetMinSize());
+            for (auto element = leaf->Begin(); element != leaf->End(); ++element) {
+                EXPECT_TRUE(in_bounds(element->first));
+            }
+            leaves.push_back(leaf);
+            return 1;
+        }
+
+        auto inner = static_cast<InnerNode<int> *>(node);
+        EXPECT_GT(inner->GetCurrentSize(), 0);
+
+        std::optional<int> child_upper = inner->GetCurrentSize() > 0 ? std::optional<int>{inner->Begin()->first} : upper;
+        int height = CheckSubtree(inner->GetLowKeyPair().second, lower, child_upper, false, leaves);
+        for (auto element = inner->Begin(); element != inner->End(); ++element) {
+            EXPECT_TRUE(in_bounds(element->first));
+
+            auto next = std::next(element);
+            child_upper = next != inner->End() ? std::optional<int>{next->first} : upper;
+            auto child_height = CheckSubtree(element->second, element->first, child_upper, false, leaves);
+            EXPECT_EQ(child_height, height);
+        }
+        return height + 1;
+    }
+
+    /**
+     * Checks the structure of the B+Tree, and that it holds exactly the
+     * `expected` keys, with the key as the value.
+     */
+    void ExpectTreeHolds(BPlusTree<int, int> &index, const std::set<int> &expected) {
+        if (expected.empty()) {
+            EXPECT_EQ(index.GetRoot(), nullptr);
+            return;
+        }
+
+        std::vector<LeafNode<int, int> *> leaves;
+        CheckSubtree(index.GetRoot(), std::nullopt, std::nullopt, true, leaves);
+
+        LeafNode<int, int> *previous = nullptr;
+        for (auto leaf: leaves) {
+            EXPECT_EQ(leaf->GetSiblingLeft(), previous);
+            if (previous != nullptr) {
+                EXPECT_EQ(previous->GetSiblingRight(), leaf);
+            }
+            previous = leaf;
+        }
+        EXPECT_EQ(leaves.back()->GetSiblingRight(), nullptr);
+
+        auto key = expected.begin();
+        for (auto iter = index.Begin(); iter != index.End(); ++iter, ++key) {
+            ASSERT_NE(key, expected.end());
+            EXPECT_EQ((*iter).first, *key);
+            EXPECT_EQ((*iter).second, *key);
+        }
+        EXPECT_EQ(key, expected.end());
+
+        auto reverse_key = expected.rbegin();
+        for (auto iter = index.RBegin(); iter != index.REnd(); --iter, ++reverse_key) {
+            ASSERT_NE(reverse_key, expected.rend());
+            EXPECT_EQ((*iter).first, *reverse_key);
+        }
+        EXPECT_EQ(reverse_key, expected.rend());
+    }
+
     TEST(BPlusTreeDeleteTest, DeleteNonExistentKey) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         for (int i = 0; i < 4; ++i) {
             index.Insert(std::make_pair(i, i));
@@ -17,7 +99,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, DeleteEveryKey) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         int count = 128;
 
@@ -38,7 +120,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, DeleteEveryKeyInRandomOrder) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> items(512);
         std::iota(items.begin(), items.end(), 0);
@@ -65,14 +147,14 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, RootUnderflowAllowed) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         index.Insert(std::make_pair(1, 1));
         index.Insert(std::make_pair(2, 2));
 
         ASSERT_EQ(index.GetRoot()->GetType(), NodeType::LeafType);
 
-        auto root = static_cast<LeafNode *>(index.GetRoot());
+        auto root = static_cast<LeafNode<int, int> *>(index.GetRoot());
         ASSERT_EQ(root->GetCurrentSize(), 2);
         ASSERT_EQ(root->GetMinSize(), 2);
 
@@ -84,7 +166,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, WithoutLeafUnderflow) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector keys{1, 2, 3, 4, 5};
         for (auto &x: keys) {
@@ -93,11 +175,11 @@ namespace bplustree {
 
         ASSERT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
 
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
         EXPECT_EQ(root->GetCurrentSize(), 1);
 
-        auto leaf1 = static_cast<LeafNode *>(root->GetLowKeyPair().second);
-        auto leaf2 = static_cast<LeafNode *> (leaf1->GetSiblingRight());
+        auto leaf1 = static_cast<LeafNode<int, int> *>(root->GetLowKeyPair().second);
+        auto leaf2 = static_cast<LeafNode<int, int> *>(leaf1->GetSiblingRight());
 
         EXPECT_EQ(leaf1->GetMinSize(), 2);
         /**
@@ -137,7 +219,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, BorrowOneFromPreviousLeafNode) {
-        auto index = bplustree::BPlusTree(3, 4);
+        auto index = bplustree::BPlusTree<int, int>(3, 4);
 
         index.Insert(std::make_pair(1, 1));
         index.Insert(std::make_pair(3, 3));
@@ -191,18 +273,18 @@ namespace bplustree {
         EXPECT_EQ(index.MaybeGet(8), std::nullopt);
 
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
         EXPECT_EQ(root->GetCurrentSize(), 2);
 
         auto pivot = root->FindPivot(8);
         EXPECT_EQ(pivot->first, 7);
 
         EXPECT_EQ(pivot->second->GetType(), NodeType::LeafType);
-        auto leaf = static_cast<LeafNode *>(pivot->second);
+        auto leaf = static_cast<LeafNode<int, int> *>(pivot->second);
 
         EXPECT_EQ(leaf->GetCurrentSize(), 2);
 
-        auto previous_leaf = static_cast<LeafNode *>(leaf->GetSiblingLeft());
+        auto previous_leaf = static_cast<LeafNode<int, int> *>(leaf->GetSiblingLeft());
         EXPECT_EQ(leaf->GetCurrentSize(), 2);
 
         std::vector keys{1, 2, 3, 4, 5, 6, 7, 9};
@@ -214,7 +296,7 @@ namespace bplustree {
 
     TEST(BPlusTreeDeleteTest, MergeWithPreviousLeafNode) {
 
-        auto index = bplustree::BPlusTree(3, 4);
+        auto index = bplustree::BPlusTree<int, int>(3, 4);
 
         index.Insert(std::make_pair(1, 1));
         index.Insert(std::make_pair(3, 3));
@@ -272,10 +354,10 @@ namespace bplustree {
         EXPECT_EQ(index.MaybeGet(7), std::nullopt);
 
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
         EXPECT_EQ(root->GetCurrentSize(), 1);
 
-        auto leaf2 = static_cast<LeafNode *>(root->FindPivot(9)->second);
+        auto leaf2 = static_cast<LeafNode<int, int> *>(root->FindPivot(9)->second);
         EXPECT_EQ(leaf2->GetSiblingRight(), nullptr);
         EXPECT_EQ(leaf2->GetCurrentSize(), 3);
 
@@ -287,7 +369,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, BorrowOneFromNextLeafNode) {
-        auto index = bplustree::BPlusTree(3, 4);
+        auto index = bplustree::BPlusTree<int, int>(3, 4);
 
         index.Insert(std::make_pair(1, 1));
         index.Insert(std::make_pair(3, 3));
@@ -336,16 +418,16 @@ namespace bplustree {
         EXPECT_EQ(index.MaybeGet(1), std::nullopt);
 
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
         EXPECT_EQ(root->GetCurrentSize(), 1);
 
         auto pivot = root->FindPivot(9);
         EXPECT_EQ(pivot->first, 7);
 
-        auto leaf1 = static_cast<LeafNode *>(root->GetLowKeyPair().second);
+        auto leaf1 = static_cast<LeafNode<int, int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(leaf1->GetCurrentSize(), 2);
 
-        auto leaf2 = static_cast<LeafNode *>(leaf1->GetSiblingRight());
+        auto leaf2 = static_cast<LeafNode<int, int> *>(leaf1->GetSiblingRight());
         EXPECT_EQ(leaf2->GetCurrentSize(), 3);
 
         std::vector keys{3, 5, 7, 9, 11};
@@ -357,7 +439,7 @@ namespace bplustree {
 
     TEST(BPlusTreeDeleteTest, MergeWithNextLeafNode) {
 
-        auto index = bplustree::BPlusTree(3, 4);
+        auto index = bplustree::BPlusTree<int, int>(3, 4);
 
         index.Insert(std::make_pair(1, 1));
         index.Insert(std::make_pair(3, 3));
@@ -406,10 +488,10 @@ namespace bplustree {
         EXPECT_EQ(index.MaybeGet(1), std::nullopt);
 
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
         EXPECT_EQ(root->GetCurrentSize(), 1);
 
-        auto leaf1 = static_cast<LeafNode *>(root->GetLowKeyPair().second);
+        auto leaf1 = static_cast<LeafNode<int, int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(leaf1->GetCurrentSize(), 3);
 
         std::vector keys{3, 5, 7, 9, 11, 13};
@@ -420,7 +502,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, BorrowOneFromNextInnerNode) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector insert_keys{3, 6, 9, 12, 15, 18, 21, 27, 33, 39, 45};
         for (auto &x: insert_keys) {
@@ -463,7 +545,7 @@ namespace bplustree {
 
         // Verify preconditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
 
         EXPECT_EQ(root->GetCurrentSize(), 1);
         EXPECT_EQ(root->GetLowKeyPair().second->GetType(), NodeType::InnerType);
@@ -472,12 +554,12 @@ namespace bplustree {
         auto pivot = root->Begin();
         EXPECT_EQ(pivot->first, 15);
 
-        auto inner = static_cast<InnerNode *>(root->GetLowKeyPair().second);
+        auto inner = static_cast<InnerNode<int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(inner->GetCurrentSize(), 1);
         EXPECT_EQ(inner->Begin()->first, 9);
         EXPECT_EQ(inner->Begin()->second->GetType(), NodeType::LeafType);
 
-        auto next_inner = static_cast<InnerNode *>(pivot->second);
+        auto next_inner = static_cast<InnerNode<int> *>(pivot->second);
         EXPECT_EQ(next_inner->GetCurrentSize(), 2);
         EXPECT_EQ(next_inner->Begin()->first, 21);
         EXPECT_EQ(next_inner->Begin()->second->GetType(), NodeType::LeafType);
@@ -533,7 +615,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, MergeWithNextInnerNode) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector insert_keys{3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42};
         for (auto &x: insert_keys) {
@@ -577,7 +659,7 @@ namespace bplustree {
 
         // Verify preconditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
 
         EXPECT_EQ(root->GetCurrentSize(), 2);
         EXPECT_EQ(root->GetLowKeyPair().second->GetType(), NodeType::InnerType);
@@ -586,12 +668,12 @@ namespace bplustree {
         auto pivot = root->Begin();
         EXPECT_EQ(pivot->first, 15);
 
-        auto inner = static_cast<InnerNode *>(root->GetLowKeyPair().second);
+        auto inner = static_cast<InnerNode<int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(inner->GetCurrentSize(), 1);
         EXPECT_EQ(inner->Begin()->first, 9);
         EXPECT_EQ(inner->Begin()->second->GetType(), NodeType::LeafType);
 
-        auto next_inner = static_cast<InnerNode *>(pivot->second);
+        auto next_inner = static_cast<InnerNode<int> *>(pivot->second);
         EXPECT_EQ(next_inner->GetCurrentSize(), 1);
         EXPECT_EQ(next_inner->Begin()->first, 21);
         EXPECT_EQ(next_inner->Begin()->second->GetType(), NodeType::LeafType);
@@ -644,7 +726,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, BorrowOneFromPreviousInnerNode) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector insert_keys{3, 6, 9, 12, 15, 18, 21, 24, 4, 5, 7, 8, 10};
         for (auto &x: insert_keys) {
@@ -687,7 +769,7 @@ namespace bplustree {
 
         // Verify preconditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
 
         EXPECT_EQ(root->GetCurrentSize(), 1);
         EXPECT_EQ(root->GetLowKeyPair().second->GetType(), NodeType::InnerType);
@@ -696,12 +778,12 @@ namespace bplustree {
         auto pivot = root->Begin();
         EXPECT_EQ(pivot->first, 15);
 
-        auto inner = static_cast<InnerNode *>(pivot->second);
+        auto inner = static_cast<InnerNode<int> *>(pivot->second);
         EXPECT_EQ(inner->GetCurrentSize(), 1);
         EXPECT_EQ(inner->Begin()->first, 21);
         EXPECT_EQ(inner->Begin()->second->GetType(), NodeType::LeafType);
 
-        auto prev_inner = static_cast<InnerNode *>(root->GetLowKeyPair().second);
+        auto prev_inner = static_cast<InnerNode<int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(prev_inner->GetCurrentSize(), 3);
         EXPECT_EQ(prev_inner->Begin()->first, 5);
         EXPECT_EQ(prev_inner->Begin()->second->GetType(), NodeType::LeafType);
@@ -759,7 +841,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, MergeWithPreviousInnerNode) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector insert_keys{3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42};
         for (auto &x: insert_keys) {
@@ -802,7 +884,7 @@ namespace bplustree {
 
         // Verify preconditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
 
         EXPECT_EQ(root->GetCurrentSize(), 2);
         EXPECT_EQ(root->GetLowKeyPair().second->GetType(), NodeType::InnerType);
@@ -811,12 +893,12 @@ namespace bplustree {
         auto pivot = root->Begin();
         EXPECT_EQ(pivot->first, 15);
 
-        auto inner = static_cast<InnerNode *>(pivot->second);
+        auto inner = static_cast<InnerNode<int> *>(pivot->second);
         EXPECT_EQ(inner->GetCurrentSize(), 1);
         EXPECT_EQ(inner->Begin()->first, 21);
         EXPECT_EQ(inner->Begin()->second->GetType(), NodeType::LeafType);
 
-        auto prev_inner = static_cast<InnerNode *>(root->GetLowKeyPair().second);
+        auto prev_inner = static_cast<InnerNode<int> *>(root->GetLowKeyPair().second);
         EXPECT_EQ(prev_inner->GetCurrentSize(), 1);
         EXPECT_EQ(prev_inner->Begin()->first, 9);
         EXPECT_EQ(prev_inner->Begin()->second->GetType(), NodeType::LeafType);
@@ -869,7 +951,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, ReplaceRootNode) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector insert_keys{3, 6, 9, 12};
         for (auto &x: insert_keys) {
@@ -890,7 +972,7 @@ namespace bplustree {
 
         // Preconditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::InnerType);
-        auto root = static_cast<InnerNode *>(index.GetRoot());
+        auto root = static_cast<InnerNode<int> *>(index.GetRoot());
 
         EXPECT_EQ(root->GetCurrentSize(), 1);
         EXPECT_EQ(root->Begin()->first, 9);
@@ -907,7 +989,7 @@ namespace bplustree {
 
         // Post-conditions
         EXPECT_EQ(index.GetRoot()->GetType(), NodeType::LeafType);
-        auto new_root = static_cast<LeafNode *>(index.GetRoot());
+        auto new_root = static_cast<LeafNode<int, int> *>(index.GetRoot());
 
         EXPECT_EQ(new_root->GetCurrentSize(), 3);
         std::vector remaining_keys{3, 6, 12};
@@ -918,7 +1000,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeDeleteTest, DeleteAllKeysThenReinsert) {
-        auto index = bplustree::BPlusTree(3, 3);
+        auto index = bplustree::BPlusTree<int, int>(3, 3);
 
         std::vector<int> keys(100);
         std::iota(keys.begin(), keys.end(), 0);
@@ -953,4 +1035,114 @@ namespace bplustree {
         }
         EXPECT_EQ(j, keys.size());
     }
+
+    TEST(BPlusTreeDeleteRangeTest, MatchesDeletingEachKey) {
+        for (auto [inner_size, leaf_size]: {std::make_pair(3, 4), std::make_pair(3, 3), std::make_pair(5, 8)}) {
+            BPlusTree<int, int> index{inner_size, leaf_size};
+            std::set<int> expected;
+
+            std::vector<int> keys(3000);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::mt19937 gen{42};
+            std::shuffle(keys.begin(), keys.end(), gen);
+            for (auto key: keys) {
+                index.Insert(std::make_pair(key, key));
+                expected.insert(key);
+            }
+
+            // Ranges from a single key to a third of the keys, some of them
+            // starting or ending outside of the keys in the B+Tree
+            for (int i = 0; i < 40; ++i) {
+                int lo = std::uniform_int_distribution<int>{-10, 3000}(gen);
+                int hi = lo + std::uniform_int_distribution<int>{0, i % 4 == 0 ? 1000 : 40}(gen);
+
+                auto first = expected.lower_bound(lo);
+                auto last = expected.upper_bound(hi);
+                auto count = std::distance(first, last);
+                expected.erase(first, last);
+
+                EXPECT_EQ(index.DeleteRange(lo, hi), count);
+                ExpectTreeHolds(index, expected);
+                EXPECT_EQ(index.MaybeGet(lo), std::nullopt);
+                EXPECT_EQ(index.MaybeGet(hi), std::nullopt);
+            }
+
+            // The B+Tree is still balanced for single key inserts and deletes
+            for (auto key: keys) {
+                EXPECT_EQ(index.Insert(std::make_pair(key, key)), expected.insert(key).second);
+            }
+            ExpectTreeHolds(index, expected);
+
+            for (int key = 0; key < 3000; key += 3) {
+                EXPECT_TRUE(index.Delete(key));
+                expected.erase(key);
+            }
+            ExpectTreeHolds(index, expected);
+        }
+    }
+
+    TEST(BPlusTreeDeleteRangeTest, DeleteEveryKeyThenReinsert) {
+        BPlusTree<int, int> index{3, 4};
+        std::set<int> expected;
+
+        for (int key = 0; key < 1000; ++key) {
+            index.Insert(std::make_pair(key, key));
+            expected.insert(key);
+        }
+
+        EXPECT_EQ(index.DeleteRange(-1, 1000), 1000);
+        ExpectTreeHolds(index, {});
+        EXPECT_EQ(index.Begin(), index.End());
+        EXPECT_EQ(index.DeleteRange(0, 1000), 0);
+
+        for (int key = 0; key < 1000; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+        ExpectTreeHolds(index, expected);
+
+        // Everything except the first and last keys
+        EXPECT_EQ(index.DeleteRange(1, 998), 998);
+        ExpectTreeHolds(index, {0, 999});
+    }
+
+    TEST(BPlusTreeDeleteRangeTest, RangeWithoutKeys) {
+        BPlusTree<int, int> index{3, 4};
+        EXPECT_EQ(index.DeleteRange(0, 10), 0);
+
+        std::set<int> expected;
+        for (int key = 0; key < 500; ++key) {
+            index.Insert(std::make_pair(key * 2, key * 2));
+            expected.insert(key * 2);
+        }
+
+        EXPECT_EQ(index.DeleteRange(10, 5), 0);
+        EXPECT_EQ(index.DeleteRange(11, 11), 0);
+        EXPECT_EQ(index.DeleteRange(1000, 2000), 0);
+        EXPECT_EQ(index.DeleteRange(-100, -1), 0);
+        ExpectTreeHolds(index, expected);
+
+        EXPECT_EQ(index.DeleteRange(11, 13), 1);
+        expected.erase(12);
+        ExpectTreeHolds(index, expected);
+    }
+
+    TEST(BPlusTreeDeleteRangeTest, DeleteStringKeys) {
+        BPlusTree<std::string, std::string> index{4, 5};
+
+        for (int i = 0; i < 1000; ++i) {
+            auto key = "key-" + std::to_string(10000 + i);
+            index.Insert(std::make_pair(key, std::string(40, 'v') + key));
+        }
+
+        EXPECT_EQ(index.DeleteRange("key-10100", "key-10899"), 800);
+
+        for (int i = 0; i < 1000; ++i) {
+            auto key = "key-" + std::to_string(10000 + i);
+            if (i >= 100 && i < 900) {
+                EXPECT_EQ(index.MaybeGet(key), std::nullopt);
+            } else {
+                EXPECT_EQ(index.MaybeGet(key), std::string(40, 'v') + key);
+            }
+        }
+    }
 }
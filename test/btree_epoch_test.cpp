@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../src/epoch.h"
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    std::atomic<int> freed_objects{0};
+
+    void CountingDeleter(void *object) {
+        delete static_cast<int *>(object);
+        freed_objects.fetch_add(1);
+    }
+
+    // Enough retired objects to trigger at least one reclamation
+    constexpr int kRetiredObjects = 1000;
+
+    TEST(EpochManagerTest, ReclaimsRetiredObjectsInBatches) {
+        freed_objects.store(0);
+        {
+            EpochManager manager;
+            manager.RegisterThread();
+
+            for (int i = 0; i < kRetiredObjects; ++i) {
+                manager.Retire(new int{i}, CountingDeleter);
+            }
+
+            // Freed without waiting for the manager to be destroyed, but
+            // not one at a time
+            EXPECT_GT(freed_objects.load(), 0);
+            EXPECT_LT(freed_objects.load(), kRetiredObjects);
+        }
+        EXPECT_EQ(freed_objects.load(), kRetiredObjects);
+    }
+
+    TEST(EpochManagerTest, GuardDefersReclamation) {
+        freed_objects.store(0);
+        EpochManager manager;
+
+        std::atomic<bool> reader_entered{false};
+        std::atomic<bool> retired_all{false};
+
+        auto reader = std::thread([&]() {
+            EpochManager::Guard guard{manager};
+            reader_entered.store(true);
+            while (!retired_all.load()) {
+                std::this_thread::yield();
+            }
+        });
+
+        while (!reader_entered.load()) {
+            std::this_thread::yield();
+        }
+
+        for (int i = 0; i < kRetiredObjects; ++i) {
+            manager.Retire(new int{i}, CountingDeleter);
+        }
+        EXPECT_EQ(freed_objects.load(), 0);
+
+        retired_all.store(true);
+        reader.join();
+
+        // The reader has exited, so the next batch frees everything
+        for (int i = 0; i < kRetiredObjects; ++i) {
+            manager.Retire(new int{i}, CountingDeleter);
+        }
+        EXPECT_GE(freed_objects.load(), kRetiredObjects);
+
+        manager.ReclaimAll();
+        EXPECT_EQ(freed_objects.load(), 2 * kRetiredObjects);
+    }
+
+    TEST(EpochManagerTest, UnregisterThreadReclaims) {
+        freed_objects.store(0);
+        EpochManager manager;
+
+        auto worker = std::thread([&]() {
+            manager.RegisterThread();
+            manager.Retire(new int{0}, CountingDeleter);
+            manager.UnregisterThread();
+        });
+        worker.join();
+
+        // There are no readers, so the partial batch is freed when
+        // unregistering
+        EXPECT_EQ(freed_objects.load(), 1);
+    }
+
+    TEST(EpochManagerTest, ThreadExitReleasesRecord) {
+        freed_objects.store(0);
+        EpochManager manager;
+
+        // Threads which exit without unregistering leave their retired
+        // objects behind for the next thread reusing the record
+        for (int i = 0; i < 8; ++i) {
+            auto worker = std::thread([&]() {
+                manager.Retire(new int{0}, CountingDeleter);
+            });
+            worker.join();
+        }
+
+        manager.ReclaimAll();
+        EXPECT_EQ(freed_objects.load(), 8);
+    }
+
+    TEST(EpochManagerTest, MergedNodesAreReclaimed) {
+        BPlusTree<int, int> index{3, 4};
+        index.RegisterThread();
+
+        for (int round = 0; round < 4; ++round) {
+            for (int i = 0; i < 10000; ++i) {
+                index.Insert(std::make_pair(i, i));
+            }
+            for (int i = 0; i < 10000; ++i) {
+                EXPECT_TRUE(index.Delete(i));
+                EXPECT_EQ(index.MaybeGet(i), std::nullopt);
+            }
+        }
+        EXPECT_EQ(index.GetRoot(), nullptr);
+
+        index.UnregisterThread();
+    }
+}
@@ -1,11 +1,13 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <numeric>
 #include "../src/bplustree.h"
 #include <random>
+#include <string>
 
 namespace bplustree {
     TEST(BPlusTreeInsertTest, InsertAndFetchEveryKey) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> items(10000);
         std::iota(items.begin(), items.end(), 0);
@@ -29,7 +31,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeInsertTest, InsertInRandomOrder) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
 
         std::vector<int> items(10000);
         std::iota(items.begin(), items.end(), 0);
@@ -59,12 +61,12 @@ namespace bplustree {
 
 
     TEST(BPlusTreeInsertTest, AnEmptyTree) {
-        BPlusTree index{4, 5};
+        BPlusTree<int, int> index{4, 5};
         EXPECT_EQ(index.GetRoot(), nullptr);
     }
 
     TEST(BPlusTreeInsertTest, FetchFromEmptyTree) {
-        BPlusTree index{4, 5};
+        BPlusTree<int, int> index{4, 5};
         EXPECT_EQ(index.GetRoot(), nullptr);
 
 
@@ -75,4 +77,163 @@ namespace bplustree {
             EXPECT_EQ(index.MaybeGet(key), std::nullopt);
         }
     }
+
+    TEST(BPlusTreeInsertTest, WideKeysAndValues) {
+        BPlusTree<int64_t, uint64_t> index{3, 4};
+
+        // Keys which do not fit in 32 bits
+        std::vector<int64_t> items(10000);
+        std::iota(items.begin(), items.end(), int64_t{1} << 40);
+
+        std::random_device rd;
+        std::mt19937 g(rd());
+
+        std::shuffle(items.begin(), items.end(), g);
+
+        for (auto &i: items) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, static_cast<uint64_t>(i) * 2)));
+        }
+        EXPECT_FALSE(index.Insert(std::make_pair(items[0], uint64_t{0})));
+
+        for (auto &i: items) {
+            EXPECT_EQ(index.MaybeGet(i), static_cast<uint64_t>(i) * 2);
+        }
+
+        int64_t i = int64_t{1} << 40;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, i++);
+        }
+        EXPECT_EQ(i, (int64_t{1} << 40) + static_cast<int64_t>(items.size()));
+    }
+
+    TEST(BPlusTreeInsertTest, CustomComparator) {
+        BPlusTree<uint32_t, uint32_t, std::greater<>> index{3, 4};
+
+        std::vector<uint32_t> items(1000);
+        std::iota(items.begin(), items.end(), 0);
+
+        std::random_device rd;
+        std::mt19937 g(rd());
+
+        std::shuffle(items.begin(), items.end(), g);
+
+        for (auto &i: items) {
+            index.Insert(std::make_pair(i, i));
+            ASSERT_EQ(index.MaybeGet(i), i);
+        }
+
+        // Forward iteration follows the order defined by the comparator
+        uint32_t j = items.size();
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, --j);
+        }
+        EXPECT_EQ(j, 0);
+    }
+
+    TEST(BPlusTreeInsertTest, NonTriviallyCopyableKeys) {
+        BPlusTree<std::string, std::string> index{3, 4};
+
+        std::vector<int> items(1000);
+        std::iota(items.begin(), items.end(), 0);
+
+        std::random_device rd;
+        std::mt19937 g(rd());
+
+        std::shuffle(items.begin(), items.end(), g);
+
+        // Long enough strings to defeat the small string optimization
+        auto make_key = [](int i) { return "key-with-a-long-common-prefix-" + std::to_string(i); };
+
+        for (auto &i: items) {
+            index.Insert(std::make_pair(make_key(i), std::to_string(i)));
+        }
+
+        for (auto &i: items) {
+            ASSERT_EQ(index.MaybeGet(make_key(i)), std::to_string(i));
+        }
+
+        std::shuffle(items.begin(), items.end(), g);
+        for (auto &i: items) {
+            EXPECT_TRUE(index.Delete(make_key(i)));
+            EXPECT_EQ(index.MaybeGet(make_key(i)), std::nullopt);
+        }
+        EXPECT_EQ(index.GetRoot(), nullptr);
+    }
+
+    TEST(BPlusTreeInsertTest, InsertBatchOfSortedKeys) {
+        BPlusTree<int, int> index{3, 4};
+
+        // Micro-batches of sorted keys, which interleave with the keys of
+        // the earlier batches
+        for (int batch = 0; batch < 10; ++batch) {
+            std::vector<std::pair<int, int>> elements;
+            for (int i = batch; i < 10000; i += 10) {
+                elements.emplace_back(i, -i);
+            }
+
+            auto inserted = index.InsertBatch(elements.begin(), elements.end());
+            ASSERT_EQ(inserted.size(), elements.size());
+            EXPECT_TRUE(std::all_of(inserted.begin(), inserted.end(), [](bool b) { return b; }));
+        }
+
+        int i = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, i);
+            EXPECT_EQ((*iter).second, -i);
+            i++;
+        }
+        EXPECT_EQ(i, 10000);
+    }
+
+    TEST(BPlusTreeInsertTest, InsertBatchRejectsDuplicates) {
+        BPlusTree<int, int> index{3, 4};
+        for (int i = 0; i < 100; i += 2) {
+            index.Insert(std::make_pair(i, i));
+        }
+
+        std::vector<std::pair<int, int>> elements{{1,  1},
+                                                  {2,  -2},
+                                                  {3,  3},
+                                                  {3,  -3},
+                                                  {51, 51},
+                                                  {98, -98},
+                                                  {99, 99}};
+        auto inserted = index.InsertBatch(elements.begin(), elements.end());
+
+        EXPECT_EQ(inserted, (std::vector<bool>{true, false, true, false, true, false, true}));
+        EXPECT_EQ(index.MaybeGet(2), 2);
+        EXPECT_EQ(index.MaybeGet(3), 3);
+        EXPECT_EQ(index.MaybeGet(98), 98);
+        EXPECT_EQ(index.MaybeGet(99), 99);
+    }
+
+    TEST(BPlusTreeInsertTest, InsertBatchOfUnsortedKeys) {
+        BPlusTree<std::string, int, std::greater<>> index{3, 4};
+
+        std::vector<int> items(2000);
+        std::iota(items.begin(), items.end(), 0);
+        std::shuffle(items.begin(), items.end(), std::mt19937{7});
+
+        std::vector<std::pair<std::string, int>> elements;
+        for (auto i: items) {
+            elements.emplace_back("key-with-a-long-common-prefix-" + std::to_string(i), i);
+        }
+
+        auto inserted = index.InsertBatch(elements.begin(), elements.end());
+        EXPECT_TRUE(std::all_of(inserted.begin(), inserted.end(), [](bool b) { return b; }));
+
+        for (auto &element: elements) {
+            ASSERT_EQ(index.MaybeGet(element.first), element.second);
+        }
+
+        std::string previous;
+        int count = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter, ++count) {
+            if (count > 0) {
+                EXPECT_GT(previous, (*iter).first);
+            }
+            previous = (*iter).first;
+        }
+        EXPECT_EQ(count, 2000);
+    }
 }
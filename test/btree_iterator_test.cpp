@@ -42,19 +42,24 @@
  *
  */
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
 #include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
 #include "../src/bplustree.h"
 
 namespace bplustree {
 
     TEST(BPlusTreeIteratorTest, EmptyTree) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         EXPECT_EQ(index.Begin(), index.End());
         EXPECT_EQ(index.RBegin(), index.REnd());
     }
 
     TEST(BPlusTreeIteratorTest, RootOnlyTree) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         const int key_count = 3;
 
         for (int i = 0; i < key_count; ++i) {
@@ -87,7 +92,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeIteratorTest, TwoLevelTree) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         const int key_count = 5;
 
         for (int i = 0; i < key_count; ++i) {
@@ -120,7 +125,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeIteratorTest, ThreeLevelTree) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         const int key_count = 10;
 
         for (int i = 0; i < key_count; ++i) {
@@ -153,7 +158,7 @@ namespace bplustree {
     }
 
     TEST(BPlusTreeIteratorTest, ScopedIteratorSameTypeUsage) {
-        BPlusTree index{3, 4};
+        BPlusTree<int, int> index{3, 4};
         const int key_count = 10;
 
         for (int i = 0; i < key_count; ++i) {
@@ -184,4 +189,206 @@ namespace bplustree {
             EXPECT_EQ((*rit2).first, key_count - 1);
         }
     }
+
+    TEST(BPlusTreeIteratorTest, SeekEmptyTree) {
+        BPlusTree<int, int> index{3, 4};
+        EXPECT_EQ(index.LowerBound(1), index.End());
+        EXPECT_EQ(index.UpperBound(1), index.End());
+        EXPECT_EQ(index.Ceiling(1), index.End());
+        EXPECT_EQ(index.Floor(1), index.REnd());
+    }
+
+    TEST(BPlusTreeIteratorTest, SeekThreeLevelTree) {
+        BPlusTree<int, int> index{3, 4};
+        const int key_count = 200;
+
+        // Even keys only, so that every odd key falls in between two keys
+        for (int i = 0; i < key_count; ++i) {
+            index.Insert(std::make_pair(i * 2, i));
+        }
+        const int max_key = (key_count - 1) * 2;
+
+        for (int key = -2; key <= max_key + 2; ++key) {
+            int ceiling = (key <= 0) ? 0 : key + (key % 2);
+            int upper = (key < 0) ? 0 : key + 2 - (key % 2);
+            int floor = key - (key % 2 != 0 ? 1 : 0);
+
+            {
+                auto it = index.LowerBound(key);
+                if (ceiling > max_key) {
+                    EXPECT_EQ(it, index.End());
+                } else {
+                    ASSERT_NE(it, index.End());
+                    EXPECT_EQ((*it).first, ceiling);
+                }
+            }
+
+            {
+                auto it = index.Ceiling(key);
+                if (ceiling > max_key) {
+                    EXPECT_EQ(it, index.End());
+                } else {
+                    ASSERT_NE(it, index.End());
+                    EXPECT_EQ((*it).first, ceiling);
+                }
+            }
+
+            {
+                auto it = index.UpperBound(key);
+                if (upper > max_key) {
+                    EXPECT_EQ(it, index.End());
+                } else {
+                    ASSERT_NE(it, index.End());
+                    EXPECT_EQ((*it).first, upper);
+                }
+            }
+
+            {
+                auto it = index.Floor(key);
+                if (key < 0) {
+                    EXPECT_EQ(it, index.REnd());
+                } else {
+                    ASSERT_NE(it, index.REnd());
+                    EXPECT_EQ((*it).first, std::min(floor, max_key));
+                }
+            }
+        }
+    }
+
+    TEST(BPlusTreeIteratorTest, IterateFromSeekPosition) {
+        BPlusTree<int, int> index{3, 4};
+        for (int i = 0; i < 1000; ++i) {
+            index.Insert(std::make_pair(i, i));
+        }
+
+        {
+            int i = 500;
+            for (auto it = index.LowerBound(500); it != index.End(); ++it) {
+                EXPECT_EQ((*it).first, i++);
+            }
+            EXPECT_EQ(i, 1000);
+        }
+
+        {
+            int i = 500;
+            for (auto it = index.Floor(500); it != index.REnd(); --it) {
+                EXPECT_EQ((*it).first, i--);
+            }
+            EXPECT_EQ(i, -1);
+        }
+    }
+
+    /**
+     * Holds an exclusive latch on a node from another thread, like a writer
+     * would, until the returned thread is joined
+     */
+    std::thread HoldExclusiveLatch(BaseNode *node) {
+        std::atomic<bool> latched{false};
+        std::thread writer([node, &latched] {
+            node->GetNodeExclusiveLatch();
+            latched.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            node->ReleaseNodeExclusiveLatch();
+        });
+        while (!latched.load()) {
+            std::this_thread::yield();
+        }
+        return writer;
+    }
+
+    TEST(BPlusTreeIteratorTest, ReseekWhenSiblingIsLatched) {
+        BPlusTree<int, int> index{3, 4};
+        const int key_count = 100;
+
+        for (int i = 0; i < key_count; ++i) {
+            index.Insert(std::make_pair(i, i));
+        }
+
+        auto node = index.GetRoot();
+        while (node->GetType() == NodeType::InnerType) {
+            node = static_cast<InnerNode<int> *>(node)->GetLowKeyPair().second;
+        }
+        auto first_leaf = static_cast<LeafNode<int, int> *>(node);
+
+        {
+            auto writer = HoldExclusiveLatch(first_leaf->GetSiblingRight());
+
+            int i = 0;
+            auto it = index.Begin();
+            for (; it != index.End(); ++it) {
+                EXPECT_EQ((*it).first, i++);
+            }
+            EXPECT_EQ(i, key_count);
+            EXPECT_EQ(it.GetReseekCount(), 1);
+
+            writer.join();
+        }
+
+        {
+            auto writer = HoldExclusiveLatch(first_leaf);
+
+            int j = key_count - 1;
+            auto rit = index.RBegin();
+            for (; rit != index.REnd(); --rit) {
+                EXPECT_EQ((*rit).first, j--);
+            }
+            EXPECT_EQ(j, -1);
+            EXPECT_EQ(rit.GetReseekCount(), 1);
+
+            writer.join();
+        }
+
+        auto stats = index.GetIteratorStats();
+        EXPECT_EQ(stats.forward_reseeks_, 1);
+        EXPECT_EQ(stats.backward_reseeks_, 1);
+    }
+
+    TEST(BPlusTreeIteratorTest, NextBatch) {
+        BPlusTree<int, int> index{3, 4};
+        const int key_count = 1000;
+
+        for (int i = 0; i < key_count; ++i) {
+            index.Insert(std::make_pair(i, -i));
+        }
+
+        // Batch sizes smaller and larger than a leaf node
+        for (size_t batch_size: {1, 3, 4, 7, 100, 2000}) {
+            std::vector<std::pair<int, int>> batch(batch_size);
+            std::vector<std::pair<int, int>> elements;
+
+            auto it = index.Begin();
+            while (true) {
+                auto copied = it.NextBatch(batch.data(), batch.size());
+                elements.insert(elements.end(), batch.begin(), batch.begin() + copied);
+                if (copied < batch_size) { break; }
+            }
+            EXPECT_EQ(it, index.End());
+
+            ASSERT_EQ(elements.size(), key_count);
+            for (int i = 0; i < key_count; ++i) {
+                EXPECT_EQ(elements[i], std::make_pair(i, -i));
+            }
+        }
+    }
+
+    TEST(BPlusTreeIteratorTest, NextBatchMixedWithIncrement) {
+        BPlusTree<int, int> index{3, 4};
+        for (int i = 0; i < 100; ++i) {
+            index.Insert(std::make_pair(i, i));
+        }
+
+        std::vector<std::pair<int, int>> batch(5);
+        auto it = index.LowerBound(42);
+        EXPECT_EQ(it.NextBatch(batch.data(), batch.size()), 5);
+        EXPECT_EQ(batch.front().first, 42);
+        EXPECT_EQ(batch.back().first, 46);
+
+        ASSERT_NE(it, index.End());
+        EXPECT_EQ((*it).first, 47);
+        ++it;
+        EXPECT_EQ((*it).first, 48);
+
+        auto empty = index.End();
+        EXPECT_EQ(empty.NextBatch(batch.data(), batch.size()), 0);
+    }
 }
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "../src/key_search.h"
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using key_search::SearchKernel;
+
+    template<typename KeyType>
+    class KeySearchTest : public ::testing::Test {};
+
+    using KeyTypes = ::testing::Types<int32_t, uint32_t, int64_t, uint64_t>;
+    TYPED_TEST_SUITE(KeySearchTest, KeyTypes);
+
+    /**
+     * Sorted keys including the smallest and largest values of the key
+     * type, which break a naive signed comparison of unsigned keys.
+     */
+    template<typename KeyType>
+    std::vector<KeyType> SortedKeys(size_t count, std::mt19937_64 &gen) {
+        std::vector<KeyType> keys{std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max()};
+        std::uniform_int_distribution<KeyType> distribution{};
+        while (keys.size() < count) {
+            keys.push_back(distribution(gen));
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+    template<typename KeyType>
+    std::vector<KeyType> SearchKeys(const std::vector<KeyType> &keys, std::mt19937_64 &gen) {
+        std::vector<KeyType> search_keys = keys;
+        std::uniform_int_distribution<KeyType> distribution{};
+        for (int i = 0; i < 100; ++i) {
+            search_keys.push_back(distribution(gen));
+        }
+        search_keys.push_back(std::numeric_limits<KeyType>::min());
+        search_keys.push_back(std::numeric_limits<KeyType>::max());
+        return search_keys;
+    }
+
+    TYPED_TEST(KeySearchTest, KernelsMatchLowerBound) {
+        using KeyType = TypeParam;
+        std::mt19937_64 gen{42};
+
+        for (auto kernel: {SearchKernel::Scalar, SearchKernel::SSE42, SearchKernel::AVX2}) {
+            if (!key_search::IsSupported(kernel)) { continue; }
+
+            for (size_t count: {0, 1, 2, 3, 7, 8, 9, 31, 32, 33, 127, 256}) {
+                auto keys = SortedKeys<KeyType>(std::max<size_t>(count, 2), gen);
+                keys.resize(count);
+
+                for (auto key: SearchKeys(keys, gen)) {
+                    auto expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+                    EXPECT_EQ(key_search::CountLess(kernel, keys.data(), keys.size(), sizeof(KeyType), key), expected);
+                }
+            }
+        }
+    }
+
+    TYPED_TEST(KeySearchTest, StridedKeys) {
+        using KeyType = TypeParam;
+        std::mt19937_64 gen{42};
+
+        for (size_t count: {0, 1, 5, 16, 17, 100, 256}) {
+            auto keys = SortedKeys<KeyType>(std::max<size_t>(count, 2), gen);
+            keys.resize(count);
+
+            std::vector<std::pair<KeyType, void *>> elements;
+            for (auto key: keys) {
+                elements.emplace_back(key, nullptr);
+            }
+            const void *base = elements.empty() ? nullptr : &elements.data()->first;
+
+            for (auto key: SearchKeys(keys, gen)) {
+                auto expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+                EXPECT_EQ(key_search::LowerBound(base, elements.size(), sizeof(elements[0]), key), expected);
+            }
+        }
+    }
+
+    TEST(KeySearchTest, VectorizableKeys) {
+        EXPECT_TRUE((key_search::IsVectorizable<int, std::less<int>>()));
+        EXPECT_TRUE((key_search::IsVectorizable<uint64_t, std::less<>>()));
+        EXPECT_FALSE((key_search::IsVectorizable<int, std::greater<int>>()));
+        EXPECT_FALSE((key_search::IsVectorizable<int16_t, std::less<int16_t>>()));
+        EXPECT_FALSE((key_search::IsVectorizable<double, std::less<double>>()));
+    }
+
+    TEST(KeySearchTest, HighFanoutUnsignedKeys) {
+        BPlusTree<uint32_t, uint32_t> index{127, 128};
+
+        std::vector<uint32_t> keys(100000);
+        std::mt19937 gen{42};
+        for (auto &key: keys) {
+            key = gen();
+        }
+        keys.push_back(0);
+        keys.push_back(std::numeric_limits<uint32_t>::max());
+
+        for (auto key: keys) {
+            index.Insert(std::make_pair(key, key));
+        }
+        for (auto key: keys) {
+            EXPECT_EQ(index.MaybeGet(key), key);
+        }
+
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        size_t i = 0;
+        for (auto iter = index.Begin(); iter != index.End(); ++iter) {
+            EXPECT_EQ((*iter).first, keys[i++]);
+        }
+        EXPECT_EQ(i, keys.size());
+    }
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using Index = BPlusTree<int, int>;
+
+    uint64_t Acquisitions(const LatchCounts &counts) {
+        return counts.shared_acquisitions_ + counts.exclusive_acquisitions_;
+    }
+
+    uint64_t Waits(const LatchCounts &counts) {
+        uint64_t waits = 0;
+        for (auto count: counts.wait_histogram_) { waits += count; }
+        return waits;
+    }
+
+    TEST(BPlusTreeLatchStatsTest, CountsSharedLatchAcquisitions) {
+        SharedLatch latch;
+        latch.LockExclusive();
+        latch.UnlockExclusive();
+        latch.LockShared();
+        EXPECT_TRUE(latch.TryLockShared());
+        latch.UnlockShared();
+        latch.UnlockShared();
+
+        auto counts = latch.GetCounts();
+        EXPECT_EQ(counts.exclusive_acquisitions_, 1u);
+        EXPECT_EQ(counts.shared_acquisitions_, 2u);
+        EXPECT_EQ(counts.contended_acquisitions_, 0u);
+        EXPECT_EQ(Waits(counts), 0u);
+    }
+
+    TEST(BPlusTreeLatchStatsTest, EmptyTree) {
+        Index index{3, 4};
+        auto stats = index.GetLatchStats();
+        EXPECT_TRUE(stats.levels_.empty());
+        EXPECT_EQ(Acquisitions(stats.removed_nodes_), 0u);
+    }
+
+    TEST(BPlusTreeLatchStatsTest, CountsEveryLevelWithoutContention) {
+        Index index{3, 4};
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+
+        auto stats = index.GetLatchStats();
+        ASSERT_GE(stats.levels_.size(), 3u);
+        EXPECT_GT(Acquisitions(stats.root_), 0u);
+        EXPECT_GT(stats.levels_.back().exclusive_acquisitions_, 0u);
+
+        LatchCounts total = stats.root_;
+        for (auto &level: stats.levels_) { total.Add(level); }
+        total.Add(stats.removed_nodes_);
+        EXPECT_EQ(total.contended_acquisitions_, 0u);
+        EXPECT_EQ(Waits(total), 0u);
+    }
+
+    TEST(BPlusTreeLatchStatsTest, KeepsTheCountsOfRemovedNodes) {
+        Index index{3, 4};
+        for (int i = 0; i < 200; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+        for (int i = 0; i < 200; ++i) {
+            EXPECT_TRUE(index.Delete(i));
+        }
+        EXPECT_EQ(index.GetRoot(), nullptr);
+
+        auto stats = index.GetLatchStats();
+        EXPECT_TRUE(stats.levels_.empty());
+        EXPECT_GT(stats.removed_nodes_.exclusive_acquisitions_, 0u);
+    }
+
+    TEST(BPlusTreeLatchStatsTest, AggregatesLatchInnerNodesSharedWithoutChanges) {
+        Index index{3, 4, Augmentation::Aggregates};
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+
+        auto before = index.GetLatchStats();
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_FALSE(index.Insert(std::make_pair(i, i)));
+            EXPECT_FALSE(index.Delete(100 + i));
+        }
+        auto after = index.GetLatchStats();
+
+        // Duplicates and missing keys only latch their leaf node exclusively
+        ASSERT_EQ(before.levels_.size(), after.levels_.size());
+        ASSERT_GE(after.levels_.size(), 3u);
+        EXPECT_EQ(after.root_.exclusive_acquisitions_, before.root_.exclusive_acquisitions_);
+        for (size_t depth = 0; depth + 1 < after.levels_.size(); ++depth) {
+            EXPECT_EQ(after.levels_[depth].exclusive_acquisitions_, before.levels_[depth].exclusive_acquisitions_);
+            EXPECT_GT(after.levels_[depth].shared_acquisitions_, before.levels_[depth].shared_acquisitions_);
+        }
+    }
+
+    TEST(BPlusTreeLatchStatsTest, CountsContendedAcquisitions) {
+        Index index{3, 8};
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+
+        std::thread writer;
+        {
+            // The iterator holds the latch of the only leaf node, so the
+            // writer has to wait for it
+            auto iter = index.Begin();
+            writer = std::thread{[&index] { EXPECT_TRUE(index.Insert(std::make_pair(4, 4))); }};
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        writer.join();
+
+        auto stats = index.GetLatchStats();
+        ASSERT_EQ(stats.levels_.size(), 1u);
+        auto &leaf = stats.levels_[0];
+        EXPECT_GE(leaf.contended_acquisitions_, 1u);
+        EXPECT_EQ(Waits(leaf), leaf.contended_acquisitions_);
+
+        // The writer waited for about 50ms, that is more than 2^24ns
+        uint64_t long_waits = 0;
+        for (int bucket = 24; bucket < LatchCounts::kWaitBuckets; ++bucket) {
+            long_waits += leaf.wait_histogram_[bucket];
+        }
+        EXPECT_GE(long_waits, 1u);
+    }
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    TEST(BPlusTreeMultiGetTest, MatchesMaybeGet) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 10000; key += 2) {
+            index.Insert(std::make_pair(key, -key));
+        }
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> distribution{-10, 10010};
+
+        // Batch sizes which are not a multiple of the group size
+        for (size_t count: {0, 1, 15, 16, 17, 100, 513}) {
+            std::vector<int> keys(count);
+            for (auto &key: keys) {
+                key = distribution(gen);
+            }
+
+            std::vector<std::optional<int>> values(count, 12345);
+            index.MultiGet(keys.data(), keys.size(), values.data());
+
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_EQ(values[i], index.MaybeGet(keys[i])) << "key: " << keys[i];
+            }
+        }
+    }
+
+    TEST(BPlusTreeMultiGetTest, EmptyTree) {
+        BPlusTree<int, int> index{3, 4};
+
+        std::vector<int> keys{1, 2, 3};
+        std::vector<std::optional<int>> values(keys.size(), 0);
+        index.MultiGet(keys.data(), keys.size(), values.data());
+
+        for (auto &value: values) {
+            EXPECT_EQ(value, std::nullopt);
+        }
+    }
+
+    TEST(BPlusTreeMultiGetTest, SingleLeafNode) {
+        BPlusTree<int, int> index{3, 4};
+        index.Insert(std::make_pair(5, 50));
+
+        std::vector<int> keys{5, 6, 4, 5};
+        std::vector<std::optional<int>> values(keys.size());
+        index.MultiGet(keys.data(), keys.size(), values.data());
+
+        EXPECT_EQ(values, (std::vector<std::optional<int>>{50, std::nullopt, std::nullopt, 50}));
+    }
+
+    TEST(BPlusTreeMultiGetTest, NonTriviallyCopyableKeys) {
+        BPlusTree<std::string, std::string> index{3, 4};
+
+        auto make_key = [](int i) { return "key-with-a-long-common-prefix-" + std::to_string(i); };
+        for (int i = 0; i < 1000; i += 2) {
+            index.Insert(std::make_pair(make_key(i), std::to_string(i)));
+        }
+
+        std::vector<std::string> keys;
+        for (int i = 0; i < 1000; ++i) {
+            keys.push_back(make_key(i));
+        }
+
+        std::vector<std::optional<std::string>> values(keys.size());
+        index.MultiGet(keys.data(), keys.size(), values.data());
+
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_EQ(values[i], i % 2 == 0 ? std::optional<std::string>{std::to_string(i)} : std::nullopt);
+        }
+    }
+
+#ifdef BPLUSTREE_COROUTINES
+
+    TEST(BPlusTreeInterleavedGetTest, MatchesMaybeGet) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 10000; key += 2) {
+            index.Insert(std::make_pair(key, -key));
+        }
+
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> distribution{-10, 10010};
+
+        for (size_t group_size: {0, 1, 3, 16, 64}) {
+            for (size_t count: {0, 1, 17, 513}) {
+                std::vector<int> keys(count);
+                for (auto &key: keys) {
+                    key = distribution(gen);
+                }
+
+                std::vector<std::optional<int>> values(count, 12345);
+                index.InterleavedGet(keys.data(), keys.size(), values.data(), group_size);
+
+                for (size_t i = 0; i < count; ++i) {
+                    EXPECT_EQ(values[i], index.MaybeGet(keys[i])) << "key: " << keys[i];
+                }
+            }
+        }
+    }
+
+    TEST(BPlusTreeInterleavedGetTest, EmptyTreeAndSingleLeafNode) {
+        BPlusTree<int, int> index{3, 4};
+
+        std::vector<int> keys{5, 6, 4, 5};
+        std::vector<std::optional<int>> values(keys.size(), 0);
+        index.InterleavedGet(keys.data(), keys.size(), values.data());
+        EXPECT_EQ(values, (std::vector<std::optional<int>>(keys.size(), std::nullopt)));
+
+        index.Insert(std::make_pair(5, 50));
+        index.InterleavedGet(keys.data(), keys.size(), values.data());
+        EXPECT_EQ(values, (std::vector<std::optional<int>>{50, std::nullopt, std::nullopt, 50}));
+    }
+
+    TEST(BPlusTreeInterleavedGetTest, NonTriviallyCopyableKeys) {
+        BPlusTree<std::string, std::string> index{3, 4};
+        for (int i = 0; i < 100; i += 2) {
+            index.Insert(std::make_pair(std::to_string(i), std::to_string(-i)));
+        }
+
+        std::vector<std::string> keys;
+        for (int i = 0; i < 100; ++i) {
+            keys.push_back(std::to_string(i));
+        }
+
+        std::vector<std::optional<std::string>> values(keys.size());
+        index.InterleavedGet(keys.data(), keys.size(), values.data(), 4);
+
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(values[i], i % 2 == 0 ? std::optional<std::string>{std::to_string(-i)} : std::nullopt);
+        }
+    }
+
+#endif /* BPLUSTREE_COROUTINES */
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using StringLeafNode = LeafNode<std::string, std::string>;
+    using StringElasticNode = ElasticNode<std::string, std::pair<std::string, std::string>>;
+
+    StringElasticNode *MakeStringLeaf(int max_size, NodeAllocator *allocator) {
+        return StringElasticNode::Get(NodeType::LeafType, std::make_pair(std::string{}, nullptr), max_size, allocator);
+    }
+
+    std::string Key(int i) { return "key-" + std::to_string(1000 + i) + std::string(32, 'k'); }
+
+    std::string Value(int i) { return "value-" + std::to_string(i) + std::string(32, 'v'); }
+
+    std::vector<std::pair<std::string, std::string>> Elements(StringElasticNode *node) {
+        std::vector<std::pair<std::string, std::string>> elements;
+        for (auto iter = node->Begin(); iter != node->End(); ++iter) {
+            elements.emplace_back(iter->first, iter->second);
+        }
+        return elements;
+    }
+
+    TEST(ElasticNodeTest, KeysAndPayloadsAreSeparateArrays) {
+        HeapNodeAllocator allocator;
+        auto node = ElasticNode<int64_t, std::pair<int64_t, int32_t>>::Get(
+                NodeType::LeafType, std::make_pair(0, nullptr), 13, &allocator);
+
+        for (int i = 0; i < 13; ++i) {
+            node->InsertElementIfPossible(std::make_pair(i, -i), node->End());
+        }
+
+        for (int i = 0; i < 13; ++i) {
+            EXPECT_EQ(&node->Keys()[i], node->Keys() + i);
+            EXPECT_EQ(node->Keys()[i], i);
+            EXPECT_EQ(node->Payloads()[i], -i);
+        }
+        EXPECT_GE(reinterpret_cast<char *>(node->Payloads()), reinterpret_cast<char *>(node->Keys() + 13));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(node->Payloads()) % alignof(int32_t), 0);
+
+        node->FreeElasticNode();
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(ElasticNodeTest, InsertAndDeleteMoveBothArrays) {
+        HeapNodeAllocator allocator;
+        auto node = MakeStringLeaf(8, &allocator);
+        auto leaf = static_cast<StringLeafNode *>(node);
+
+        for (int i: {4, 0, 6, 2, 5, 1, 7, 3}) {
+            EXPECT_TRUE(node->InsertElementIfPossible(std::make_pair(Key(i), Value(i)), leaf->FindLocation(Key(i))));
+        }
+        EXPECT_FALSE(node->InsertElementIfPossible(std::make_pair(Key(8), Value(8)), node->End()));
+
+        auto elements = Elements(node);
+        ASSERT_EQ(elements.size(), 8);
+        for (int i = 0; i < 8; ++i) {
+            EXPECT_EQ(elements[i].first, Key(i));
+            EXPECT_EQ(elements[i].second, Value(i));
+        }
+
+        EXPECT_TRUE(node->DeleteElement(leaf->FindLocation(Key(3))));
+        EXPECT_TRUE(node->PopBegin());
+        EXPECT_TRUE(node->PopEnd());
+
+        std::vector<int> remaining{1, 2, 4, 5, 6};
+        elements = Elements(node);
+        ASSERT_EQ(elements.size(), remaining.size());
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            EXPECT_EQ(elements[i].first, Key(remaining[i]));
+            EXPECT_EQ(elements[i].second, Value(remaining[i]));
+        }
+
+        node->FreeElasticNode();
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(ElasticNodeTest, SplitAndMergeMoveBothArrays) {
+        HeapNodeAllocator allocator;
+        auto node = MakeStringLeaf(7, &allocator);
+
+        for (int i = 0; i < 7; ++i) {
+            node->InsertElementIfPossible(std::make_pair(Key(i), Value(i)), node->End());
+        }
+
+        auto split_node = node->SplitNode();
+        ASSERT_NE(split_node, nullptr);
+        EXPECT_EQ(node->GetCurrentSize(), 4);
+        EXPECT_EQ(split_node->GetCurrentSize(), 3);
+        EXPECT_EQ(split_node->Begin()->first, Key(4));
+        EXPECT_EQ(split_node->Begin()->second, Value(4));
+        EXPECT_EQ(node->RBegin()->first, Key(3));
+        EXPECT_EQ(node->RBegin()->second, Value(3));
+
+        EXPECT_TRUE(node->MergeNode(split_node));
+        EXPECT_EQ(split_node->GetCurrentSize(), 0);
+        split_node->FreeElasticNode();
+
+        auto elements = Elements(node);
+        ASSERT_EQ(elements.size(), 7);
+        for (int i = 0; i < 7; ++i) {
+            EXPECT_EQ(node->At(i).first, Key(i));
+            EXPECT_EQ(node->At(i).second, Value(i));
+        }
+
+        node->FreeElasticNode();
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+
+    TEST(ElasticNodeTest, SummariesMoveWithTheirElements) {
+        using PointerElasticNode = ElasticNode<int64_t, std::pair<int64_t, BaseNode *>>;
+        HeapNodeAllocator allocator;
+        auto node = PointerElasticNode::Get(NodeType::InnerType, std::make_pair(int64_t{0}, nullptr), 7,
+                                            &allocator, sizeof(uint64_t));
+        auto summary = [](PointerElasticNode *n, int child) {
+            return *reinterpret_cast<uint64_t *>(n->Summary(child));
+        };
+        auto set_summary = [](PointerElasticNode *n, int child, uint64_t value) {
+            *reinterpret_cast<uint64_t *>(n->Summary(child)) = value;
+        };
+
+        // Each summary holds the key of its element
+        set_summary(node, 0, 0);
+        for (int64_t key: {10, 30, 50, 70, 60}) {
+            auto location = std::lower_bound(node->Keys(), node->Keys() + node->GetCurrentSize(), key);
+            auto iter = std::next(node->Begin(), location - node->Keys());
+            node->InsertElementIfPossible(std::make_pair(key, nullptr), iter);
+            EXPECT_EQ(summary(node, static_cast<int>(location - node->Keys()) + 1), 0);
+            set_summary(node, static_cast<int>(location - node->Keys()) + 1, key);
+        }
+        node->InsertElementIfPossible(std::make_pair(int64_t{20}, nullptr), std::next(node->Begin()));
+        set_summary(node, 2, 20);
+        node->InsertElementIfPossible(std::make_pair(int64_t{40}, nullptr), std::next(node->Begin(), 3));
+        set_summary(node, 4, 40);
+
+        for (int i = 0; i < 7; ++i) {
+            EXPECT_EQ(summary(node, i + 1), node->At(i).first);
+        }
+
+        auto split_node = node->SplitNode();
+        ASSERT_NE(split_node, nullptr);
+        EXPECT_EQ(split_node->GetSummarySize(), sizeof(uint64_t));
+        for (int i = 0; i < split_node->GetCurrentSize(); ++i) {
+            EXPECT_EQ(summary(split_node, i + 1), split_node->At(i).first);
+        }
+
+        EXPECT_TRUE(node->DeleteElement(std::next(node->Begin())));
+        EXPECT_TRUE(split_node->PopBegin());
+        EXPECT_TRUE(node->MergeNode(split_node));
+        split_node->FreeElasticNode();
+
+        ASSERT_EQ(node->GetCurrentSize(), 5);
+        EXPECT_EQ(summary(node, 0), 0);
+        for (int i = 0; i < 5; ++i) {
+            EXPECT_EQ(summary(node, i + 1), node->At(i).first);
+        }
+
+        EXPECT_EQ(node->DeleteElements(node->Begin(), std::next(node->Begin(), 2)), 2);
+        for (int i = 0; i < 3; ++i) {
+            EXPECT_EQ(summary(node, i + 1), node->At(i).first);
+        }
+
+        node->FreeElasticNode();
+        EXPECT_EQ(allocator.GetStats().bytes_in_use_, 0);
+    }
+}
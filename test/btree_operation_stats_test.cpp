@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using Index = BPlusTree<int, int>;
+
+    uint64_t Height(Index &index) {
+        uint64_t height = 0;
+        for (auto node = index.GetRoot(); node != nullptr; ++height) {
+            if (node->GetType() == NodeType::LeafType) { return height + 1; }
+            node = static_cast<InnerNode<int> *>(node)->GetLowKeyPair().second;
+        }
+        return height;
+    }
+
+    TEST(BPlusTreeOperationStatsTest, EmptyTree) {
+        Index index{3, 4};
+        auto stats = index.GetOperationStats();
+        EXPECT_EQ(stats.optimistic_inserts_, 0u);
+        EXPECT_EQ(stats.pessimistic_inserts_, 0u);
+        EXPECT_EQ(stats.optimistic_deletes_, 0u);
+        EXPECT_EQ(stats.pessimistic_deletes_, 0u);
+    }
+
+    TEST(BPlusTreeOperationStatsTest, CountsInsertPaths) {
+        Index index{3, 4};
+        const int kKeys = 1000;
+        for (int i = 0; i < kKeys; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+        // Duplicates are found in the first descent
+        EXPECT_FALSE(index.Insert(std::make_pair(0, 0)));
+
+        auto stats = index.GetOperationStats();
+        EXPECT_EQ(stats.optimistic_inserts_ + stats.pessimistic_inserts_, kKeys + 1u);
+        EXPECT_GT(stats.optimistic_inserts_, stats.pessimistic_inserts_);
+
+        // Without other threads a full leaf node is still full when the
+        // insert restarts, so every restart splits it
+        EXPECT_EQ(stats.leaf_splits_, stats.pessimistic_inserts_);
+        EXPECT_GT(stats.inner_splits_, 0u);
+        EXPECT_EQ(stats.root_splits_, Height(index) - 1);
+        EXPECT_EQ(stats.optimistic_deletes_ + stats.pessimistic_deletes_, 0u);
+    }
+
+    TEST(BPlusTreeOperationStatsTest, CountsDeletePaths) {
+        Index index{3, 4};
+        const int kKeys = 1000;
+        for (int i = 0; i < kKeys; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+        auto height = Height(index);
+
+        // Deleting from the middle outwards borrows and merges on both sides
+        for (int i = 0; i < kKeys / 2; ++i) {
+            EXPECT_TRUE(index.Delete(kKeys / 2 - i - 1));
+            EXPECT_TRUE(index.Delete(kKeys / 2 + i));
+        }
+        EXPECT_FALSE(index.Delete(0));
+        EXPECT_EQ(index.GetRoot(), nullptr);
+
+        auto stats = index.GetOperationStats();
+        EXPECT_EQ(stats.optimistic_deletes_ + stats.pessimistic_deletes_, kKeys + 1u);
+        EXPECT_GT(stats.pessimistic_deletes_, 0u);
+        EXPECT_GT(stats.leaf_borrows_, 0u);
+        EXPECT_GT(stats.leaf_merges_, 0u);
+        EXPECT_GT(stats.inner_borrows_ + stats.inner_merges_, 0u);
+        // Every level above the last leaf node was removed
+        EXPECT_EQ(stats.root_collapses_, height - 1);
+    }
+
+    TEST(BPlusTreeOperationStatsTest, CountsRootCollapsesOfDeleteRange) {
+        Index index{3, 4};
+        for (int i = 0; i < 500; ++i) {
+            EXPECT_TRUE(index.Insert(std::make_pair(i, i)));
+        }
+        auto height = Height(index);
+
+        index.DeleteRange(10, 499);
+        EXPECT_EQ(index.GetOperationStats().root_collapses_, height - Height(index));
+    }
+
+    TEST(BPlusTreeOperationStatsTest, AddsUpEveryThread) {
+        Index index{3, 4};
+        const int kThreads = 4;
+        const int kKeysPerThread = 2000;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&index, t] {
+                for (int i = 0; i < kKeysPerThread; ++i) {
+                    index.Insert(std::make_pair(i * kThreads + t, i));
+                }
+                for (int i = 0; i < kKeysPerThread; i += 2) {
+                    index.Delete(i * kThreads + t);
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        auto stats = index.GetOperationStats();
+        EXPECT_EQ(stats.optimistic_inserts_ + stats.pessimistic_inserts_,
+                  static_cast<uint64_t>(kThreads * kKeysPerThread));
+        EXPECT_EQ(stats.optimistic_deletes_ + stats.pessimistic_deletes_,
+                  static_cast<uint64_t>(kThreads * kKeysPerThread / 2));
+        EXPECT_GE(stats.pessimistic_inserts_, stats.leaf_splits_);
+        EXPECT_EQ(stats.root_splits_ - stats.root_collapses_, Height(index) - 1);
+    }
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    using Index = BPlusTree<int, int>;
+
+    /**
+     * Checks the count stored for every child pointer against the no. of
+     * elements below it, and returns the no. of elements below `node`
+     */
+    uint64_t CheckSubtreeSizes(BaseNode *node) {
+        if (node->GetType() == NodeType::LeafType) {
+            return static_cast<LeafNode<int, int> *>(node)->GetCurrentSize();
+        }
+
+        auto inner = static_cast<InnerNode<int> *>(node);
+        uint64_t total = 0;
+        for (int child = 0; child <= inner->GetCurrentSize(); ++child) {
+            auto child_node = child == 0 ? inner->GetLowKeyPair().second : inner->At(child - 1).second;
+            auto count = CheckSubtreeSizes(child_node);
+            EXPECT_EQ(reinterpret_cast<std::atomic<uint64_t> *>(inner->Summary(child))->load(), count);
+            total += count;
+        }
+        return total;
+    }
+
+    void ExpectOrderStatistics(Index &index, const std::set<int> &keys, std::mt19937 &rng) {
+        if (index.GetRoot() != nullptr) {
+            EXPECT_EQ(CheckSubtreeSizes(index.GetRoot()), keys.size());
+        }
+
+        std::vector<int> sorted{keys.begin(), keys.end()};
+        for (size_t k = 0; k < sorted.size(); ++k) {
+            auto element = index.Select(k);
+            ASSERT_TRUE(element.has_value());
+            EXPECT_EQ(element->first, sorted[k]);
+        }
+        EXPECT_EQ(index.Select(sorted.size()), std::nullopt);
+
+        std::uniform_int_distribution<int> key_dist{-10, 1010};
+        for (int i = 0; i < 50; ++i) {
+            auto key = key_dist(rng);
+            auto rank = std::lower_bound(sorted.begin(), sorted.end(), key) - sorted.begin();
+            EXPECT_EQ(index.Rank(key), static_cast<size_t>(rank));
+
+            auto lo = key_dist(rng);
+            auto hi = key_dist(rng);
+            auto expected = lo >= hi ? 0 : std::distance(keys.lower_bound(lo), keys.lower_bound(hi));
+            EXPECT_EQ(index.Count(lo, hi), static_cast<size_t>(expected));
+        }
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, MatchesSortedKeysAfterInsertsAndDeletes) {
+        for (auto [inner_size, leaf_size]: std::vector<std::pair<int, int>>{{3, 4}, {3, 3}, {4, 5}, {7, 8}}) {
+            Index index{inner_size, leaf_size, Augmentation::OrderStatistics};
+            std::set<int> keys;
+            std::mt19937 rng{static_cast<uint32_t>(inner_size * 31 + leaf_size)};
+            std::uniform_int_distribution<int> key_dist{0, 999};
+
+            for (int round = 0; round < 6; ++round) {
+                for (int i = 0; i < 400; ++i) {
+                    auto key = key_dist(rng);
+                    EXPECT_EQ(index.Insert(std::make_pair(key, -key)), keys.insert(key).second);
+                }
+                ExpectOrderStatistics(index, keys, rng);
+
+                for (int i = 0; i < 300; ++i) {
+                    auto key = key_dist(rng);
+                    EXPECT_EQ(index.Delete(key), keys.erase(key) == 1);
+                }
+                ExpectOrderStatistics(index, keys, rng);
+            }
+
+            for (auto key: std::vector<int>{keys.begin(), keys.end()}) {
+                EXPECT_TRUE(index.Delete(key));
+            }
+            EXPECT_EQ(index.GetRoot(), nullptr);
+            EXPECT_EQ(index.Count(0, 1000), 0);
+            EXPECT_EQ(index.Select(0), std::nullopt);
+        }
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, MatchesSortedKeysAfterBatchesAndRanges) {
+        Index index{4, 5, Augmentation::OrderStatistics};
+        std::set<int> keys;
+        std::mt19937 rng{7};
+        std::uniform_int_distribution<int> key_dist{0, 999};
+
+        for (int round = 0; round < 8; ++round) {
+            std::vector<std::pair<int, int>> batch;
+            for (int i = 0; i < 200; ++i) {
+                auto key = key_dist(rng);
+                batch.emplace_back(key, key);
+            }
+            std::sort(batch.begin(), batch.begin() + 100);
+
+            auto inserted = index.InsertBatch(batch.begin(), batch.end());
+            for (size_t i = 0; i < batch.size(); ++i) {
+                EXPECT_EQ(inserted[i], keys.insert(batch[i].first).second);
+            }
+            ExpectOrderStatistics(index, keys, rng);
+
+            auto lo = key_dist(rng);
+            auto hi = lo + key_dist(rng) / 8;
+            auto expected = std::distance(keys.lower_bound(lo), keys.upper_bound(hi));
+            EXPECT_EQ(index.DeleteRange(lo, hi), static_cast<size_t>(expected));
+            keys.erase(keys.lower_bound(lo), keys.upper_bound(hi));
+            ExpectOrderStatistics(index, keys, rng);
+        }
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, BulkLoadCountsEveryLevel) {
+        std::vector<std::pair<int, int>> elements;
+        std::set<int> keys;
+        for (int i = 0; i < 1000; ++i) {
+            elements.emplace_back(i, i);
+            keys.insert(i);
+        }
+
+        for (int num_threads: {1, 4}) {
+            Index index{3, 4, Augmentation::OrderStatistics};
+            EXPECT_TRUE(index.ParallelBulkLoad(elements.begin(), elements.end(), num_threads, 0.75));
+
+            std::mt19937 rng{3};
+            ExpectOrderStatistics(index, keys, rng);
+        }
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, WithoutAugmentationVisitsTheElements) {
+        Index index{3, 4};
+        std::set<int> keys;
+        std::mt19937 rng{11};
+        std::uniform_int_distribution<int> key_dist{0, 999};
+
+        for (int i = 0; i < 500; ++i) {
+            auto key = key_dist(rng);
+            index.Insert(std::make_pair(key, key));
+            keys.insert(key);
+        }
+
+        std::vector<int> sorted{keys.begin(), keys.end()};
+        for (size_t k = 0; k < sorted.size(); k += 37) {
+            EXPECT_EQ(index.Select(k)->first, sorted[k]);
+            EXPECT_EQ(index.Rank(sorted[k]), k);
+        }
+        EXPECT_EQ(index.Select(sorted.size()), std::nullopt);
+        EXPECT_EQ(index.Count(100, 200),
+                  static_cast<size_t>(std::distance(keys.lower_bound(100), keys.lower_bound(200))));
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, CountLeavesOutUpperBound) {
+        for (auto augmentation: {Augmentation::None, Augmentation::OrderStatistics}) {
+            Index index{3, 4, augmentation};
+            for (int i = 0; i < 100; ++i) {
+                index.Insert(std::make_pair(i, i));
+            }
+
+            EXPECT_EQ(index.Count(10, 20), 10u);
+            EXPECT_EQ(index.Count(99, 100), 1u);
+            EXPECT_EQ(index.Count(-5, 0), 0u);
+            EXPECT_EQ(index.Count(10, 10), 0u);
+            EXPECT_EQ(index.Count(20, 10), 0u);
+        }
+    }
+
+    TEST(BPlusTreeOrderStatisticsTest, StringKeys) {
+        BPlusTree<std::string, int> index{4, 5, Augmentation::OrderStatistics};
+        for (int i = 999; i >= 0; --i) {
+            EXPECT_TRUE(index.Insert(std::make_pair("key-" + std::to_string(1000 + i), i)));
+        }
+        for (int i = 0; i < 1000; i += 3) {
+            EXPECT_TRUE(index.Delete("key-" + std::to_string(1000 + i)));
+        }
+
+        // Keys 1, 2, 4, 5, 7, ... are left
+        EXPECT_EQ(index.Select(0)->second, 1);
+        EXPECT_EQ(index.Select(3)->second, 5);
+        EXPECT_EQ(index.Rank("key-1500"), 333u);
+        EXPECT_EQ(index.Count("key-1000", "key-2000"), 666u);
+    }
+}
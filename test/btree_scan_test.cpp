@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/bplustree.h"
+
+namespace bplustree {
+    std::vector<std::pair<int, int>> ScanAll(BPlusTree<int, int> &index, int lo, int hi) {
+        std::vector<std::pair<int, int>> elements;
+        index.Scan(lo, hi, [&elements](const int &key, const int &value) {
+            elements.emplace_back(key, value);
+        });
+        return elements;
+    }
+
+    TEST(BPlusTreeScanTest, VisitsKeysInRange) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 5000; key += 2) {
+            index.Insert(std::make_pair(key, -key));
+        }
+
+        // Bounds which are keys in the B+Tree, and bounds which are not
+        for (auto [lo, hi]: std::vector<std::pair<int, int>>{{0, 4998}, {-10, 10000}, {101, 2999},
+                                                              {100, 3000}, {7, 7}, {8, 8}, {4998, 6000}}) {
+            std::vector<std::pair<int, int>> expected;
+            for (int key = std::max(lo, 0); key <= std::min(hi, 4998); ++key) {
+                if (key % 2 == 0) {
+                    expected.emplace_back(key, -key);
+                }
+            }
+
+            EXPECT_EQ(ScanAll(index, lo, hi), expected) << "range: [" << lo << ", " << hi << "]";
+        }
+    }
+
+    TEST(BPlusTreeScanTest, EmptyRangeAndEmptyTree) {
+        BPlusTree<int, int> index{3, 4};
+        EXPECT_TRUE(ScanAll(index, 0, 100).empty());
+
+        for (int key = 0; key < 100; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+        EXPECT_TRUE(ScanAll(index, 50, 40).empty());
+        EXPECT_TRUE(ScanAll(index, 100, 200).empty());
+        EXPECT_TRUE(ScanAll(index, -20, -10).empty());
+    }
+
+    TEST(BPlusTreeScanTest, VisitorStopsScan) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 2000; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::vector<int> keys;
+        auto visited = index.Scan(10, 1999, [&keys](const int &key, const int &) {
+            keys.push_back(key);
+            return key < 1500;
+        });
+
+        EXPECT_EQ(visited, 1491);
+        EXPECT_EQ(keys.front(), 10);
+        EXPECT_EQ(keys.back(), 1500);
+    }
+
+    TEST(BPlusTreeScanTest, VisitorCanModifyTree) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 2000; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        // No latch is held while visiting, so the visitor can write to the
+        // B+Tree, and start a nested scan
+        std::vector<int> keys;
+        index.Scan(0, 1999, [&](const int &key, const int &) {
+            keys.push_back(key);
+            EXPECT_EQ(ScanAll(index, key, key + 1).size(), key == 1999 ? 1 : 2);
+            EXPECT_TRUE(index.Delete(key));
+        });
+
+        ASSERT_EQ(keys.size(), 2000);
+        for (int i = 0; i < 2000; ++i) {
+            EXPECT_EQ(keys[i], i);
+        }
+        EXPECT_EQ(index.Begin(), index.End());
+    }
+
+    TEST(BPlusTreeScanTest, StringKeys) {
+        BPlusTree<std::string, std::string> index{4, 5};
+        for (int i = 0; i < 1000; ++i) {
+            auto key = "key-" + std::to_string(10000 + i);
+            index.Insert(std::make_pair(key, std::string(32, 'v') + key));
+        }
+
+        std::vector<std::string> keys;
+        index.Scan("key-10100", "key-10199~", [&keys](const std::string &key, const std::string &value) {
+            EXPECT_EQ(value, std::string(32, 'v') + key);
+            keys.push_back(key);
+        });
+
+        ASSERT_EQ(keys.size(), 100);
+        EXPECT_EQ(keys.front(), "key-10100");
+        EXPECT_EQ(keys.back(), "key-10199");
+    }
+
+    TEST(BPlusTreeExportTest, MatchesScan) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 20000; key += 2) {
+            index.Insert(std::make_pair(key, -key));
+        }
+
+        for (auto [lo, hi]: std::vector<std::pair<int, int>>{{0, 19998}, {-10, 30000}, {101, 2999},
+                                                              {5000, 5000}, {7, 7}, {19998, 20000}}) {
+            auto expected = ScanAll(index, lo, hi);
+
+            for (int num_threads: {1, 2, 3, 8}) {
+                std::vector<int> keys{-1};
+                std::vector<int> values{1};
+                auto exported = index.ExportRange(lo, hi, keys, values, num_threads);
+
+                ASSERT_EQ(exported, expected.size());
+                ASSERT_EQ(keys.size(), expected.size() + 1);
+                ASSERT_EQ(values.size(), expected.size() + 1);
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    EXPECT_EQ(keys[i + 1], expected[i].first) << "threads: " << num_threads;
+                    EXPECT_EQ(values[i + 1], expected[i].second) << "threads: " << num_threads;
+                }
+            }
+        }
+    }
+
+    TEST(BPlusTreeExportTest, EmptyRangeAndEmptyTree) {
+        BPlusTree<int, int> index{3, 4};
+        std::vector<int> keys;
+        std::vector<int> values;
+
+        EXPECT_EQ(index.ExportRange(0, 100, keys, values, 4), 0);
+
+        for (int key = 0; key < 100; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+        EXPECT_EQ(index.ExportRange(50, 40, keys, values, 4), 0);
+        EXPECT_EQ(index.ExportRange(100, 200, keys, values, 4), 0);
+        EXPECT_TRUE(keys.empty());
+        EXPECT_TRUE(values.empty());
+    }
+
+    TEST(BPlusTreeExportTest, StringKeys) {
+        BPlusTree<std::string, std::string> index{4, 5};
+        for (int i = 0; i < 1000; ++i) {
+            auto key = "key-" + std::to_string(10000 + i);
+            index.Insert(std::make_pair(key, std::string(32, 'v') + key));
+        }
+
+        std::vector<std::string> keys;
+        std::vector<std::string> values;
+        EXPECT_EQ(index.ExportRange("key-10100", "key-10899", keys, values, 4), 800);
+
+        for (int i = 0; i < 800; ++i) {
+            auto key = "key-" + std::to_string(10100 + i);
+            EXPECT_EQ(keys[i], key);
+            EXPECT_EQ(values[i], std::string(32, 'v') + key);
+        }
+    }
+
+    TEST(BPlusTreeParallelScanTest, PartsConcatenateToScan) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 20000; key += 2) {
+            index.Insert(std::make_pair(key, -key));
+        }
+
+        for (auto [lo, hi]: std::vector<std::pair<int, int>>{{0, 19998}, {-10, 30000}, {101, 2999}, {7, 7}}) {
+            auto expected = ScanAll(index, lo, hi);
+
+            for (int num_threads: {1, 2, 3, 8}) {
+                std::vector<std::vector<std::pair<int, int>>> parts(num_threads);
+                auto visited = index.ParallelScan(lo, hi, num_threads, [&parts](size_t part, const int &key,
+                                                                                const int &value) {
+                    parts[part].emplace_back(key, value);
+                });
+
+                std::vector<std::pair<int, int>> elements;
+                for (auto &part: parts) {
+                    elements.insert(elements.end(), part.begin(), part.end());
+                }
+                EXPECT_EQ(visited, expected.size());
+                EXPECT_EQ(elements, expected) << "threads: " << num_threads;
+            }
+        }
+    }
+
+    TEST(BPlusTreeParallelScanTest, UsesSeveralParts) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 20000; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::vector<int64_t> sums(4, 0);
+        index.ParallelScan(0, 19999, 4, [&sums](size_t part, const int &, const int &value) {
+            sums[part] += value;
+        });
+
+        for (auto sum: sums) {
+            EXPECT_GT(sum, 0);
+        }
+        EXPECT_EQ(std::accumulate(sums.begin(), sums.end(), int64_t{0}), int64_t{19999} * 20000 / 2);
+    }
+
+    TEST(BPlusTreeParallelScanTest, VisitorStopsItsPart) {
+        BPlusTree<int, int> index{3, 4};
+        for (int key = 0; key < 20000; ++key) {
+            index.Insert(std::make_pair(key, key));
+        }
+
+        std::vector<int> visited(4, 0);
+        index.ParallelScan(0, 19999, 4, [&visited](size_t part, const int &, const int &) {
+            return ++visited[part] < 10;
+        });
+
+        for (auto count: visited) {
+            EXPECT_EQ(count, 10);
+        }
+    }
+}